@@ -0,0 +1,210 @@
+#include "ascreader.h"
+
+#include <cstring>
+
+namespace {
+
+const std::uint8_t CLASSIC_PAYLOAD{ 8 };
+
+inline bool equals(const char* begin, const char* end, const char* literal)
+{
+    const auto length = std::strlen(literal);
+    return static_cast<std::size_t>(end - begin) == length
+        && std::memcmp(begin, literal, length) == 0;
+}
+
+// Parses a whole token as a number
+inline bool number(
+    const char* begin, const char* end, unsigned base, std::uint64_t& value)
+{
+    return CANdb::scan::number(begin, end, base, value) == end;
+}
+
+// Parses an id token, a trailing 'x' marks extended ids
+bool parseId(const char* begin, const char* end, unsigned base,
+    CANdb::CANframe& frame)
+{
+    frame.extended = end != begin && (end[-1] == 'x' || end[-1] == 'X');
+    std::uint64_t id = 0;
+    if (!number(begin, frame.extended ? end - 1 : end, base, id)
+        || id > 0x1FFFFFFF) {
+        return false;
+    }
+    frame.id = static_cast<std::uint32_t>(id);
+    return true;
+}
+
+bool parseDirection(
+    const char* begin, const char* end, CANdb::CANframe& frame)
+{
+    frame.transmitted = equals(begin, end, "Tx");
+    return frame.transmitted || equals(begin, end, "Rx");
+}
+
+bool parseData(const char*& it, const char* end, unsigned base,
+    std::uint8_t size, CANdb::CANframe& frame)
+{
+    const char* begin;
+    const char* tokenEnd;
+    for (frame.size = 0; frame.size < size; ++frame.size) {
+        std::uint64_t byte = 0;
+        if (!CANdb::scan::token(it, end, begin, tokenEnd)
+            || !number(begin, tokenEnd, base, byte) || byte > 0xFF) {
+            return false;
+        }
+        frame.data[frame.size] = static_cast<std::uint8_t>(byte);
+    }
+    return true;
+}
+
+// <channel> <id> <dir> d <dlc> <data> ... or <channel> <id> <dir> r [dlc]
+bool parseClassic(const char* it, const char* end, unsigned base,
+    CANdb::CANframe& frame)
+{
+    const char* begin;
+    const char* tokenEnd;
+    if (!CANdb::scan::token(it, end, begin, tokenEnd)
+        || !parseId(begin, tokenEnd, base, frame)
+        || !CANdb::scan::token(it, end, begin, tokenEnd)
+        || !parseDirection(begin, tokenEnd, frame)
+        || !CANdb::scan::token(it, end, begin, tokenEnd)) {
+        return false;
+    }
+
+    frame.fd = false;
+    frame.remote = equals(begin, tokenEnd, "r");
+    if (!frame.remote && !equals(begin, tokenEnd, "d")) {
+        return false;
+    }
+
+    std::uint64_t dlc = 0;
+    if (!CANdb::scan::token(it, end, begin, tokenEnd)) {
+        frame.size = 0;
+        return frame.remote;
+    }
+    if (!number(begin, tokenEnd, 16, dlc)) {
+        return false;
+    }
+    const auto size = static_cast<std::uint8_t>(
+        dlc < CLASSIC_PAYLOAD ? dlc : CLASSIC_PAYLOAD);
+    if (frame.remote) {
+        frame.size = size;
+        return true;
+    }
+    return parseData(it, end, base, size, frame);
+}
+
+// <channel> <dir> <id> [name] <brs> <esi> <dlc> <length> <data> ...
+bool parseFd(const char* it, const char* end, unsigned base,
+    CANdb::CANframe& frame)
+{
+    const char* begin;
+    const char* tokenEnd;
+    std::uint64_t channel = 0;
+    if (!CANdb::scan::token(it, end, begin, tokenEnd)
+        || !number(begin, tokenEnd, 10, channel)
+        || !CANdb::scan::token(it, end, begin, tokenEnd)
+        || !parseDirection(begin, tokenEnd, frame)
+        || !CANdb::scan::token(it, end, begin, tokenEnd)
+        || !parseId(begin, tokenEnd, base, frame)
+        || !CANdb::scan::token(it, end, begin, tokenEnd)) {
+        return false;
+    }
+    frame.channel = static_cast<std::uint16_t>(channel);
+
+    // The symbolic name is optional, the BRS flag that follows is 0 or 1
+    if (!equals(begin, tokenEnd, "0") && !equals(begin, tokenEnd, "1")
+        && !CANdb::scan::token(it, end, begin, tokenEnd)) {
+        return false;
+    }
+
+    std::uint64_t length = 0;
+    if (!CANdb::scan::token(it, end, begin, tokenEnd)
+        || !CANdb::scan::token(it, end, begin, tokenEnd)
+        || !CANdb::scan::token(it, end, begin, tokenEnd)
+        || !number(begin, tokenEnd, 10, length)
+        || length > CANdb::CAN_MAX_PAYLOAD) {
+        return false;
+    }
+
+    frame.fd = true;
+    frame.remote = false;
+    return parseData(it, end, base, static_cast<std::uint8_t>(length), frame);
+}
+
+} // namespace
+
+namespace CANdb {
+
+bool parseAscLine(
+    const char* begin, const char* end, bool hex, CANframe& frame)
+{
+    const char* it = begin;
+    const char* tokenBegin;
+    const char* tokenEnd;
+    if (!scan::token(it, end, tokenBegin, tokenEnd)
+        || scan::seconds(tokenBegin, tokenEnd, frame.timestamp) != tokenEnd
+        || !scan::token(it, end, tokenBegin, tokenEnd)) {
+        return false;
+    }
+
+    const unsigned base = hex ? 16 : 10;
+    if (equals(tokenBegin, tokenEnd, "CANFD")) {
+        return parseFd(it, end, base, frame);
+    }
+
+    std::uint64_t channel = 0;
+    if (!number(tokenBegin, tokenEnd, 10, channel)) {
+        return false;
+    }
+    frame.channel = static_cast<std::uint16_t>(channel);
+    return parseClassic(it, end, base, frame);
+}
+
+// base <hex|dec> timestamps <absolute|relative>
+bool parseAscBase(
+    const char* begin, const char* end, bool& hex, bool& relative)
+{
+    const char* it = begin;
+    const char* tokenBegin;
+    const char* tokenEnd;
+    if (!scan::token(it, end, tokenBegin, tokenEnd)
+        || !equals(tokenBegin, tokenEnd, "base")
+        || !scan::token(it, end, tokenBegin, tokenEnd)) {
+        return false;
+    }
+    hex = !equals(tokenBegin, tokenEnd, "dec");
+
+    if (scan::token(it, end, tokenBegin, tokenEnd)
+        && equals(tokenBegin, tokenEnd, "timestamps")
+        && scan::token(it, end, tokenBegin, tokenEnd)) {
+        relative = equals(tokenBegin, tokenEnd, "relative");
+    }
+    return true;
+}
+
+AscReader::AscReader(std::FILE* file, std::size_t bufferSize)
+    : reader(file, bufferSize)
+{
+}
+
+bool AscReader::next(CANframe& frame)
+{
+    const char* begin;
+    const char* end;
+    while (reader.next(begin, end)) {
+        if (parseAscLine(begin, end, hex, frame)) {
+            if (relative) {
+                frame.timestamp += previous;
+                previous = frame.timestamp;
+            }
+            return true;
+        }
+        if (!parseAscBase(begin, end, hex, relative)) {
+            ++skippedCount;
+        }
+    }
+    return false;
+}
+
+} // namespace CANdb
@@ -0,0 +1,56 @@
+#ifndef ASCREADER_H_F9LQ2MZW
+#define ASCREADER_H_F9LQ2MZW
+
+#include "canframe.h"
+#include "linereader.h"
+
+namespace CANdb {
+
+// Parses a CAN or CAN FD frame line of a Vector ASC log:
+//   0.010000 1  123             Rx   d 8 01 02 03 04 05 06 07 08
+//   0.020000 2  18FEF100x       Tx   r
+//   0.030000 CANFD   1 Rx        123  Name  1 0 9 12 01 02 ...
+// Ids and data bytes are hexadecimal unless `hex` is false. The timestamp is
+// taken as written, relative timestamps are resolved by AscReader. Returns
+// false for any other line.
+bool parseAscLine(
+    const char* begin, const char* end, bool hex, CANframe& frame);
+
+// Parses a "base <hex|dec> timestamps <absolute|relative>" header line,
+// returns false for any other line
+bool parseAscBase(
+    const char* begin, const char* end, bool& hex, bool& relative);
+
+// Streams the CAN and CAN FD frames of a Vector ASC log through a fixed size
+// buffer. The "base" header line selects hexadecimal or decimal numbers and
+// absolute or relative timestamps. Frame channels are the ASC channel
+// numbers.
+struct AscReader {
+    // The file stays owned by the caller
+    explicit AscReader(std::FILE* file,
+        std::size_t bufferSize = LineReader::DEFAULT_BUFFER);
+
+    // Reads the next frame, returns false at the end of the file
+    bool next(CANframe& frame);
+
+    bool hexBase() const noexcept { return hex; }
+    bool relativeTimestamps() const noexcept { return relative; }
+
+    std::uint64_t lines() const noexcept { return reader.lines(); }
+    // Header, event and other lines that are not a frame
+    std::uint64_t skipped() const noexcept
+    {
+        return skippedCount + reader.overlong();
+    }
+
+private:
+    LineReader reader;
+    bool hex{ true };
+    bool relative{ false };
+    std::uint64_t previous{ 0 };
+    std::uint64_t skippedCount{ 0 };
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: ASCREADER_H_F9LQ2MZW */
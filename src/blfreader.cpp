@@ -0,0 +1,492 @@
+#include "blfreader.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#ifdef CANDB_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+const std::uint32_t FILE_SIGNATURE{ 0x47474F4C }; // "LOGG"
+const std::uint32_t OBJECT_SIGNATURE{ 0x4A424F4C }; // "LOBJ"
+const std::size_t OBJECT_HEADER_BASE{ 16 };
+const std::size_t CONTAINER_HEADER{ 32 };
+
+const std::uint32_t OBJECT_CAN_MESSAGE{ 1 };
+const std::uint32_t OBJECT_LOG_CONTAINER{ 10 };
+const std::uint32_t OBJECT_CAN_MESSAGE2{ 86 };
+const std::uint32_t OBJECT_CAN_FD_MESSAGE{ 100 };
+const std::uint32_t OBJECT_CAN_FD_MESSAGE_64{ 101 };
+
+const std::uint16_t COMPRESSION_NONE{ 0 };
+const std::uint16_t COMPRESSION_ZLIB{ 2 };
+// Largest expansion of zlib's deflate, bounds the stated uncompressed size
+const std::size_t ZLIB_MAX_RATIO{ 1032 };
+
+// Object header flag selecting 10 us timestamps instead of nanoseconds
+const std::uint32_t TIME_TEN_MICS{ 1 };
+
+const std::uint32_t EXTENDED_ID{ 0x80000000 };
+// CAN_MESSAGE and CAN_FD_MESSAGE flags
+const std::uint8_t MESSAGE_TX{ 0x01 };
+const std::uint8_t MESSAGE_REMOTE{ 0x80 };
+const std::uint8_t FD_MESSAGE_EDL{ 0x01 };
+// CAN_FD_MESSAGE_64 flags
+const std::uint32_t FD_MESSAGE_64_REMOTE{ 0x0010 };
+const std::uint32_t FD_MESSAGE_64_EDL{ 0x1000 };
+
+inline std::uint16_t load16(const std::uint8_t* p)
+{
+    return static_cast<std::uint16_t>(p[0] | p[1] << 8);
+}
+
+inline std::uint32_t load32(const std::uint8_t* p)
+{
+    return static_cast<std::uint32_t>(load16(p))
+        | static_cast<std::uint32_t>(load16(p + 2)) << 16;
+}
+
+inline std::uint64_t load64(const std::uint8_t* p)
+{
+    return static_cast<std::uint64_t>(load32(p))
+        | static_cast<std::uint64_t>(load32(p + 4)) << 32;
+}
+
+struct TopLevelObject {
+    const std::uint8_t* data;
+    std::size_t size;
+    bool container;
+};
+
+// Walks the objects at the top level of the file
+struct Walker {
+    const std::uint8_t* data;
+    std::size_t size;
+    std::size_t offset;
+    std::uint64_t skipped;
+
+    bool next(TopLevelObject& object)
+    {
+        while (offset + OBJECT_HEADER_BASE <= size) {
+            const auto* p = data + offset;
+            if (load32(p) != OBJECT_SIGNATURE) {
+                // Resynchronize on the next object signature
+                ++skipped;
+                ++offset;
+                while (offset + OBJECT_HEADER_BASE <= size
+                    && load32(data + offset) != OBJECT_SIGNATURE) {
+                    ++offset;
+                }
+                continue;
+            }
+
+            const std::size_t objectSize = load32(p + 8);
+            if (objectSize < OBJECT_HEADER_BASE || objectSize > size - offset) {
+                // Truncated file
+                ++skipped;
+                offset = size;
+                return false;
+            }
+
+            // Objects are followed by size % 4 bytes of padding
+            offset = std::min(size, offset + objectSize + objectSize % 4);
+            object.data = p;
+            object.size = objectSize;
+            object.container = load32(p + 12) == OBJECT_LOG_CONTAINER;
+            return true;
+        }
+        return false;
+    }
+};
+
+// Points the segment at the objects of a top level object, inflating
+// compressed containers into the buffer
+bool load(const TopLevelObject& object, std::vector<std::uint8_t>& buffer,
+    CANdb::BlfReader::Segment& segment)
+{
+    segment.container = object.container;
+    if (!object.container) {
+        segment.data = object.data;
+        segment.size = object.size;
+        return true;
+    }
+
+    if (object.size < CONTAINER_HEADER) {
+        return false;
+    }
+    const auto method = load16(object.data + OBJECT_HEADER_BASE);
+    const auto* payload = object.data + CONTAINER_HEADER;
+    const auto payloadSize = object.size - CONTAINER_HEADER;
+    if (method == COMPRESSION_NONE) {
+        segment.data = payload;
+        segment.size = payloadSize;
+        return true;
+    }
+
+#ifdef CANDB_WITH_ZLIB
+    if (method == COMPRESSION_ZLIB) {
+        const auto uncompressed = load32(object.data + OBJECT_HEADER_BASE + 8);
+        if (uncompressed > payloadSize * ZLIB_MAX_RATIO) {
+            return false;
+        }
+        if (buffer.size() < uncompressed) {
+            buffer.resize(uncompressed);
+        }
+        uLongf length = uncompressed;
+        if (uncompress(buffer.data(), &length, payload,
+                static_cast<uLong>(payloadSize))
+            != Z_OK) {
+            return false;
+        }
+        segment.data = buffer.data();
+        segment.size = length;
+        return true;
+    }
+#else
+    (void)buffer;
+    (void)COMPRESSION_ZLIB;
+#endif
+    return false;
+}
+
+// Fills the frame from a CAN message object, returns false for other objects
+bool parseFrame(
+    const std::uint8_t* object, std::size_t size, CANdb::CANframe& frame)
+{
+    const std::size_t headerSize = load16(object + 4);
+    const auto type = load32(object + 12);
+    if (headerSize < 32 || headerSize > size) {
+        return false;
+    }
+
+    const auto flags = load32(object + 16);
+    const auto timestamp = load64(object + 24);
+    frame.timestamp = flags == TIME_TEN_MICS ? timestamp * 10000 : timestamp;
+
+    const auto* body = object + headerSize;
+    const auto bodySize = size - headerSize;
+    std::uint32_t id = 0;
+    const std::uint8_t* data = nullptr;
+
+    switch (type) {
+    case OBJECT_CAN_MESSAGE:
+    case OBJECT_CAN_MESSAGE2: {
+        if (bodySize < 16) {
+            return false;
+        }
+        frame.channel = load16(body);
+        frame.transmitted = (body[2] & MESSAGE_TX) != 0;
+        frame.remote = (body[2] & MESSAGE_REMOTE) != 0;
+        frame.fd = false;
+        frame.size = std::min<std::uint8_t>(body[3], 8);
+        id = load32(body + 4);
+        data = body + 8;
+        break;
+    }
+    case OBJECT_CAN_FD_MESSAGE: {
+        if (bodySize < 84) {
+            return false;
+        }
+        frame.channel = load16(body);
+        frame.transmitted = (body[2] & MESSAGE_TX) != 0;
+        frame.remote = (body[2] & MESSAGE_REMOTE) != 0;
+        frame.fd = (body[13] & FD_MESSAGE_EDL) != 0;
+        frame.size = frame.fd
+            ? std::min<std::uint8_t>(body[14], CANdb::CAN_MAX_PAYLOAD)
+            : std::min<std::uint8_t>(body[3], 8);
+        id = load32(body + 4);
+        data = body + 20;
+        break;
+    }
+    case OBJECT_CAN_FD_MESSAGE_64: {
+        if (bodySize < 40) {
+            return false;
+        }
+        const auto messageFlags = load32(body + 12);
+        frame.channel = body[0];
+        frame.transmitted = body[34] == 1;
+        frame.remote = (messageFlags & FD_MESSAGE_64_REMOTE) != 0;
+        frame.fd = (messageFlags & FD_MESSAGE_64_EDL) != 0;
+        frame.size = std::min<std::uint8_t>(body[2], CANdb::CAN_MAX_PAYLOAD);
+        if (bodySize < 40u + frame.size) {
+            return false;
+        }
+        id = load32(body + 4);
+        data = body + 40;
+        break;
+    }
+    default:
+        return false;
+    }
+
+    frame.extended = (id & EXTENDED_ID) != 0;
+    frame.id = id & 0x1FFFFFFF;
+    std::memcpy(frame.data, data, frame.size);
+    return true;
+}
+
+} // namespace
+
+namespace CANdb {
+
+// Produces the segments of the file in order, inflating containers either on
+// demand or ahead of time on a pool of threads. Every thread owns the buffer
+// of a ring slot while inflating into it, the consumer owns the slot it
+// reads from until the next call.
+struct BlfReader::Source {
+    Source(const std::uint8_t* data, std::size_t size, std::size_t offset,
+        unsigned threads)
+        : walker{ data, size, offset, 0 }
+    {
+        slots.resize(2 * threads);
+        for (unsigned i = 0; i < threads; ++i) {
+            workers.emplace_back(&Source::work, this);
+        }
+    }
+
+    ~Source()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        changed.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    bool next(Segment& segment)
+    {
+        if (workers.empty()) {
+            TopLevelObject object;
+            while (walker.next(object)) {
+                if (load(object, buffer, segment)) {
+                    return true;
+                }
+                ++broken;
+            }
+            return false;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (holding) {
+            slots[consumed++ % slots.size()].ready = false;
+            holding = false;
+            changed.notify_all();
+        }
+
+        for (;;) {
+            auto& slot = slots[consumed % slots.size()];
+            changed.wait(lock, [this, &slot] {
+                return (slot.ready && slot.sequence == consumed)
+                    || (exhausted && assigned == consumed);
+            });
+            if (!slot.ready) {
+                return false;
+            }
+            if (slot.valid) {
+                segment = slot.segment;
+                holding = true;
+                return true;
+            }
+            ++broken;
+            slot.ready = false;
+            ++consumed;
+            changed.notify_all();
+        }
+    }
+
+    std::uint64_t skipped()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return walker.skipped + broken;
+    }
+
+private:
+    struct Slot {
+        std::vector<std::uint8_t> buffer;
+        Segment segment;
+        std::uint64_t sequence;
+        bool ready;
+        bool valid;
+    };
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            changed.wait(lock, [this] {
+                return stop
+                    || (!exhausted && assigned < consumed + slots.size());
+            });
+            if (stop) {
+                return;
+            }
+
+            TopLevelObject object;
+            if (!walker.next(object)) {
+                exhausted = true;
+                changed.notify_all();
+                continue;
+            }
+            const auto sequence = assigned++;
+            auto& slot = slots[sequence % slots.size()];
+
+            lock.unlock();
+            const bool valid = load(object, slot.buffer, slot.segment);
+            lock.lock();
+
+            slot.sequence = sequence;
+            slot.valid = valid;
+            slot.ready = true;
+            changed.notify_all();
+        }
+    }
+
+    Walker walker;
+    std::vector<std::uint8_t> buffer;
+    std::uint64_t broken{ 0 };
+
+    std::vector<Slot> slots;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable changed;
+    // Sequence numbers of the next segment to inflate and to consume
+    std::uint64_t assigned{ 0 };
+    std::uint64_t consumed{ 0 };
+    bool exhausted{ false };
+    bool stop{ false };
+    bool holding{ false };
+};
+
+BlfReader::BlfReader(const std::string& path, unsigned threads)
+    : file(path)
+{
+    if (file.size() < 8 || load32(file.data()) != FILE_SIGNATURE) {
+        throw std::runtime_error(path + " is not a BLF file");
+    }
+    const std::size_t headerSize = load32(file.data() + 4);
+    source.reset(new Source(file.data(), file.size(),
+        std::min(headerSize, file.size()), threads));
+}
+
+BlfReader::~BlfReader() = default;
+
+std::uint64_t BlfReader::skipped() const
+{
+    return skippedCount + source->skipped();
+}
+
+bool BlfReader::next(CANframe& frame)
+{
+    const std::uint8_t* object;
+    std::size_t size;
+    while (nextObject(object, size)) {
+        ++objectCount;
+        if (parseFrame(object, size, frame)) {
+            return true;
+        }
+        ++skippedCount;
+    }
+    return false;
+}
+
+bool BlfReader::nextSegment()
+{
+    if (!source->next(segment)) {
+        segment = Segment{ nullptr, 0, false };
+        position = 0;
+        return false;
+    }
+
+    // Padding of the last object of the previous container
+    position = segment.container ? std::min(pendingPadding, segment.size) : 0;
+    pendingPadding = 0;
+    return true;
+}
+
+bool BlfReader::nextObject(const std::uint8_t*& object, std::size_t& size)
+{
+    for (;;) {
+        if (position >= segment.size) {
+            if (!nextSegment()) {
+                return false;
+            }
+            continue;
+        }
+
+        const auto* p = segment.data + position;
+        const auto remaining = segment.size - position;
+        if (remaining >= OBJECT_HEADER_BASE) {
+            const std::size_t objectSize = load32(p + 8);
+            if (load32(p) != OBJECT_SIGNATURE
+                || objectSize < OBJECT_HEADER_BASE) {
+                // Lost track of the objects, drop the rest of the segment
+                ++skippedCount;
+                position = segment.size;
+                continue;
+            }
+            if (objectSize <= remaining) {
+                const auto end = position + objectSize + objectSize % 4;
+                pendingPadding = end > segment.size ? end - segment.size : 0;
+                position = std::min(end, segment.size);
+                object = p;
+                size = objectSize;
+                return true;
+            }
+        }
+
+        // The object continues in the next container, collect its parts
+        spanning.assign(p, p + remaining);
+        position = segment.size;
+        std::size_t objectSize = OBJECT_HEADER_BASE;
+        for (;;) {
+            if (spanning.size() >= OBJECT_HEADER_BASE) {
+                objectSize = load32(spanning.data() + 8);
+                if (load32(spanning.data()) != OBJECT_SIGNATURE
+                    || objectSize < OBJECT_HEADER_BASE) {
+                    ++skippedCount;
+                    spanning.clear();
+                    break;
+                }
+                if (spanning.size() >= objectSize) {
+                    break;
+                }
+            }
+            if (position >= segment.size
+                && (!nextSegment() || !segment.container)) {
+                // Truncated object at the end of the file
+                ++skippedCount;
+                spanning.clear();
+                if (segment.data == nullptr) {
+                    return false;
+                }
+                break;
+            }
+            const auto take = std::min(
+                objectSize - spanning.size(), segment.size - position);
+            spanning.insert(spanning.end(), segment.data + position,
+                segment.data + position + take);
+            position += take;
+        }
+
+        if (spanning.size() >= OBJECT_HEADER_BASE
+            && spanning.size() == objectSize) {
+            const auto end = position + objectSize % 4;
+            pendingPadding = end > segment.size ? end - segment.size : 0;
+            position = std::min(end, segment.size);
+            object = spanning.data();
+            size = objectSize;
+            return true;
+        }
+    }
+}
+
+} // namespace CANdb
@@ -0,0 +1,65 @@
+#ifndef BLFREADER_H_N7TM4CJE
+#define BLFREADER_H_N7TM4CJE
+
+#include "canframe.h"
+#include "mappedfile.h"
+
+#include <memory>
+#include <vector>
+
+namespace CANdb {
+
+// Streams the CAN and CAN FD frames of a Vector BLF log. The file is memory
+// mapped and frames are parsed in place; only LOG_CONTAINER blocks are
+// inflated, into buffers reused from one container to the next. Frame
+// channels are the BLF channel numbers and timestamps count from the start
+// of the measurement.
+//
+// Compressed containers require zlib (CANDB_WITH_ZLIB) and are skipped
+// otherwise.
+struct BlfReader {
+    // With `threads` > 0 containers are inflated by a thread pool ahead of
+    // next(), otherwise next() inflates them when they are reached. Throws
+    // std::runtime_error if the file can not be mapped or is not a BLF file.
+    explicit BlfReader(const std::string& path, unsigned threads = 0);
+    ~BlfReader();
+
+    BlfReader(const BlfReader&) = delete;
+    BlfReader& operator=(const BlfReader&) = delete;
+
+    // Reads the next frame, returns false at the end of the file
+    bool next(CANframe& frame);
+
+    // Objects read, including those that are not a frame
+    std::uint64_t objects() const noexcept { return objectCount; }
+    // Objects that are not a CAN frame, and broken or truncated data
+    std::uint64_t skipped() const;
+
+    // A block of objects, either a top level object or an inflated container
+    struct Segment {
+        const std::uint8_t* data;
+        std::size_t size;
+        // Objects of a container may continue in the next container
+        bool container;
+    };
+    struct Source;
+
+private:
+    bool nextObject(const std::uint8_t*& object, std::size_t& size);
+    bool nextSegment();
+
+    MappedFile file;
+    std::unique_ptr<Source> source;
+    Segment segment{ nullptr, 0, false };
+    std::size_t position{ 0 };
+    // Padding of an object that continues in the next segment
+    std::size_t pendingPadding{ 0 };
+    // Copy of an object crossing the end of a container
+    std::vector<std::uint8_t> spanning;
+    std::uint64_t objectCount{ 0 };
+    std::uint64_t skippedCount{ 0 };
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: BLFREADER_H_N7TM4CJE */
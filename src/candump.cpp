@@ -0,0 +1,137 @@
+#include "candump.h"
+
+#include <cstring>
+
+namespace {
+
+// Error frames carry this flag in their 29-bit id
+const std::uint32_t CAN_ERROR_FLAG{ 0x20000000 };
+const std::uint8_t CLASSIC_PAYLOAD{ 8 };
+
+} // namespace
+
+namespace CANdb {
+
+bool parseCandumpLine(const char* begin, const char* end, CANframe& frame,
+    const char*& channel, const char*& channelEnd)
+{
+    auto it = scan::skipSpaces(begin, end);
+    if (it == end || *it++ != '(') {
+        return false;
+    }
+    it = scan::seconds(it, end, frame.timestamp);
+    if (it == nullptr || it == end || *it++ != ')') {
+        return false;
+    }
+
+    it = scan::skipSpaces(it, end);
+    channel = it;
+    while (it != end && !scan::isSpace(*it)) {
+        ++it;
+    }
+    channelEnd = it;
+    if (channel == channelEnd) {
+        return false;
+    }
+
+    it = scan::skipSpaces(it, end);
+    const char* idBegin = it;
+    std::uint32_t id = 0;
+    int digit = 0;
+    while (it != end && (digit = scan::hexValue(*it)) >= 0) {
+        id = (id << 4) | static_cast<std::uint32_t>(digit);
+        ++it;
+    }
+    const auto idDigits = it - idBegin;
+    if (idDigits == 0 || idDigits > 8 || it == end || *it++ != '#') {
+        return false;
+    }
+
+    // candump prints 3 digits for standard and 8 digits for extended ids
+    frame.extended = idDigits > 3;
+    if (frame.extended && (id & CAN_ERROR_FLAG) != 0) {
+        return false;
+    }
+    frame.id = id & 0x1FFFFFFF;
+    frame.fd = false;
+    frame.remote = false;
+    frame.size = 0;
+
+    std::uint8_t maxSize = CLASSIC_PAYLOAD;
+    if (it != end && *it == '#') {
+        // The nibble after ## holds the BRS and ESI flags
+        ++it;
+        if (it == end || scan::hexValue(*it) < 0) {
+            return false;
+        }
+        ++it;
+        frame.fd = true;
+        maxSize = CAN_MAX_PAYLOAD;
+    } else if (it != end && (*it == 'R' || *it == 'r')) {
+        ++it;
+        frame.remote = true;
+        if (it != end && (digit = scan::hexValue(*it)) >= 0) {
+            frame.size = static_cast<std::uint8_t>(
+                digit < CLASSIC_PAYLOAD ? digit : CLASSIC_PAYLOAD);
+            ++it;
+        }
+        return scan::skipSpaces(it, end) == end;
+    }
+
+    while (it != end && !scan::isSpace(*it)) {
+        if (*it == '.') {
+            ++it;
+            continue;
+        }
+        const int high = scan::hexValue(*it++);
+        const int low = it != end ? scan::hexValue(*it++) : -1;
+        if (high < 0 || low < 0 || frame.size == maxSize) {
+            return false;
+        }
+        frame.data[frame.size++] = static_cast<std::uint8_t>(high << 4 | low);
+    }
+
+    return scan::skipSpaces(it, end) == end;
+}
+
+CandumpReader::CandumpReader(std::FILE* file, std::size_t bufferSize)
+    : reader(file, bufferSize)
+{
+}
+
+bool CandumpReader::next(CANframe& frame)
+{
+    const char* begin;
+    const char* end;
+    while (reader.next(begin, end)) {
+        if (scan::skipSpaces(begin, end) == end) {
+            continue;
+        }
+
+        const char* channel;
+        const char* channelEnd;
+        if (!parseCandumpLine(begin, end, frame, channel, channelEnd)) {
+            ++skippedCount;
+            continue;
+        }
+        frame.channel = channelIndex(channel, channelEnd);
+        frame.transmitted = false;
+        return true;
+    }
+    return false;
+}
+
+std::uint16_t CandumpReader::channelIndex(const char* begin, const char* end)
+{
+    const auto length = static_cast<std::size_t>(end - begin);
+    for (std::size_t i = 0; i < channelNames.size(); ++i) {
+        if (channelNames[i].size() == length
+            && std::memcmp(channelNames[i].data(), begin, length) == 0) {
+            return static_cast<std::uint16_t>(i);
+        }
+    }
+    channelNames.emplace_back(begin, end);
+    return static_cast<std::uint16_t>(channelNames.size() - 1);
+}
+
+} // namespace CANdb
@@ -0,0 +1,53 @@
+#ifndef CANDUMP_H_J6WS9PLC
+#define CANDUMP_H_J6WS9PLC
+
+#include "canframe.h"
+#include "linereader.h"
+
+#include <string>
+
+namespace CANdb {
+
+// Parses one line of a `candump -l` log, without the line break:
+//   (1436509053.249713) can0 123#DEADBEEF
+//   (1436509053.249713) can0 12345678##1DEADBEEF
+//   (1436509053.249713) can0 123#R
+// Returns false for malformed lines and error frames. The channel name is
+// returned as [channel, channelEnd) pointing into the line.
+bool parseCandumpLine(const char* begin, const char* end, CANframe& frame,
+    const char*& channel, const char*& channelEnd);
+
+// Streams the frames of a candump log through a fixed size buffer. Lines are
+// parsed in place, memory use does not depend on the size of the log.
+struct CandumpReader {
+    // The file stays owned by the caller
+    explicit CandumpReader(std::FILE* file,
+        std::size_t bufferSize = LineReader::DEFAULT_BUFFER);
+
+    // Reads the next frame, returns false at the end of the file
+    bool next(CANframe& frame);
+
+    // Names of the channels seen so far, indexed by CANframe::channel
+    const std::vector<std::string>& channels() const noexcept
+    {
+        return channelNames;
+    }
+
+    std::uint64_t lines() const noexcept { return reader.lines(); }
+    // Malformed lines, error frames and lines longer than the buffer
+    std::uint64_t skipped() const noexcept
+    {
+        return skippedCount + reader.overlong();
+    }
+
+private:
+    std::uint16_t channelIndex(const char* begin, const char* end);
+
+    LineReader reader;
+    std::vector<std::string> channelNames;
+    std::uint64_t skippedCount{ 0 };
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: CANDUMP_H_J6WS9PLC */
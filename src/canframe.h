@@ -0,0 +1,37 @@
+#ifndef CANFRAME_H_T5BN2WQE
+#define CANFRAME_H_T5BN2WQE
+
+#include <cstdint>
+
+namespace CANdb {
+
+// DBC files mark extended ids with the most significant bit
+const std::uint32_t CAN_EXTENDED_ID_FLAG{ 0x80000000 };
+const std::uint8_t CAN_MAX_PAYLOAD{ 64 };
+
+// Frame read from a log or a live bus
+struct CANframe {
+    // Nanoseconds, since the epoch or the start of the log depending on the
+    // source
+    std::uint64_t timestamp;
+    std::uint32_t id;
+    // Channel index or number, depending on the source
+    std::uint16_t channel;
+    std::uint8_t size;
+    bool extended;
+    bool fd;
+    bool remote;
+    // Sent by the logging node, received otherwise
+    bool transmitted;
+    std::uint8_t data[CAN_MAX_PAYLOAD];
+
+    // Id as used for the messages of a DBC file
+    std::uint32_t dbcId() const noexcept
+    {
+        return extended ? id | CAN_EXTENDED_ID_FLAG : id;
+    }
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: CANFRAME_H_T5BN2WQE */
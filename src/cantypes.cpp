@@ -0,0 +1,73 @@
+#include "cantypes.hpp"
+
+#include <mutex>
+#include <set>
+
+namespace {
+
+// Values are never removed, so pointers to them stay valid
+std::mutex poolMutex;
+
+template <typename T> std::set<T>& pool()
+{
+    static std::set<T> values;
+    return values;
+}
+
+} // namespace
+
+template <typename T> const T* CANinterned<T>::intern(const T& value)
+{
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return &*pool<T>().insert(value).first;
+}
+
+template <typename T> const T& CANinterned<T>::none() noexcept
+{
+    static const T empty;
+    return empty;
+}
+
+template struct CANinterned<std::string>;
+template struct CANinterned<std::vector<std::string>>;
+
+void CANsignal::setStartValue(const boost::optional<boost::any>& value)
+{
+    if (!value) {
+        present &= ~(START_VALUE | START_TEXT);
+        startValueNumber = 0;
+        return;
+    }
+    const auto& any = *value;
+    if (const auto* number = boost::any_cast<std::double_t>(&any)) {
+        setStartValue(*number);
+    } else if (const auto* number = boost::any_cast<float>(&any)) {
+        setStartValue(static_cast<std::double_t>(*number));
+    } else if (const auto* number = boost::any_cast<std::int64_t>(&any)) {
+        setStartValue(static_cast<std::double_t>(*number));
+    } else if (const auto* number = boost::any_cast<std::uint64_t>(&any)) {
+        setStartValue(static_cast<std::double_t>(*number));
+    } else if (const auto* number = boost::any_cast<int>(&any)) {
+        setStartValue(static_cast<std::double_t>(*number));
+    } else if (const auto* number = boost::any_cast<unsigned>(&any)) {
+        setStartValue(static_cast<std::double_t>(*number));
+    } else if (const auto* text = boost::any_cast<std::string>(&any)) {
+        setStartValue(*text);
+    }
+}
+
+CANsignalExtras& CANsignal::edit()
+{
+    if (!extras) {
+        extras = std::make_shared<CANsignalExtras>();
+    } else if (extras.use_count() > 1) {
+        extras = std::make_shared<CANsignalExtras>(*extras);
+    }
+    return *extras;
+}
+
+const CANsignalExtras& CANsignal::noExtras()
+{
+    static const CANsignalExtras none;
+    return none;
+}
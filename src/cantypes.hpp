@@ -3,41 +3,151 @@
 
 #include <cstdint>
 #include <map>
+#include <memory>
+#include <ostream>
 #include <string>
 #include <vector>
 #include <cmath>
 #include <boost/optional.hpp>
 #include <boost/any.hpp>
 
-enum class CANsignalType { Unknown = -1, SignedUnsignedInt = 0, Float = 1,
-    Double = 2, Count };
-enum class CANsignalMuxType { NotMuxed = 0, Muxer, Muxed };
-enum class CANsignalEndianness { BigEndianMotorola = 0, LittleEndianIntel = 1 };
+enum class CANsignalType : std::int8_t { Unknown = -1, SignedUnsignedInt = 0,
+    Float = 1, Double = 2, Count };
+enum class CANsignalMuxType : std::uint8_t { NotMuxed = 0, Muxer, Muxed,
+    MuxedMuxer };
+enum class CANsignalEndianness : std::uint8_t { BigEndianMotorola = 0,
+    LittleEndianIntel = 1 };
+
+// Range of multiplexor values for which a signal is present (SG_MUL_VAL_)
+struct CANmuxRange {
+    std::uint32_t from;
+    std::uint32_t to;
+
+    bool operator==(const CANmuxRange& rhs) const
+    {
+        return from == rhs.from && to == rhs.to;
+    }
+};
+
+// Extended multiplexing: the switch a signal depends on and the switch values
+// that enable it
+struct CANmuxDependency {
+    std::string muxSwitch;
+    std::vector<CANmuxRange> ranges;
+
+    bool operator==(const CANmuxDependency& rhs) const
+    {
+        return muxSwitch == rhs.muxSwitch && ranges == rhs.ranges;
+    }
+};
+
+// Description of a single raw value (VAL_ / VAL_TABLE_ entry)
+struct CANvalueDescription {
+    std::int64_t value;
+    std::string label;
+
+    bool operator==(const CANvalueDescription& rhs) const
+    {
+        return value == rhs.value && label == rhs.label;
+    }
+};
+
+// Value descriptions sorted by value
+using CANvalueDescriptions_t = std::vector<CANvalueDescription>;
+
+// Interned value: a pointer into a process wide pool of values that is never
+// emptied, for the few distinct units and receiver lists repeated by many
+// signals. Copies and comparisons are pointer operations. The pools exist for
+// std::string and std::vector<std::string>.
+template <typename T> struct CANinterned {
+    CANinterned() = default;
+    CANinterned(const T& value)
+        : interned(value.empty() ? nullptr : intern(value))
+    {
+    }
+
+    const T& get() const noexcept
+    {
+        return interned != nullptr ? *interned : none();
+    }
+    operator const T&() const noexcept { return get(); }
+
+    bool operator==(const CANinterned& rhs) const noexcept
+    {
+        return interned == rhs.interned;
+    }
+    bool operator!=(const CANinterned& rhs) const noexcept
+    {
+        return interned != rhs.interned;
+    }
+
+private:
+    static const T* intern(const T& value);
+    static const T& none() noexcept;
+
+    const T* interned{ nullptr };
+};
+
+using CANstring = CANinterned<std::string>;
+using CANstrings = CANinterned<std::vector<std::string>>;
+
+inline bool operator==(const CANstring& lhs, const std::string& rhs)
+{
+    return lhs.get() == rhs;
+}
+inline bool operator==(const CANstring& lhs, const char* rhs)
+{
+    return lhs.get() == rhs;
+}
+inline bool operator==(
+    const CANstrings& lhs, const std::vector<std::string>& rhs)
+{
+    return lhs.get() == rhs;
+}
+inline std::ostream& operator<<(std::ostream& stream, const CANstring& text)
+{
+    return stream << text.get();
+}
+
+// Metadata that few signals have, allocated on demand and shared between
+// copies of a signal
+struct CANsignalExtras {
+    std::string comment;
+    std::string startText;
+    CANvalueDescriptions_t valueDescription;
+    CANmuxDependency muxDependency;
+};
 
 struct CANsignal {
+    // Optional fields, see has()
+    enum Field : std::uint8_t {
+        MUX_NDX = 1,
+        START_VALUE = 2,
+        // The start value is a string
+        START_TEXT = 4,
+        COMMENT = 8,
+        VALUE_TYPE = 16,
+        VALUE_DESCRIPTION = 32,
+        MUX_DEPENDENCY = 64,
+    };
+
     std::string signal_name;
-    std::uint8_t startBit;
-    std::uint8_t signalSize;
+    // 16-bit to address every bit of a 64 byte CAN FD payload
+    std::uint16_t startBit;
+    std::uint16_t signalSize;
     CANsignalEndianness endianness;
     bool valueSigned;
+    CANsignalMuxType muxType{ CANsignalMuxType::NotMuxed };
     std::double_t factor;
     std::double_t offset;
     std::double_t min;
     std::double_t max;
-    std::string unit;
-    std::vector<std::string> receivers;
-    CANsignalMuxType muxType{ CANsignalMuxType::NotMuxed };
-    // 16-bit for better debug printing via boost::optional
-    boost::optional<std::uint16_t> muxNdx{ boost::none };
-    boost::optional<boost::any> startValue { boost::none };
-    boost::optional<std::string> comment{ boost::none };
-    // 16-bit for better debug printing via boost::optional
-    boost::optional<CANsignalType> valueType{ boost::none };
-    boost::optional<std::string> valueDescription{ boost::none };
+    CANstring unit;
+    CANstrings receivers;
 
     // Constructor required for C++11 to be able to use an initializer list
-    CANsignal(std::string _signal_name, std::uint8_t _startBit,
-        std::uint8_t _signalSize, CANsignalEndianness _endianness,
+    CANsignal(std::string _signal_name, std::uint16_t _startBit,
+        std::uint16_t _signalSize, CANsignalEndianness _endianness,
         bool _valueSigned, std::double_t _factor, std::double_t _offset,
         std::double_t _min, std::double_t _max, std::string _unit,
         std::vector<std::string> _receivers,
@@ -46,33 +156,187 @@ struct CANsignal {
         boost::optional<boost::any> _startValue = boost::none,
         boost::optional<std::string> _comment = boost::none,
         boost::optional<CANsignalType> _valueType = boost::none,
-        boost::optional<std::string> _valueDescription = boost::none)
+        boost::optional<CANvalueDescriptions_t> _valueDescription
+            = boost::none,
+        boost::optional<CANmuxDependency> _muxDependency = boost::none)
         : signal_name(_signal_name)
         , startBit(_startBit)
         , signalSize(_signalSize)
         , endianness(_endianness)
         , valueSigned(_valueSigned)
+        , muxType(_muxType)
         , factor(_factor)
         , offset(_offset)
         , min(_min)
         , max(_max)
         , unit(_unit)
         , receivers(_receivers)
-        , muxType(_muxType)
-        , muxNdx(_muxNdx)
-        , startValue(_startValue)
-        , comment(_comment)
-        , valueType(_valueType)
-        , valueDescription(_valueDescription)
     {
+        if (_muxNdx) {
+            setMuxNdx(*_muxNdx);
+        }
+        setStartValue(_startValue);
+        if (_comment) {
+            setComment(*_comment);
+        }
+        if (_valueType) {
+            setValueType(*_valueType);
+        }
+        if (_valueDescription) {
+            setValueDescription(*_valueDescription);
+        }
+        if (_muxDependency) {
+            setMuxDependency(*_muxDependency);
+        }
     }
 
     bool operator==(const CANsignal& rhs) const
     {
         return signal_name == rhs.signal_name;
     }
+
+    bool has(Field field) const noexcept { return (present & field) != 0; }
+
+    // Multiplexor value of a multiplexed signal, 0 if it has none
+    std::uint16_t muxIndex() const noexcept { return muxNdxValue; }
+    // GenSigStartValue, 0 if it is missing or a string
+    std::double_t startNumber() const noexcept { return startValueNumber; }
+    // GenSigStartValue, empty if it is missing or a number
+    const std::string& startText() const { return extra().startText; }
+    const std::string& commentText() const { return extra().comment; }
+    // SIG_VALTYPE_, integer signals have none
+    CANsignalType type() const noexcept
+    {
+        return has(VALUE_TYPE) ? valueTypeValue
+                               : CANsignalType::SignedUnsignedInt;
+    }
+    // Empty without VAL_ descriptions
+    const CANvalueDescriptions_t& valueDescriptions() const
+    {
+        return extra().valueDescription;
+    }
+    // Extended multiplexing switch and values (SG_MUL_VAL_), nullptr if the
+    // signal has none
+    const CANmuxDependency* dependency() const
+    {
+        return has(MUX_DEPENDENCY) ? &extras->muxDependency : nullptr;
+    }
+
+    void setMuxNdx(std::uint16_t value) noexcept
+    {
+        muxNdxValue = value;
+        present |= MUX_NDX;
+    }
+    void setStartValue(std::double_t value)
+    {
+        startValueNumber = value;
+        present = (present | START_VALUE) & ~START_TEXT;
+        if (extras && !extras->startText.empty()) {
+            edit().startText.clear();
+        }
+    }
+    void setStartValue(const std::string& value)
+    {
+        startValueNumber = 0;
+        edit().startText = value;
+        present |= START_VALUE | START_TEXT;
+    }
+    void setComment(const std::string& value)
+    {
+        edit().comment = value;
+        present |= COMMENT;
+    }
+    void setValueType(CANsignalType value) noexcept
+    {
+        valueTypeValue = value;
+        present |= VALUE_TYPE;
+    }
+    void setValueDescription(CANvalueDescriptions_t value)
+    {
+        edit().valueDescription = std::move(value);
+        present |= VALUE_DESCRIPTION;
+    }
+    void setMuxDependency(CANmuxDependency value)
+    {
+        edit().muxDependency = std::move(value);
+        present |= MUX_DEPENDENCY;
+    }
+
+    // Getters named after the former boost::optional members, the values are
+    // copied. Not source compatible: reads of sig.comment become
+    // sig.comment() and assignments become setter calls. Start values are a
+    // std::double_t or a std::string.
+    boost::optional<std::uint16_t> muxNdx() const
+    {
+        return has(MUX_NDX) ? boost::make_optional(muxNdxValue) : boost::none;
+    }
+    boost::optional<boost::any> startValue() const
+    {
+        if (!has(START_VALUE)) {
+            return boost::none;
+        }
+        return has(START_TEXT) ? boost::any(startText())
+                               : boost::any(startValueNumber);
+    }
+    boost::optional<std::string> comment() const
+    {
+        return has(COMMENT) ? boost::make_optional(commentText())
+                            : boost::none;
+    }
+    boost::optional<CANsignalType> valueType() const
+    {
+        return has(VALUE_TYPE) ? boost::make_optional(valueTypeValue)
+                               : boost::none;
+    }
+    boost::optional<CANvalueDescriptions_t> valueDescription() const
+    {
+        return has(VALUE_DESCRIPTION)
+            ? boost::make_optional(valueDescriptions())
+            : boost::none;
+    }
+    boost::optional<CANmuxDependency> muxDependency() const
+    {
+        return has(MUX_DEPENDENCY) ? boost::make_optional(*dependency())
+                                   : boost::none;
+    }
+    // Numbers of any arithmetic type are stored as std::double_t, other types
+    // than numbers and strings are dropped
+    void setStartValue(const boost::optional<boost::any>& value);
+
+private:
+    const CANsignalExtras& extra() const
+    {
+        return extras ? *extras : noExtras();
+    }
+    // Copy on write, extras are shared by copies of the signal
+    CANsignalExtras& edit();
+    static const CANsignalExtras& noExtras();
+
+    std::uint16_t muxNdxValue{ 0 };
+    CANsignalType valueTypeValue{ CANsignalType::Unknown };
+    std::uint8_t present{ 0 };
+    std::double_t startValueNumber{ 0 };
+    std::shared_ptr<CANsignalExtras> extras;
 };
 
+// Payload length in bytes of a CAN (FD) data length code
+inline std::uint8_t canDlcToLength(std::uint8_t dlc)
+{
+    static const std::uint8_t lengths[]{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16,
+        20, 24, 32, 48, 64 };
+    return lengths[dlc & 0x0F];
+}
+
+// Smallest CAN (FD) data length code holding a payload of the given length
+inline std::uint8_t canLengthToDlc(std::uint32_t length)
+{
+    std::uint8_t dlc = 0;
+    while (dlc < 15 && canDlcToLength(dlc) < length) {
+        ++dlc;
+    }
+    return dlc;
+}
+
 struct CANmessage {
     // Constructor required for vs2015 to be able to use initializer_list
     CANmessage(std::uint32_t _id, const std::string& _name = "",
@@ -88,6 +352,10 @@ struct CANmessage {
     {
     }
 
+    // Payload length in bytes. DBC files store the length of CAN FD
+    // messages as well, never a DLC code: 12 is 12 bytes, not 24.
+    std::uint32_t length() const { return dlc; }
+
     std::uint32_t id;
     std::string name;
     std::uint32_t dlc;
@@ -109,13 +377,11 @@ using CANmessages_t = std::map<CANmessage, std::vector<CANsignal>>;
 
 struct CANdb_t {
     struct ValTable {
-        std::string identifier;
+        // Former entry type, the id and ident fields are now value and label
+        using ValTableEntry = CANvalueDescription;
 
-        struct ValTableEntry {
-            std::uint32_t id;
-            std::string ident;
-        };
-        std::vector<ValTableEntry> entries;
+        std::string identifier;
+        CANvalueDescriptions_t entries;
     };
 
     std::map<CANmessage, std::vector<CANsignal>> messages;
@@ -0,0 +1,89 @@
+#include "changedecoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace CANdb {
+
+ChangeDecoder::ChangeDecoder(const CANdb_t& db)
+    : can_decoder(db)
+{
+    for (const auto& message : can_decoder.db().messages) {
+        const auto* plan = can_decoder.plan(message.first.id);
+        if (plan == nullptr) {
+            continue;
+        }
+
+        State state{ plan, {}, {}, 0, false };
+        for (std::uint32_t p = 0; p < plan->plans.size(); ++p) {
+            const auto index = plan->plans[p].index;
+            if ((*plan->signals)[index].muxType == CANsignalMuxType::Muxer
+                || (*plan->signals)[index].muxType
+                    == CANsignalMuxType::MuxedMuxer) {
+                state.muxers.push_back(p);
+            }
+        }
+        states.insert(std::make_pair(message.first.id, std::move(state)));
+    }
+}
+
+bool ChangeDecoder::decode(std::uint32_t id, const std::uint8_t* data,
+    std::size_t size, std::vector<DecodedSignal>& out)
+{
+    const auto it = states.find(id);
+    if (it == states.end()) {
+        return false;
+    }
+
+    auto& state = it->second;
+    const auto length = std::min(size, PAYLOAD_WORDS * 8);
+    std::uint64_t current[PAYLOAD_WORDS]{};
+    std::memcpy(current, data, length);
+
+    if (!state.valid || state.size != length) {
+        std::memcpy(state.payload, current, sizeof(current));
+        state.size = length;
+        state.valid = true;
+        can_decoder.decode(*state.plan, data, size, out);
+        return true;
+    }
+
+    // A classic CAN payload is compared in a single step
+    const auto words = (length + 7) / 8;
+    std::uint64_t diff[PAYLOAD_WORDS]{};
+    std::uint64_t changed = 0;
+    for (std::size_t i = 0; i < words; ++i) {
+        diff[i] = current[i] ^ state.payload[i];
+        changed |= diff[i];
+    }
+    if (changed == 0) {
+        return true;
+    }
+    std::memcpy(state.payload, current, sizeof(current));
+
+    // Signals are extracted from the xor of both payloads, a raw value other
+    // than zero means some bit of the signal changed
+    const auto* diffBytes = reinterpret_cast<const std::uint8_t*>(diff);
+    const auto& plan = *state.plan;
+    for (const auto muxer : state.muxers) {
+        if (extractRaw(plan.plans[muxer], diffBytes) != 0) {
+            can_decoder.decode(plan, data, size, out);
+            return true;
+        }
+    }
+
+    // Multiplexors are unchanged, so are the present signals. Only those
+    // with changed bits are extracted and scaled.
+    can_decoder.decode(plan, reinterpret_cast<const std::uint8_t*>(current),
+        diffBytes, length, out);
+    return true;
+}
+
+void ChangeDecoder::reset()
+{
+    for (auto& state : states) {
+        state.second.valid = false;
+    }
+}
+
+} // namespace CANdb
@@ -0,0 +1,48 @@
+#ifndef CHANGEDECODER_H_R2MWK7XD
+#define CHANGEDECODER_H_R2MWK7XD
+
+#include "decoder.h"
+
+namespace CANdb {
+
+// Stateful decoder emitting only the signals whose value changed since the
+// previous frame with the same id. Frames repeating their payload are
+// skipped after a single compare per 8 payload bytes, changed payloads only
+// extract and scale the signals whose bits differ.
+struct ChangeDecoder {
+    explicit ChangeDecoder(const CANdb_t& db);
+    // The per id state points into the plans of the decoder
+    ChangeDecoder(const ChangeDecoder&) = delete;
+    ChangeDecoder& operator=(const ChangeDecoder&) = delete;
+
+    // Appends the changed signals of a frame to `out`. The first frame of an
+    // id, a change of the payload length or a change of a multiplexor emit
+    // every present signal. Returns false if the id is not part of the
+    // database.
+    bool decode(std::uint32_t id, const std::uint8_t* data, std::size_t size,
+        std::vector<DecodedSignal>& out);
+
+    // Forgets all previous payloads
+    void reset();
+
+    const Decoder& decoder() const noexcept { return can_decoder; }
+
+private:
+    static const std::size_t PAYLOAD_WORDS{ 8 };
+
+    struct State {
+        const MessagePlan* plan;
+        // Signal plans of the multiplexors of the message
+        std::vector<std::uint32_t> muxers;
+        std::uint64_t payload[PAYLOAD_WORDS];
+        std::size_t size;
+        bool valid;
+    };
+
+    Decoder can_decoder;
+    std::unordered_map<std::uint32_t, State> states;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: CHANGEDECODER_H_R2MWK7XD */
@@ -0,0 +1,535 @@
+#include "columnarwriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Arrow format constants, see format/Schema.fbs and format/Message.fbs
+const std::int16_t METADATA_V5{ 4 };
+const std::uint8_t HEADER_SCHEMA{ 1 };
+const std::uint8_t HEADER_RECORD_BATCH{ 3 };
+const std::uint8_t TYPE_INT{ 2 };
+const std::uint8_t TYPE_FLOATING_POINT{ 3 };
+const std::uint8_t TYPE_TIMESTAMP{ 10 };
+const std::int16_t PRECISION_DOUBLE{ 2 };
+const std::int16_t UNIT_NANOSECOND{ 3 };
+
+const char MAGIC[]{ 'A', 'R', 'R', 'O', 'W', '1', 0, 0 };
+const std::uint32_t CONTINUATION{ 0xFFFFFFFF };
+const std::size_t INITIAL_ROWS{ 1024 };
+
+inline std::size_t align8(std::size_t size)
+{
+    return (size + 7) & ~std::size_t{ 7 };
+}
+
+// Minimal flatbuffers encoder for the Arrow metadata. Objects are written
+// front to back, after the objects referring to them, so offsets are
+// written as placeholders and patched with link() once the target exists.
+// Offsets of the last table's fields are looked up with slot().
+struct FlatBuilder {
+    struct Field {
+        std::uint16_t slot;
+        // 1, 2, 4 or 8 bytes, offsets are 4 byte placeholders
+        std::uint8_t size;
+        std::uint64_t value;
+    };
+
+    static Field offset(std::uint16_t slot) { return Field{ slot, 4, 0 }; }
+
+    FlatBuilder()
+        : data(4, 0)
+    {
+    }
+
+    void root(std::size_t table) { link(0, table); }
+
+    std::size_t table(std::vector<Field> fields)
+    {
+        // Largest fields first keeps them aligned without padding
+        std::stable_sort(fields.begin(), fields.end(),
+            [](const Field& a, const Field& b) { return a.size > b.size; });
+
+        std::uint16_t slots = 0;
+        std::size_t size = 4;
+        std::vector<std::uint16_t> layout;
+        for (const auto& field : fields) {
+            slots = std::max<std::uint16_t>(slots, field.slot + 1);
+            size = (size + field.size - 1) / field.size * field.size;
+            layout.push_back(static_cast<std::uint16_t>(size));
+            size += field.size;
+        }
+        size = (size + 3) & ~std::size_t{ 3 };
+
+        std::vector<std::uint16_t> vtable(2 + slots, 0);
+        vtable[0] = static_cast<std::uint16_t>(2 * vtable.size());
+        vtable[1] = static_cast<std::uint16_t>(size);
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            vtable[2 + fields[i].slot] = layout[i];
+        }
+        pad(2);
+        const auto vtablePosition = data.size();
+        for (const auto entry : vtable) {
+            scalar(entry, 2);
+        }
+
+        pad(8);
+        const auto position = data.size();
+        scalar(position - vtablePosition, 4);
+        data.resize(position + size, 0);
+        positions.assign(slots, 0);
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            const auto at = position + layout[i];
+            std::memcpy(&data[at], &fields[i].value, fields[i].size);
+            positions[fields[i].slot] = at;
+        }
+        return position;
+    }
+
+    // Position of a field of the last table
+    std::size_t slot(std::uint16_t index) const { return positions[index]; }
+
+    std::size_t string(const std::string& text)
+    {
+        pad(4);
+        const auto position = data.size();
+        scalar(text.size(), 4);
+        data.insert(data.end(), text.begin(), text.end());
+        data.push_back(0);
+        return position;
+    }
+
+    // Vector of `count` offsets, element i is at position + 4 + 4 * i
+    std::size_t offsets(std::size_t count)
+    {
+        pad(4);
+        const auto position = data.size();
+        scalar(count, 4);
+        data.resize(data.size() + 4 * count, 0);
+        return position;
+    }
+
+    // Vector of structs of 8 byte aligned structs
+    std::size_t structs(const void* elements, std::size_t count,
+        std::size_t elementSize)
+    {
+        while ((data.size() + 4) % 8 != 0) {
+            data.push_back(0);
+        }
+        const auto position = data.size();
+        scalar(count, 4);
+        const auto* bytes = static_cast<const std::uint8_t*>(elements);
+        data.insert(data.end(), bytes, bytes + count * elementSize);
+        return position;
+    }
+
+    void link(std::size_t at, std::size_t target)
+    {
+        const auto offset = static_cast<std::uint32_t>(target - at);
+        std::memcpy(&data[at], &offset, 4);
+    }
+
+    // The encoded buffer, padded to 8 bytes
+    const std::vector<std::uint8_t>& finish()
+    {
+        pad(8);
+        return data;
+    }
+
+private:
+    void pad(std::size_t alignment)
+    {
+        while (data.size() % alignment != 0) {
+            data.push_back(0);
+        }
+    }
+
+    void scalar(std::uint64_t value, std::size_t size)
+    {
+        // Flatbuffers are little endian like the hosts we build for
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+        data.insert(data.end(), bytes, bytes + size);
+    }
+
+    std::vector<std::uint8_t> data;
+    std::vector<std::size_t> positions;
+};
+
+// Arrow structs FieldNode, Buffer and Block
+struct FieldNode {
+    std::int64_t length;
+    std::int64_t nullCount;
+};
+
+struct Buffer {
+    std::int64_t offset;
+    std::int64_t length;
+};
+
+struct Block {
+    std::int64_t offset;
+    std::int32_t metaDataLength;
+    std::int32_t padding;
+    std::int64_t bodyLength;
+};
+
+void keyValue(FlatBuilder& builder, std::size_t at, const std::string& key,
+    const std::string& value)
+{
+    builder.link(at,
+        builder.table({ FlatBuilder::offset(0), FlatBuilder::offset(1) }));
+    const auto valueSlot = builder.slot(1);
+    const auto keySlot = builder.slot(0);
+    builder.link(keySlot, builder.string(key));
+    builder.link(valueSlot, builder.string(value));
+}
+
+enum class ColumnType { Int64, UInt64, Float64 };
+
+ColumnType columnType(const CANsignal& signal)
+{
+    const bool integer = signal.type() == CANsignalType::SignedUnsignedInt;
+    if (integer && signal.factor == 1.0 && signal.offset == 0.0) {
+        return signal.valueSigned ? ColumnType::Int64 : ColumnType::UInt64;
+    }
+    return ColumnType::Float64;
+}
+
+// Field table with a type table of the given fields and an optional "unit"
+// metadata entry
+std::size_t field(FlatBuilder& builder, const std::string& name,
+    bool nullable, std::uint8_t type,
+    const std::vector<FlatBuilder::Field>& typeFields,
+    const std::string& unit)
+{
+    const auto position = builder.table({ FlatBuilder::offset(0),
+        { 1, 1, nullable }, { 2, 1, type }, FlatBuilder::offset(3),
+        FlatBuilder::offset(5), FlatBuilder::offset(6) });
+    const auto nameSlot = builder.slot(0);
+    const auto typeSlot = builder.slot(3);
+    const auto childrenSlot = builder.slot(5);
+    const auto metadataSlot = builder.slot(6);
+
+    builder.link(nameSlot, builder.string(name));
+    builder.link(typeSlot, builder.table(typeFields));
+    builder.link(childrenSlot, builder.offsets(0));
+    const auto metadata = builder.offsets(unit.empty() ? 0 : 1);
+    builder.link(metadataSlot, metadata);
+    if (!unit.empty()) {
+        keyValue(builder, metadata + 4, "unit", unit);
+    }
+    return position;
+}
+
+} // namespace
+
+namespace CANdb {
+
+struct ColumnarWriter::Table {
+    struct Column {
+        ColumnType type;
+        bool floating;
+        std::uint64_t signBit;
+        std::vector<std::uint64_t> values;
+        std::vector<std::uint8_t> validity;
+    };
+
+    Table(const std::string& path, const MessagePlan& plan,
+        std::size_t rowGroup)
+        : path(path)
+        , signals(plan.signals)
+        , file(std::fopen(path.c_str(), "wb"))
+    {
+        if (file == nullptr) {
+            throw std::runtime_error("Failed to create " + path);
+        }
+        for (const auto& signal : *signals) {
+            const auto type = columnType(signal);
+            Column column{ type, type == ColumnType::Float64, 0, {}, {} };
+            if (signal.valueSigned && signal.signalSize > 0
+                && signal.signalSize <= 64) {
+                column.signBit = std::uint64_t{ 1 } << (signal.signalSize - 1);
+            }
+            columns.push_back(std::move(column));
+        }
+        grow(std::min(INITIAL_ROWS, rowGroup));
+    }
+
+    ~Table()
+    {
+        if (file != nullptr) {
+            std::fclose(file);
+        }
+    }
+
+    void append(std::uint64_t timestamp,
+        const std::vector<DecodedSignal>& decoded, std::size_t rowGroup)
+    {
+        if (rows == timestamps.size()) {
+            grow(std::min(2 * rows, rowGroup));
+        }
+        timestamps[rows] = timestamp;
+        const auto* first = signals->data();
+        const auto bit = static_cast<std::uint8_t>(1u << (rows % 8));
+        for (const auto& signal : decoded) {
+            auto& column = columns[signal.signal - first];
+            std::uint64_t value;
+            std::memcpy(&value, &signal.value, sizeof(value));
+            // Sign extends signed raw values, unsigned ones have no sign bit
+            const auto raw = (signal.raw ^ column.signBit) - column.signBit;
+            column.values[rows] = column.floating ? value : raw;
+            column.validity[rows / 8] |= bit;
+        }
+        ++rows;
+    }
+
+    bool full(std::size_t rowGroup) const { return rows >= rowGroup; }
+
+    std::uint64_t writeSchema(const CANmessage& message)
+    {
+        write(MAGIC, sizeof(MAGIC));
+        FlatBuilder builder;
+        builder.root(builder.table({ { 0, 2, METADATA_V5 },
+            { 1, 1, HEADER_SCHEMA }, FlatBuilder::offset(2) }));
+        const auto headerSlot = builder.slot(2);
+        builder.link(headerSlot, schema(builder, message));
+        return sizeof(MAGIC) + writeMessage(builder.finish());
+    }
+
+    std::uint64_t writeBatch()
+    {
+        if (rows == 0) {
+            return 0;
+        }
+
+        std::vector<FieldNode> nodes{ { static_cast<std::int64_t>(rows), 0 } };
+        std::vector<Buffer> buffers;
+        std::int64_t bodyLength = 0;
+        const auto buffer = [&buffers, &bodyLength](std::size_t length) {
+            buffers.push_back(Buffer{ bodyLength,
+                static_cast<std::int64_t>(length) });
+            bodyLength += static_cast<std::int64_t>(align8(length));
+        };
+
+        buffer(0);
+        buffer(8 * rows);
+        for (const auto& column : columns) {
+            std::int64_t valid = 0;
+            for (std::size_t i = 0; i < (rows + 7) / 8; ++i) {
+                valid += bitCount(column.validity[i]);
+            }
+            const auto nulls = static_cast<std::int64_t>(rows) - valid;
+            nodes.push_back({ static_cast<std::int64_t>(rows), nulls });
+            buffer(nulls != 0 ? (rows + 7) / 8 : 0);
+            buffer(8 * rows);
+        }
+
+        FlatBuilder builder;
+        builder.root(builder.table({ { 0, 2, METADATA_V5 },
+            { 1, 1, HEADER_RECORD_BATCH }, FlatBuilder::offset(2),
+            { 3, 8, static_cast<std::uint64_t>(bodyLength) } }));
+        const auto headerSlot = builder.slot(2);
+        builder.link(headerSlot,
+            builder.table({ { 0, 8, rows }, FlatBuilder::offset(1),
+                FlatBuilder::offset(2) }));
+        const auto nodesSlot = builder.slot(1);
+        const auto buffersSlot = builder.slot(2);
+        builder.link(nodesSlot,
+            builder.structs(nodes.data(), nodes.size(), sizeof(FieldNode)));
+        builder.link(buffersSlot,
+            builder.structs(buffers.data(), buffers.size(), sizeof(Buffer)));
+
+        const auto start = offset;
+        const auto written = writeMessage(builder.finish());
+        batches.push_back(Block{ static_cast<std::int64_t>(start),
+            static_cast<std::int32_t>(written), 0, bodyLength });
+        // Timestamps are never null and have no validity bitmap
+        writeBuffer(timestamps.data(), 8 * rows);
+        for (std::size_t i = 0; i < columns.size(); ++i) {
+            auto& column = columns[i];
+            writeBuffer(column.validity.data(),
+                static_cast<std::size_t>(buffers[2 + 2 * i].length));
+            writeBuffer(column.values.data(), 8 * rows);
+            std::fill(column.validity.begin(), column.validity.end(), 0);
+        }
+        rows = 0;
+        return written + static_cast<std::uint64_t>(bodyLength);
+    }
+
+    // Writes the end of stream marker, the footer and closes the file
+    std::uint64_t finish(const CANmessage& message)
+    {
+        auto written = writeBatch();
+        const std::uint32_t eos[]{ CONTINUATION, 0 };
+        write(eos, sizeof(eos));
+
+        FlatBuilder builder;
+        builder.root(builder.table({ { 0, 2, METADATA_V5 },
+            FlatBuilder::offset(1), FlatBuilder::offset(2),
+            FlatBuilder::offset(3) }));
+        const auto schemaSlot = builder.slot(1);
+        const auto dictionariesSlot = builder.slot(2);
+        const auto batchesSlot = builder.slot(3);
+        builder.link(schemaSlot, schema(builder, message));
+        builder.link(dictionariesSlot, builder.structs(nullptr, 0, 0));
+        builder.link(batchesSlot,
+            builder.structs(batches.data(), batches.size(), sizeof(Block)));
+        const auto& footer = builder.finish();
+        const auto footerSize = static_cast<std::uint32_t>(footer.size());
+        write(footer.data(), footer.size());
+        write(&footerSize, sizeof(footerSize));
+        write(MAGIC, 6);
+
+        const bool closed = std::fclose(file) == 0;
+        file = nullptr;
+        if (!closed) {
+            throw std::runtime_error("Failed to write " + path);
+        }
+        return written + sizeof(eos) + footer.size() + sizeof(footerSize) + 6;
+    }
+
+private:
+    void grow(std::size_t capacity)
+    {
+        timestamps.resize(capacity);
+        for (auto& column : columns) {
+            column.values.resize(capacity);
+            column.validity.resize((capacity + 7) / 8);
+        }
+    }
+
+    static unsigned bitCount(std::uint8_t byte)
+    {
+        unsigned count = 0;
+        for (; byte != 0; byte &= static_cast<std::uint8_t>(byte - 1)) {
+            ++count;
+        }
+        return count;
+    }
+
+    std::size_t schema(FlatBuilder& builder, const CANmessage& message)
+    {
+        const auto position = builder.table({ { 0, 2, 0 },
+            FlatBuilder::offset(1), FlatBuilder::offset(2) });
+        const auto fieldsSlot = builder.slot(1);
+        const auto metadataSlot = builder.slot(2);
+
+        const auto fields = builder.offsets(1 + signals->size());
+        builder.link(fieldsSlot, fields);
+        builder.link(fields + 4,
+            field(builder, "timestamp", false, TYPE_TIMESTAMP,
+                { { 0, 2, static_cast<std::uint64_t>(UNIT_NANOSECOND) } },
+                ""));
+        for (std::size_t i = 0; i < signals->size(); ++i) {
+            const auto& signal = (*signals)[i];
+            const auto type = columns[i].type;
+            const auto position = type == ColumnType::Float64
+                ? field(builder, signal.signal_name, true, TYPE_FLOATING_POINT,
+                      { { 0, 2,
+                          static_cast<std::uint64_t>(PRECISION_DOUBLE) } },
+                      signal.unit)
+                : field(builder, signal.signal_name, true, TYPE_INT,
+                      { { 0, 4, 64 }, { 1, 1, type == ColumnType::Int64 } },
+                      signal.unit);
+            builder.link(fields + 8 + 4 * i, position);
+        }
+
+        const auto metadata = builder.offsets(2);
+        builder.link(metadataSlot, metadata);
+        keyValue(builder, metadata + 4, "message", message.name);
+        keyValue(builder, metadata + 8, "id", std::to_string(message.id));
+        return position;
+    }
+
+    // Writes the metadata of an encapsulated message, preceded by the
+    // continuation marker and its size. Returns the bytes written.
+    std::uint32_t writeMessage(const std::vector<std::uint8_t>& metadata)
+    {
+        const auto size = static_cast<std::uint32_t>(metadata.size());
+        write(&CONTINUATION, 4);
+        write(&size, 4);
+        write(metadata.data(), metadata.size());
+        return 8 + size;
+    }
+
+    void writeBuffer(const void* buffer, std::size_t length)
+    {
+        static const std::uint8_t zeros[8]{};
+        write(buffer, length);
+        write(zeros, align8(length) - length);
+    }
+
+    void write(const void* buffer, std::size_t length)
+    {
+        if (length != 0 && std::fwrite(buffer, 1, length, file) != length) {
+            throw std::runtime_error("Failed to write " + path);
+        }
+        offset += length;
+    }
+
+    std::string path;
+    const std::vector<CANsignal>* signals;
+    std::FILE* file;
+    std::uint64_t offset{ 0 };
+    std::size_t rows{ 0 };
+    std::vector<std::uint64_t> timestamps;
+    std::vector<Column> columns;
+    std::vector<Block> batches;
+};
+
+ColumnarWriter::ColumnarWriter(std::string prefix, std::size_t rowGroup)
+    : prefix(std::move(prefix))
+    , rowGroup(std::max<std::size_t>(rowGroup, 1))
+{
+}
+
+ColumnarWriter::~ColumnarWriter()
+{
+    try {
+        finish();
+    } catch (const std::runtime_error&) {
+    }
+}
+
+ColumnarWriter::Table& ColumnarWriter::table(const MessagePlan& plan)
+{
+    auto it = tables.find(plan.message);
+    if (it == tables.end()) {
+        std::unique_ptr<Table> table{ new Table(
+            prefix + plan.message->name + ".arrow", plan, rowGroup) };
+        written += table->writeSchema(*plan.message);
+        it = tables.emplace(plan.message, std::move(table)).first;
+    }
+    return *it->second;
+}
+
+void ColumnarWriter::append(std::uint64_t timestamp, const MessagePlan& plan,
+    const std::vector<DecodedSignal>& signals)
+{
+    // Frames of the same message tend to follow each other
+    if (plan.message != lastMessage) {
+        lastTable = &table(plan);
+        lastMessage = plan.message;
+    }
+    auto& rows = *lastTable;
+    rows.append(timestamp, signals, rowGroup);
+    if (rows.full(rowGroup)) {
+        written += rows.writeBatch();
+    }
+}
+
+void ColumnarWriter::finish()
+{
+    // Tables are removed first so a failing file is not finished twice
+    auto finishing = std::move(tables);
+    tables.clear();
+    lastMessage = nullptr;
+    lastTable = nullptr;
+    for (auto& table : finishing) {
+        written += table.second->finish(*table.first);
+    }
+}
+
+} // namespace CANdb
@@ -0,0 +1,62 @@
+#ifndef COLUMNARWRITER_H_W3KD8QPZ
+#define COLUMNARWRITER_H_W3KD8QPZ
+
+#include "decoder.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CANdb {
+
+// Writes decoded signals as Arrow IPC files (Feather V2), one file per
+// message named <prefix><message name>.arrow. Each file holds a nanosecond
+// "timestamp" column followed by a nullable column per signal of the
+// message: Int64 or UInt64 for unscaled integer signals, Float64 otherwise.
+// Signals missing from a frame, because of multiplexing or a short payload,
+// are null. Units are stored in the field metadata under "unit".
+//
+// Rows are buffered per message and written as one record batch every
+// `rowGroup` rows, files are opened when their message is first appended.
+struct ColumnarWriter {
+    static const std::size_t DEFAULT_ROW_GROUP{ 1 << 16 };
+
+    explicit ColumnarWriter(
+        std::string prefix, std::size_t rowGroup = DEFAULT_ROW_GROUP);
+    // Finishes the files, errors are ignored. Call finish() to see them.
+    ~ColumnarWriter();
+
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    // Appends a row to the file of the plan's message. `signals` is the
+    // result of Decoder::decode for that plan. Throws std::runtime_error if
+    // the file can not be created or written.
+    void append(std::uint64_t timestamp, const MessagePlan& plan,
+        const std::vector<DecodedSignal>& signals);
+
+    // Writes the buffered rows and the file footers and closes the files.
+    // Throws std::runtime_error on write errors.
+    void finish();
+
+    // Bytes written to the files so far
+    std::uint64_t bytes() const noexcept { return written; }
+
+    struct Table;
+
+private:
+    Table& table(const MessagePlan& plan);
+
+    std::string prefix;
+    std::size_t rowGroup;
+    std::unordered_map<const CANmessage*, std::unique_ptr<Table>> tables;
+    const CANmessage* lastMessage{ nullptr };
+    Table* lastTable{ nullptr };
+    std::uint64_t written{ 0 };
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: COLUMNARWRITER_H_W3KD8QPZ */
@@ -0,0 +1,252 @@
+#include "cyclemonitor.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace CANdb {
+
+const std::size_t CycleStats::JITTER_BUCKETS;
+const unsigned CycleMonitor::WHEEL_BITS;
+const std::uint32_t CycleMonitor::WHEEL_SIZE;
+const unsigned CycleMonitor::LEVELS;
+const std::uint32_t CycleMonitor::NONE;
+
+CycleMonitor::CycleMonitor(
+    const CANdb_t& db, Handler _handler, CycleMonitorOptions _options)
+    : handler(std::move(_handler))
+    , options(_options)
+    , slots(LEVELS * WHEEL_SIZE, NONE)
+{
+    if (options.resolution == 0 || options.tolerance < 0
+        || options.timeout <= 0) {
+        throw std::runtime_error("Invalid cycle time monitor options");
+    }
+    occupied.fill(0);
+
+    for (const auto& message : db.messages) {
+        const auto& cycleTime = message.first.cycleTime
+            ? message.first.cycleTime
+            : db.genMsgCycleTimeDefault;
+        if (!cycleTime || *cycleTime == 0) {
+            continue;
+        }
+        const std::uint64_t period = *cycleTime * std::uint64_t{ 1000000 };
+
+        indexes.emplace(
+            message.first.id, static_cast<std::uint32_t>(messages.size()));
+        CycleStats stats;
+        stats.id = message.first.id;
+        stats.period = period;
+        stats.frames = stats.intervals = 0;
+        stats.missing = stats.late = stats.tooFast = 0;
+        stats.minJitter = stats.maxJitter = 0;
+        stats.histogram.fill(0);
+        messages.push_back(stats);
+
+        Timer timer;
+        timer.slack = static_cast<std::uint64_t>(period * options.tolerance);
+        timer.timeout = static_cast<std::uint64_t>(period * options.timeout);
+        timer.expiry = timer.last = 0;
+        timer.previous = timer.next = timer.slot = NONE;
+        timer.armed = timer.seen = timer.missing = false;
+        timers.push_back(timer);
+    }
+}
+
+void CycleMonitor::observe(std::uint32_t id, std::uint64_t timestamp)
+{
+    const auto found = indexes.find(id);
+    if (found == indexes.end()) {
+        return;
+    }
+    // Timeouts up to the frame expire first
+    advance(timestamp);
+
+    const auto index = found->second;
+    auto& stats = messages[index];
+    auto& timer = timers[index];
+    ++stats.frames;
+
+    if (timer.seen && timestamp >= timer.last) {
+        const auto interval = timestamp - timer.last;
+        const auto jitter = static_cast<std::int64_t>(interval)
+            - static_cast<std::int64_t>(stats.period);
+        if (stats.intervals++ == 0) {
+            stats.minJitter = stats.maxJitter = jitter;
+        } else {
+            stats.minJitter = std::min(stats.minJitter, jitter);
+            stats.maxJitter = std::max(stats.maxJitter, jitter);
+        }
+        ++stats.histogram[std::min<std::uint64_t>(
+            interval * 8 / stats.period, CycleStats::JITTER_BUCKETS - 1)];
+
+        // A message that came back was already reported missing
+        if (!timer.missing && interval > stats.period + timer.slack) {
+            ++stats.late;
+            handler(CycleEvent{
+                CycleEvent::Kind::Late, stats.id, timestamp, interval });
+        } else if (interval + timer.slack < stats.period) {
+            ++stats.tooFast;
+            handler(CycleEvent{
+                CycleEvent::Kind::TooFast, stats.id, timestamp, interval });
+        }
+    }
+    timer.last = timestamp;
+    timer.seen = true;
+    timer.missing = false;
+
+    // Re-arms the timeout
+    if (timer.armed) {
+        unlink(index);
+    } else {
+        timer.armed = true;
+        ++armed;
+    }
+    const auto deadline = (timestamp + timer.timeout + options.resolution - 1)
+        / options.resolution;
+    // Timeouts beyond the last level are clamped to its range
+    timer.expiry = std::min(std::max(deadline, current),
+        current + (std::uint64_t{ 1 } << (WHEEL_BITS * LEVELS)) - 1);
+    insert(index);
+}
+
+void CycleMonitor::advance(std::uint64_t timestamp)
+{
+    const auto tick = timestamp / options.resolution;
+    if (!started) {
+        current = tick;
+        started = true;
+    }
+    if (tick >= current) {
+        tickTo(tick);
+    }
+}
+
+const CycleStats* CycleMonitor::stats(std::uint32_t id) const
+{
+    const auto found = indexes.find(id);
+    return found != indexes.end() ? &messages[found->second] : nullptr;
+}
+
+void CycleMonitor::insert(std::uint32_t index)
+{
+    auto& timer = timers[index];
+    // The level is chosen by the distance to the timeout, the slot by the
+    // bits of the expiry of that level
+    const auto delta = timer.expiry - current;
+    unsigned level = 0;
+    while (level + 1 < LEVELS
+        && delta >= std::uint64_t{ 1 } << (WHEEL_BITS * (level + 1))) {
+        ++level;
+    }
+    const auto position = static_cast<std::uint32_t>(
+        (timer.expiry >> (WHEEL_BITS * level)) & (WHEEL_SIZE - 1));
+    timer.slot = level * WHEEL_SIZE + position;
+    timer.previous = NONE;
+    timer.next = slots[timer.slot];
+    if (timer.next != NONE) {
+        timers[timer.next].previous = index;
+    }
+    slots[timer.slot] = index;
+    if (level == 0) {
+        occupied[position / 64] |= std::uint64_t{ 1 } << (position % 64);
+    }
+}
+
+void CycleMonitor::unlink(std::uint32_t index)
+{
+    const auto& timer = timers[index];
+    if (timer.previous != NONE) {
+        timers[timer.previous].next = timer.next;
+    } else {
+        slots[timer.slot] = timer.next;
+    }
+    if (timer.next != NONE) {
+        timers[timer.next].previous = timer.previous;
+    }
+    const auto slot = timer.slot;
+    if (slot < WHEEL_SIZE && slots[slot] == NONE) {
+        occupied[slot / 64] &= ~(std::uint64_t{ 1 } << (slot % 64));
+    }
+}
+
+void CycleMonitor::cascade(unsigned level)
+{
+    // Timeouts of the slot expire within the next slot of the level below,
+    // they move down the wheel
+    auto& head = slots[level * WHEEL_SIZE
+        + ((current >> (WHEEL_BITS * level)) & (WHEEL_SIZE - 1))];
+    auto index = head;
+    head = NONE;
+    while (index != NONE) {
+        const auto next = timers[index].next;
+        insert(index);
+        index = next;
+    }
+}
+
+void CycleMonitor::expire(std::uint32_t slot)
+{
+    auto index = slots[slot];
+    slots[slot] = NONE;
+    occupied[slot / 64] &= ~(std::uint64_t{ 1 } << (slot % 64));
+
+    const auto timestamp = current * options.resolution;
+    while (index != NONE) {
+        auto& timer = timers[index];
+        const auto next = timer.next;
+        timer.armed = false;
+        --armed;
+        if (!timer.missing) {
+            timer.missing = true;
+            auto& stats = messages[index];
+            ++stats.missing;
+            handler(CycleEvent{ CycleEvent::Kind::Missing, stats.id, timestamp,
+                timestamp - timer.last });
+        }
+        index = next;
+    }
+}
+
+std::uint32_t CycleMonitor::nextOccupied(std::uint32_t slot) const
+{
+    while (slot < WHEEL_SIZE) {
+        const auto word = occupied[slot / 64] >> (slot % 64);
+        if (word == 0) {
+            slot = (slot / 64 + 1) * 64;
+        } else if ((word & 1) != 0) {
+            return slot;
+        } else {
+            ++slot;
+        }
+    }
+    return WHEEL_SIZE;
+}
+
+void CycleMonitor::tickTo(std::uint64_t tick)
+{
+    while (current <= tick) {
+        if (armed == 0) {
+            current = tick + 1;
+            return;
+        }
+        // Higher levels move down at the start of each of their slots
+        for (unsigned level = LEVELS - 1; level != 0; --level) {
+            const auto mask = (std::uint64_t{ 1 } << (WHEEL_BITS * level)) - 1;
+            if ((current & mask) == 0) {
+                cascade(level);
+            }
+        }
+
+        const auto position
+            = static_cast<std::uint32_t>(current & (WHEEL_SIZE - 1));
+        if (slots[position] != NONE) {
+            expire(position);
+        }
+        // Empty slots up to the end of the first level are skipped
+        current = std::min(
+            current - position + nextOccupied(position + 1), tick + 1);
+    }
+}
+
+} // namespace CANdb
@@ -0,0 +1,133 @@
+#ifndef CYCLEMONITOR_H_D5QW8HZN
+#define CYCLEMONITOR_H_D5QW8HZN
+
+#include "canframe.h"
+#include "cantypes.hpp"
+
+#include <array>
+#include <functional>
+#include <unordered_map>
+
+namespace CANdb {
+
+struct CycleMonitorOptions {
+    // Timer wheel tick in nanoseconds, missing messages are detected with
+    // this resolution
+    std::uint64_t resolution{ 1000000 };
+    // Frames are late or too fast when their interval differs from the cycle
+    // time by more than this fraction of it
+    std::double_t tolerance{ 0.1 };
+    // Messages are missing after this many cycle times without a frame
+    std::double_t timeout{ 3.0 };
+};
+
+struct CycleEvent {
+    enum class Kind { Missing, Late, TooFast };
+
+    Kind kind;
+    std::uint32_t id;
+    // Frame timestamp, for missing messages the time the timeout expired
+    std::uint64_t timestamp;
+    // Time since the previous frame of the message
+    std::uint64_t interval;
+};
+
+// Jitter is the difference between the interval of two frames and the cycle
+// time. The histogram has buckets of an eighth of the cycle time from -100%,
+// the last bucket also counts everything beyond +87.5%.
+struct CycleStats {
+    static const std::size_t JITTER_BUCKETS{ 16 };
+
+    std::uint32_t id;
+    // Cycle time in nanoseconds
+    std::uint64_t period;
+    std::uint64_t frames;
+    // Intervals between frames, the total of the histogram
+    std::uint64_t intervals;
+    std::uint64_t missing;
+    std::uint64_t late;
+    std::uint64_t tooFast;
+    std::int64_t minJitter;
+    std::int64_t maxJitter;
+    std::array<std::uint64_t, JITTER_BUCKETS> histogram;
+};
+
+// Watches the cycle times (GenMsgCycleTime) of the messages of a database.
+// Frame timestamps drive the clock: every frame re-arms the timeout of its
+// message on a hierarchical timer wheel, so the cost per frame is constant
+// and expired timeouts are found without scanning the messages.
+struct CycleMonitor {
+    using Handler = std::function<void(const CycleEvent&)>;
+
+    // Monitors every message with a cycle time, the message's own or the
+    // database default
+    CycleMonitor(const CANdb_t& db, Handler handler,
+        CycleMonitorOptions options = CycleMonitorOptions{});
+
+    // Records a frame, timestamps in nanoseconds are expected in order.
+    // Frames of messages without a cycle time are ignored.
+    void observe(std::uint32_t id, std::uint64_t timestamp);
+    void observe(const CANframe& frame)
+    {
+        observe(frame.dbcId(), frame.timestamp);
+    }
+
+    // Moves the clock forward without a frame, e.g. from a timer while the
+    // bus is silent
+    void advance(std::uint64_t timestamp);
+
+    // Events are raised from observe() and advance(), handlers must not call
+    // either of them.
+
+    // Statistics of a monitored message, nullptr for other ids
+    const CycleStats* stats(std::uint32_t id) const;
+    // All monitored messages
+    const std::vector<CycleStats>& all() const noexcept { return messages; }
+
+private:
+    static const unsigned WHEEL_BITS{ 8 };
+    static const std::uint32_t WHEEL_SIZE{ 1 << WHEEL_BITS };
+    static const unsigned LEVELS{ 4 };
+    static const std::uint32_t NONE{ 0xFFFFFFFF };
+
+    // Intrusive list node of a message's timeout
+    struct Timer {
+        // Allowed deviation from the cycle time and the missing timeout
+        std::uint64_t slack;
+        std::uint64_t timeout;
+        // Tick of the timeout and timestamp of the last frame
+        std::uint64_t expiry;
+        std::uint64_t last;
+        std::uint32_t previous;
+        std::uint32_t next;
+        std::uint32_t slot;
+        bool armed;
+        bool seen;
+        bool missing;
+    };
+
+    void insert(std::uint32_t index);
+    void unlink(std::uint32_t index);
+    void cascade(unsigned level);
+    void expire(std::uint32_t slot);
+    std::uint32_t nextOccupied(std::uint32_t slot) const;
+    void tickTo(std::uint64_t tick);
+
+    Handler handler;
+    CycleMonitorOptions options;
+    std::unordered_map<std::uint32_t, std::uint32_t> indexes;
+    std::vector<CycleStats> messages;
+    std::vector<Timer> timers;
+    // LEVELS * WHEEL_SIZE list heads
+    std::vector<std::uint32_t> slots;
+    // Occupied slots of the first level
+    std::array<std::uint64_t, WHEEL_SIZE / 64> occupied;
+    // Next tick to process
+    std::uint64_t current{ 0 };
+    std::size_t armed{ 0 };
+    bool started{ false };
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: CYCLEMONITOR_H_D5QW8HZN */
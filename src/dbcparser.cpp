@@ -2,6 +2,7 @@
 #include "log.hpp"
 #include <dbc_grammar.hpp>
 
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <peglib.h>
@@ -108,7 +109,8 @@ inline std::vector<CANsignal>::iterator
     return signalIt;
 }
 
-void appendMessageTransmittingEcus(CANdb_t &canDb, uint32_t id,
+void appendMessageTransmittingEcus(CANdb_t &canDb,
+    CANdb::DbFingerprint& fingerprint, uint32_t id,
     std::deque<std::string>& ecus)
 {
     cdb_debug("Appending transmitting ECUs for message {}", id);
@@ -128,12 +130,15 @@ void appendMessageTransmittingEcus(CANdb_t &canDb, uint32_t id,
                 updatedMessage.ecus.push_back(currentEcu);
             }
         }
+        fingerprint.remove(messageIt->first);
+        fingerprint.add(updatedMessage);
         canDb.messages.erase(messageIt->first);
         canDb.messages[updatedMessage] = existingSignals;
     }
 }
 
-void setMessageComment(CANdb_t &canDb, uint32_t id, const std::string& comment)
+void setMessageComment(CANdb_t &canDb,
+    CANdb::DbFingerprint& fingerprint, uint32_t id, const std::string& comment)
 {
     cdb_debug("Setting the comment for message {} to \"{}\"", id, comment);
     bool messageItFound = false;
@@ -148,12 +153,15 @@ void setMessageComment(CANdb_t &canDb, uint32_t id, const std::string& comment)
         CANmessage updatedMessage(messageIt->first);
         std::vector<CANsignal> existingSignals(messageIt->second);
         updatedMessage.comment = comment;
+        fingerprint.remove(messageIt->first);
+        fingerprint.add(updatedMessage);
         canDb.messages.erase(messageIt->first);
         canDb.messages[updatedMessage] = existingSignals;
     }
 }
 
-void setSignalComment(CANdb_t &canDb, uint32_t id,
+void setSignalComment(CANdb_t &canDb,
+    CANdb::DbFingerprint& fingerprint, uint32_t id,
     const std::string& signalName, const std::string& comment)
 {
     cdb_debug("Setting the comment for signal {}:{} to \"{}\"", id, signalName,
@@ -163,11 +171,14 @@ void setSignalComment(CANdb_t &canDb, uint32_t id,
         &signalItFound);
     if (signalItFound) {
         cdb_debug("Found the signal that needs the new comment");
-        signalIt->comment = comment;
+        fingerprint.remove(id, *signalIt);
+        signalIt->setComment(comment);
+        fingerprint.add(id, *signalIt);
     }
 }
 
-void setMessageCycleTime(CANdb_t &canDb, uint32_t id, std::uint32_t cycleTime)
+void setMessageCycleTime(CANdb_t &canDb,
+    CANdb::DbFingerprint& fingerprint, uint32_t id, std::uint32_t cycleTime)
 {
     cdb_debug("Setting the cycle time for message {} to \"{}\"", id, cycleTime);
     bool messageItFound = false;
@@ -179,12 +190,15 @@ void setMessageCycleTime(CANdb_t &canDb, uint32_t id, std::uint32_t cycleTime)
         CANmessage updatedMessage(messageIt->first);
         std::vector<CANsignal> existingSignals(messageIt->second);
         updatedMessage.cycleTime = cycleTime;
+        fingerprint.remove(messageIt->first);
+        fingerprint.add(updatedMessage);
         canDb.messages.erase(messageIt->first);
         canDb.messages[updatedMessage] = existingSignals;
     }
 }
 
-void setSignalStartValue(CANdb_t &canDb, uint32_t id,
+void setSignalStartValue(CANdb_t &canDb,
+    CANdb::DbFingerprint& fingerprint, uint32_t id,
     const std::string& signalName, const boost::any& value)
 {
     cdb_debug("Setting the start value for signal {}:{}", id, signalName);
@@ -193,11 +207,14 @@ void setSignalStartValue(CANdb_t &canDb, uint32_t id,
         &signalItFound);
     if (signalItFound) {
         cdb_debug("Found the signal that needs the new start value");
-        signalIt->startValue = value;
+        fingerprint.remove(id, *signalIt);
+        signalIt->setStartValue(boost::make_optional(value));
+        fingerprint.add(id, *signalIt);
     }
 }
 
-void setSignalValueType(CANdb_t &canDb, uint32_t id,
+void setSignalValueType(CANdb_t &canDb,
+    CANdb::DbFingerprint& fingerprint, uint32_t id,
     const std::string& signalName, uint8_t valueTypeRaw)
 {
     cdb_debug("Setting the value type for signal {}:{} to \"{}\"", id,
@@ -207,23 +224,66 @@ void setSignalValueType(CANdb_t &canDb, uint32_t id,
         &signalItFound);
     if (signalItFound) {
         cdb_debug("Found the signal that needs the new value type");
-        signalIt->valueType =
+        fingerprint.remove(id, *signalIt);
+        signalIt->setValueType(
             valueTypeRaw < static_cast<std::uint8_t>(CANsignalType::Count)
-            ? static_cast<CANsignalType>(valueTypeRaw) : CANsignalType::Unknown;
+                ? static_cast<CANsignalType>(valueTypeRaw)
+                : CANsignalType::Unknown);
+        fingerprint.add(id, *signalIt);
     }
 }
 
-void setSignalValueDescription(CANdb_t &canDb, uint32_t id,
-    const std::string& signalName, const std::string& valueDescription)
+void setSignalValueDescription(CANdb_t &canDb,
+    CANdb::DbFingerprint& fingerprint, uint32_t id,
+    const std::string& signalName,
+    const CANvalueDescriptions_t& valueDescription)
 {
-    cdb_debug("Setting the value description for signal {}:{} to \"{}\"", id,
-        signalName, valueDescription);
+    cdb_debug("Setting {} value descriptions for signal {}:{}",
+        valueDescription.size(), id, signalName);
     bool signalItFound = false;
     auto signalIt = getSignalIteratorByMessageIdAndName(canDb, id, signalName,
         &signalItFound);
     if (signalItFound) {
         cdb_debug("Found the signal that needs the new value description");
-        signalIt->valueDescription = valueDescription;
+        fingerprint.remove(id, *signalIt);
+        signalIt->setValueDescription(valueDescription);
+        fingerprint.add(id, *signalIt);
+    }
+}
+
+// Sorts value descriptions by value, keeping the last description given for
+// a duplicated value
+CANvalueDescriptions_t sortedValueDescriptions(
+    std::vector<CANvalueDescription> descriptions)
+{
+    std::reverse(descriptions.begin(), descriptions.end());
+    std::stable_sort(descriptions.begin(), descriptions.end(),
+        [](const CANvalueDescription& lhs, const CANvalueDescription& rhs) {
+            return lhs.value < rhs.value;
+        });
+    descriptions.erase(std::unique(descriptions.begin(), descriptions.end(),
+                           [](const CANvalueDescription& lhs,
+                               const CANvalueDescription& rhs) {
+                               return lhs.value == rhs.value;
+                           }),
+        descriptions.end());
+    return descriptions;
+}
+
+void setSignalMuxDependency(CANdb_t &canDb,
+    CANdb::DbFingerprint& fingerprint, uint32_t id,
+    const std::string& signalName, const CANmuxDependency& dependency)
+{
+    cdb_debug("Setting the multiplexor switch for signal {}:{} to \"{}\"", id,
+        signalName, dependency.muxSwitch);
+    bool signalItFound = false;
+    auto signalIt = getSignalIteratorByMessageIdAndName(canDb, id, signalName,
+        &signalItFound);
+    if (signalItFound) {
+        cdb_debug("Found the signal that needs the new multiplexor switch");
+        fingerprint.remove(id, *signalIt);
+        signalIt->setMuxDependency(dependency);
+        fingerprint.add(id, *signalIt);
     }
 }
 
@@ -250,14 +310,13 @@ bool DBCParser::parse(const std::string& data) noexcept
     cdb_debug("DBC file  = \n{}", withLines(noTabsData));
 
     strings phrases;
-    std::deque<std::string> idents, signs, ecu_tokens;
+    std::deque<std::string> idents, signs, ecu_tokens, mux_ranges;
     std::deque<std::double_t> numbers;
 
     CANsignalMuxType muxType = CANsignalMuxType::NotMuxed;
     int muxNdx = -1;
 
-    using PhrasePair = std::pair<std::uint32_t, std::string>;
-    std::vector<PhrasePair> phrasesPairs;
+    std::vector<CANvalueDescription> phrasesPairs;
 
     parser["version"] = [this, &phrases](const peg::SemanticValues&) {
         if (phrases.empty()) {
@@ -330,22 +389,26 @@ bool DBCParser::parse(const std::string& data) noexcept
 
     parser["number_phrase_pair"]
         = [&phrasesPairs, &numbers, &phrases](const peg::SemanticValues&) {
-              phrasesPairs.push_back(
-                  std::make_pair(take_back(numbers), take_back(phrases)));
+              auto label = take_back(phrases);
+              phrasesPairs.push_back(CANvalueDescription{
+                  static_cast<std::int64_t>(take_back(numbers)), label });
           };
 
-    parser["val_entry"] = [this, &phrasesPairs](const peg::SemanticValues&) {
-        std::vector<CANdb_t::ValTable::ValTableEntry> tab;
-        std::transform(phrasesPairs.begin(), phrasesPairs.end(),
-            std::back_inserter(tab), [](const PhrasePair& p) {
-                return CANdb_t::ValTable::ValTableEntry{ p.first, p.second };
-            });
-        can_db.val_tables.push_back(CANdb_t::ValTable{ "", tab });
+    parser["val_entry"] = [this, &phrasesPairs, &idents](
+                              const peg::SemanticValues& sv) {
+        cdb_debug("Found val_table {}", sv.token());
+        auto identifier = take_back(idents);
+        can_db.val_tables.push_back(CANdb_t::ValTable{ identifier,
+            sortedValueDescriptions(phrasesPairs) });
         phrasesPairs.clear();
+        idents.clear();
     };
 
-    parser["muxer"] = [&muxType](const peg::SemanticValues&)
-        { muxType = CANsignalMuxType::Muxer; };
+    parser["muxer"] = [&muxType](const peg::SemanticValues&) {
+        // "m<n>M" marks a muxed signal that is itself a multiplexor
+        muxType = muxType == CANsignalMuxType::Muxed
+            ? CANsignalMuxType::MuxedMuxer : CANsignalMuxType::Muxer;
+    };
     parser["mux_ndx"] = [&muxType, &muxNdx](const peg::SemanticValues& sv) {
         muxType = CANsignalMuxType::Muxed;
         muxNdx = std::stoi(sv.token());
@@ -372,6 +435,18 @@ bool DBCParser::parse(const std::string& data) noexcept
         const CANmessage msg{ static_cast<std::uint32_t>(id), name,
             static_cast<std::uint32_t>(dlc), ecuList };
         cdb_debug("Found a message with id = {}", msg.id);
+        // A message defined again keeps its fields and takes the new signals
+        const auto existing = can_db.messages.find(msg);
+        if (existing == can_db.messages.end()) {
+            print.add(msg);
+        } else {
+            for (const auto& signal : existing->second) {
+                print.remove(msg.id, signal);
+            }
+        }
+        for (const auto& signal : signals) {
+            print.add(msg.id, signal);
+        }
         can_db.messages[msg] = signals;
         signals.clear();
         numbers.clear();
@@ -408,8 +483,9 @@ bool DBCParser::parse(const std::string& data) noexcept
         boost::optional<std::uint16_t> sigMuxNdx =
             boost::make_optional(false, std::uint16_t());
 
-        if (muxType == CANsignalMuxType::Muxed) {
-            sigMuxType = CANsignalMuxType::Muxed;
+        if (muxType == CANsignalMuxType::Muxed
+            || muxType == CANsignalMuxType::MuxedMuxer) {
+            sigMuxType = muxType;
             sigMuxNdx = static_cast<std::uint16_t>(muxNdx);
             cdb_debug("Muxed signal: sigMuxType {}, sigMuxNdx {}",
                 static_cast<int>(sigMuxType), sigMuxNdx);
@@ -435,8 +511,8 @@ bool DBCParser::parse(const std::string& data) noexcept
         auto signal_name = take_back(idents);
 
         signals.push_back(
-            CANsignal{ signal_name, static_cast<std::uint8_t>(startBit),
-                static_cast<std::uint8_t>(signalSize),
+            CANsignal{ signal_name, static_cast<std::uint16_t>(startBit),
+                static_cast<std::uint16_t>(signalSize),
                 static_cast<CANsignalEndianness>(endianness), valueSigned,
                 factor, offset, min, max, unit, receivers, sigMuxType,
                 sigMuxNdx });
@@ -457,7 +533,7 @@ bool DBCParser::parse(const std::string& data) noexcept
         cdb_debug("Found bo_tx_bu {}", sv.token());
         auto id = static_cast<uint32_t>(take_back(numbers));
         if (ecu_tokens.size() > 0) {
-            appendMessageTransmittingEcus(can_db, id, ecu_tokens);
+            appendMessageTransmittingEcus(can_db, print, id, ecu_tokens);
         }
         ecu_tokens.clear();
         numbers.clear();
@@ -468,7 +544,7 @@ bool DBCParser::parse(const std::string& data) noexcept
         cdb_debug("Found cm_bo {}", sv.token());
         auto comment = take_back(phrases);
         auto id = static_cast<std::uint32_t>(take_back(numbers));
-        setMessageComment(can_db, id, comment);
+        setMessageComment(can_db, print, id, comment);
         cdb_debug("Message comment id={}, comment=\"{}\"", id, comment);
         phrases.clear();
         numbers.clear();
@@ -480,7 +556,7 @@ bool DBCParser::parse(const std::string& data) noexcept
         auto comment = take_back(phrases);
         auto name = take_back(idents);
         auto id = static_cast<std::uint32_t>(take_back(numbers));
-        setSignalComment(can_db, id, name, comment);
+        setSignalComment(can_db, print, id, name, comment);
         cdb_debug("Signal comment id={}, name={}, comment=\"{}\"", id, name,
             comment);
         phrases.clear();
@@ -543,7 +619,7 @@ bool DBCParser::parse(const std::string& data) noexcept
             auto id = static_cast<std::uint32_t>(take_back(numbers));
             auto attributeName = take_back(phrases);
             if (attributeName == "GenMsgCycleTime") {
-                setMessageCycleTime(can_db, id, cycleTime);
+                setMessageCycleTime(can_db, print, id, cycleTime);
                 cdb_debug("Found message cycle time id={}, time={}", id,
                     cycleTime);
             }
@@ -589,7 +665,7 @@ bool DBCParser::parse(const std::string& data) noexcept
         }
 
         if (idToSet && nameToSet && valueToSet) {
-            setSignalStartValue(can_db, idToSet.get(), nameToSet.get(),
+            setSignalStartValue(can_db, print, idToSet.get(), nameToSet.get(),
                 valueToSet.get());
         }
 
@@ -606,34 +682,76 @@ bool DBCParser::parse(const std::string& data) noexcept
         auto id = static_cast<uint32_t>(take_back(numbers));
         cdb_debug("Value type for signal {}:{}: \"{}\"", id, name,
             static_cast<uint16_t>(typeId));
-        setSignalValueType(can_db, id, name, typeId);
+        setSignalValueType(can_db, print, id, name, typeId);
 
         numbers.clear();
         idents.clear();
     };
 
-    parser["vals"] = [&numbers, &idents, &phrases, this]
+    parser["vals"] = [&numbers, &idents, &phrasesPairs, this]
                            (const peg::SemanticValues& sv) {
         cdb_debug("Found val_ {}", sv.token());
-        std::string valueDescription;
-        while (phrases.size() > 0 && numbers.size() > 1) {
-            if (!valueDescription.empty()) {
-                valueDescription.insert(0, " ");
+        CANvalueDescriptions_t valueDescription;
+        if (phrasesPairs.empty()) {
+            // Reference to a value table defined with VAL_TABLE_
+            auto tableName = take_back(idents);
+            auto table = std::find_if(can_db.val_tables.begin(),
+                can_db.val_tables.end(),
+                [&tableName](const CANdb_t::ValTable& t) {
+                    return t.identifier == tableName;
+                });
+            if (table != can_db.val_tables.end()) {
+                valueDescription = table->entries;
+            } else {
+                cdb_warn("Value table {} not found", tableName);
             }
-            valueDescription.insert(0, " " + take_back(phrases));
-            valueDescription.insert(0,
-                std::to_string(static_cast<uint32_t>(take_back(numbers))));
+        } else {
+            valueDescription = sortedValueDescriptions(phrasesPairs);
         }
         auto name = take_back(idents);
         auto id = static_cast<std::uint32_t>(take_back(numbers));
-        cdb_debug("Value description for signal {}:{}: \"{}\"", id, name,
-            valueDescription);
-        setSignalValueDescription(can_db, id, name, valueDescription);
+        cdb_debug("{} value descriptions for signal {}:{}",
+            valueDescription.size(), id, name);
+        setSignalValueDescription(can_db, print, id, name, valueDescription);
 
-        phrases.clear();
+        phrasesPairs.clear();
+        numbers.clear();
+        idents.clear();
+    };
+
+    parser["mux_range"] = [&mux_ranges](const peg::SemanticValues& sv) {
+        cdb_trace("Found mux range {}", sv.token());
+        mux_ranges.push_back(sv.token());
+    };
+
+    parser["sg_mul_val"] = [&numbers, &idents, &mux_ranges, this]
+                           (const peg::SemanticValues& sv) {
+        cdb_debug("Found sg_mul_val {}", sv.token());
+        CANmuxDependency dependency;
+        dependency.muxSwitch = take_back(idents);
+        auto name = take_back(idents);
+        auto id = static_cast<std::uint32_t>(take_back(numbers));
+        for (auto range : mux_ranges) {
+            boost::algorithm::erase_all(range, " ");
+            const auto dash = range.find('-');
+            dependency.ranges.push_back(CANmuxRange{
+                static_cast<std::uint32_t>(std::stoul(range.substr(0, dash))),
+                static_cast<std::uint32_t>(
+                    std::stoul(range.substr(dash + 1))) });
+        }
+        setSignalMuxDependency(can_db, print, id, name, dependency);
+
+        mux_ranges.clear();
         numbers.clear();
         idents.clear();
     };
 
-    return parser.parse(noTabsData.c_str());
+    const auto parsed = parser.parse(noTabsData.c_str());
+    if (parsed) {
+        print.setGlobals(can_db);
+    } else {
+        // A half parsed database must not get an identity
+        print = DbFingerprint{};
+    }
+    return parsed;
 }
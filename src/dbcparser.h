@@ -1,12 +1,20 @@
 #ifndef __CANDB_H
 #define __CANDB_H
 
+#include "fingerprint.h"
 #include "parser.hpp"
 
 namespace CANdb {
 
 struct DBCParser : public Parser<DBCParser> {
     bool parse(const std::string& data) noexcept;
+
+    // Fingerprint of the parsed database, computed while parsing. All zero
+    // if parse() failed.
+    const DbFingerprint& fingerprint() const noexcept { return print; }
+
+private:
+    DbFingerprint print;
 };
 } // namespace CANdb
 
@@ -0,0 +1,176 @@
+#include "dbdiff.h"
+
+#include <functional>
+#include <unordered_map>
+
+namespace {
+
+bool sameReal(std::double_t lhs, std::double_t rhs)
+{
+    return lhs == rhs || (lhs != lhs && rhs != rhs);
+}
+
+struct NameHash {
+    std::size_t operator()(const std::string* name) const
+    {
+        return std::hash<std::string>()(*name);
+    }
+};
+struct NameEqual {
+    bool operator()(const std::string* lhs, const std::string* rhs) const
+    {
+        return *lhs == *rhs;
+    }
+};
+using SignalIndex = std::unordered_map<const std::string*, const CANsignal*,
+    NameHash, NameEqual>;
+
+// Appends the names of the fields that differ within the aspects
+void signalFields(const CANsignal& before, const CANsignal& after,
+    std::uint8_t aspects, std::vector<const char*>& fields)
+{
+    const auto check = [&fields](bool differs, const char* name) {
+        if (differs) {
+            fields.push_back(name);
+        }
+    };
+    if ((aspects & CANdb::LAYOUT) != 0) {
+        check(before.startBit != after.startBit, "startBit");
+        check(before.signalSize != after.signalSize, "signalSize");
+        check(before.endianness != after.endianness, "endianness");
+        check(before.valueSigned != after.valueSigned, "valueSigned");
+        check(before.type() != after.type(), "valueType");
+    }
+    if ((aspects & CANdb::SCALING) != 0) {
+        check(!sameReal(before.factor, after.factor), "factor");
+        check(!sameReal(before.offset, after.offset), "offset");
+        check(!sameReal(before.min, after.min), "min");
+        check(!sameReal(before.max, after.max), "max");
+        check(before.unit != after.unit, "unit");
+        check(!(before.valueDescriptions() == after.valueDescriptions()),
+            "valueDescription");
+    }
+    if ((aspects & CANdb::MUX) != 0) {
+        check(before.muxType != after.muxType, "muxType");
+        check(before.muxNdx() != after.muxNdx(), "muxNdx");
+        check(!(before.muxDependency() == after.muxDependency()),
+            "muxDependency");
+    }
+    if ((aspects & CANdb::COMMENT) != 0) {
+        fields.push_back("comment");
+    }
+    if ((aspects & CANdb::ATTRIBUTES) != 0) {
+        check(before.has(CANsignal::START_VALUE)
+                    != after.has(CANsignal::START_VALUE)
+                || before.has(CANsignal::START_TEXT)
+                    != after.has(CANsignal::START_TEXT)
+                || !sameReal(before.startNumber(), after.startNumber())
+                || before.startText() != after.startText(),
+            "startValue");
+        check(before.receivers != after.receivers, "receivers");
+    }
+}
+
+void messageFields(const CANmessage& before, const CANmessage& after,
+    std::uint8_t aspects, std::vector<const char*>& fields)
+{
+    const auto check = [&fields](bool differs, const char* name) {
+        if (differs) {
+            fields.push_back(name);
+        }
+    };
+    if ((aspects & CANdb::LAYOUT) != 0) {
+        check(before.name != after.name, "name");
+        check(before.length() != after.length(), "dlc");
+    }
+    if ((aspects & CANdb::COMMENT) != 0) {
+        fields.push_back("comment");
+    }
+    if ((aspects & CANdb::ATTRIBUTES) != 0) {
+        check(before.cycleTime != after.cycleTime, "cycleTime");
+        check(before.ecus != after.ecus, "ecus");
+    }
+}
+
+void diffSignals(const CANmessage& message,
+    const std::vector<CANsignal>& before, const std::vector<CANsignal>& after,
+    SignalIndex& index, std::vector<CANdb::DbChange>& changes)
+{
+    index.clear();
+    for (const auto& signal : before) {
+        index.emplace(&signal.signal_name, &signal);
+    }
+
+    for (const auto& signal : after) {
+        const auto it = index.find(&signal.signal_name);
+        if (it == index.end()) {
+            changes.push_back(CANdb::DbChange{ CANdb::DbChange::Kind::Added,
+                message.id, message.name, signal.signal_name, 0, {} });
+            continue;
+        }
+        const auto& old = *it->second;
+        index.erase(it);
+        const auto aspects
+            = CANdb::aspectsOf(old).differences(CANdb::aspectsOf(signal));
+        if (aspects != 0) {
+            CANdb::DbChange change{ CANdb::DbChange::Kind::Changed, message.id,
+                message.name, signal.signal_name, aspects, {} };
+            signalFields(old, signal, aspects, change.fields);
+            changes.push_back(std::move(change));
+        }
+    }
+
+    // Removed signals in their former order
+    for (const auto& signal : before) {
+        if (index.count(&signal.signal_name) != 0) {
+            changes.push_back(CANdb::DbChange{ CANdb::DbChange::Kind::Removed,
+                message.id, message.name, signal.signal_name, 0, {} });
+        }
+    }
+}
+
+} // namespace
+
+namespace CANdb {
+
+std::vector<DbChange> diffDatabases(
+    const CANdb_t& before, const CANdb_t& after)
+{
+    std::vector<DbChange> changes;
+    SignalIndex index;
+
+    // Both maps are sorted by id
+    auto old = before.messages.begin();
+    auto now = after.messages.begin();
+    while (old != before.messages.end() || now != after.messages.end()) {
+        if (now == after.messages.end()
+            || (old != before.messages.end()
+                && old->first.id < now->first.id)) {
+            changes.push_back(DbChange{ DbChange::Kind::Removed, old->first.id,
+                old->first.name, "", 0, {} });
+            ++old;
+            continue;
+        }
+        if (old == before.messages.end() || now->first.id < old->first.id) {
+            changes.push_back(DbChange{ DbChange::Kind::Added, now->first.id,
+                now->first.name, "", 0, {} });
+            ++now;
+            continue;
+        }
+
+        const auto aspects
+            = aspectsOf(old->first).differences(aspectsOf(now->first));
+        if (aspects != 0) {
+            DbChange change{ DbChange::Kind::Changed, now->first.id,
+                now->first.name, "", aspects, {} };
+            messageFields(old->first, now->first, aspects, change.fields);
+            changes.push_back(std::move(change));
+        }
+        diffSignals(now->first, old->second, now->second, index, changes);
+        ++old;
+        ++now;
+    }
+    return changes;
+}
+
+} // namespace CANdb
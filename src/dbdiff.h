@@ -0,0 +1,33 @@
+#ifndef DBDIFF_H_K3PV9JDS
+#define DBDIFF_H_K3PV9JDS
+
+#include "fingerprint.h"
+
+namespace CANdb {
+
+struct DbChange {
+    enum class Kind { Added, Removed, Changed };
+
+    Kind kind;
+    std::uint32_t id;
+    std::string message;
+    // Empty for changes of the message itself
+    std::string signal;
+    // Aspects that differ, for changed items
+    std::uint8_t aspects;
+    // Names of the fields that differ, for changed items
+    std::vector<const char*> fields;
+};
+
+// Structural changes from one database to another. Messages are matched by
+// id and signals by name within their message, so the order of a DBC file
+// does not matter. Items are compared by the fingerprints of their aspects
+// (aspectsOf()), the fields of differing aspects are compared to name them.
+// Added and removed messages are reported without their signals. Changes
+// are ordered by id, a message before its signals.
+std::vector<DbChange> diffDatabases(
+    const CANdb_t& before, const CANdb_t& after);
+
+} // namespace CANdb
+
+#endif /* end of include guard: DBDIFF_H_K3PV9JDS */
@@ -0,0 +1,189 @@
+#include "dbquery.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace CANdb {
+
+bool globMatch(const std::string& pattern, const std::string& text)
+{
+    std::size_t p = 0;
+    std::size_t t = 0;
+    // Position after the last * and the text position it was retried from
+    std::size_t star = std::string::npos;
+    std::size_t retry = 0;
+    while (t < text.size()) {
+        if (p < pattern.size()
+            && (pattern[p] == '?' || pattern[p] == text[t])) {
+            ++p;
+            ++t;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = ++p;
+            retry = t;
+        } else if (star != std::string::npos) {
+            p = star;
+            t = ++retry;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+DbQuery::DbQuery(const CANdb_t& db)
+    : can_db(std::make_shared<const CANdb_t>(db))
+{
+    std::vector<NameIndex::Entry> messageEntries;
+    std::vector<NameIndex::Entry> signalEntries;
+    messageList.reserve(can_db->messages.size());
+    messageEntries.reserve(can_db->messages.size());
+
+    for (const auto& message : can_db->messages) {
+        const auto index = static_cast<std::uint32_t>(messageList.size());
+        messageList.push_back(&message.first);
+        messageEntries.push_back(
+            NameIndex::Entry{ &message.first.name, index });
+        ids.emplace(message.first.id, index);
+        for (const auto& ecu : message.first.ecus) {
+            senders[ecu].push_back(index);
+        }
+
+        for (const auto& signal : message.second) {
+            signalEntries.push_back(NameIndex::Entry{ &signal.signal_name,
+                static_cast<std::uint32_t>(signalList.size()) });
+            signalList.push_back(SignalRef{ &message.first, &signal });
+        }
+    }
+
+    messageNames.build(std::move(messageEntries));
+    signalNames.build(std::move(signalEntries));
+}
+
+const CANmessage* DbQuery::message(std::uint32_t id) const
+{
+    const auto it = ids.find(id);
+    return it != ids.end() ? messageList[it->second] : nullptr;
+}
+
+std::vector<const CANmessage*> DbQuery::messages(
+    const std::string& pattern) const
+{
+    std::vector<const CANmessage*> found;
+    for (const auto index : messageNames.find(pattern)) {
+        found.push_back(messageList[index]);
+    }
+    return found;
+}
+
+std::vector<DbQuery::SignalRef> DbQuery::signals(
+    const std::string& pattern) const
+{
+    std::vector<SignalRef> found;
+    for (const auto index : signalNames.find(pattern)) {
+        found.push_back(signalList[index]);
+    }
+    return found;
+}
+
+std::vector<const CANmessage*> DbQuery::transmittedBy(
+    const std::string& ecu) const
+{
+    std::vector<const CANmessage*> found;
+    const auto it = senders.find(ecu);
+    if (it != senders.end()) {
+        for (const auto index : it->second) {
+            found.push_back(messageList[index]);
+        }
+    }
+    return found;
+}
+
+void DbQuery::NameIndex::build(std::vector<Entry> entries)
+{
+    // Stable to keep duplicated names in database order
+    std::stable_sort(entries.begin(), entries.end(),
+        [](const Entry& lhs, const Entry& rhs) {
+            return *lhs.name < *rhs.name;
+        });
+    sorted = std::move(entries);
+
+    exact.reserve(sorted.size());
+    for (std::uint32_t first = 0; first < sorted.size();) {
+        auto last = first + 1;
+        while (last < sorted.size()
+            && *sorted[last].name == *sorted[first].name) {
+            ++last;
+        }
+        exact.emplace(*sorted[first].name, Range{ first, last });
+        first = last;
+    }
+
+    reversed.reserve(sorted.size());
+    for (std::uint32_t position = 0; position < sorted.size(); ++position) {
+        const auto& name = *sorted[position].name;
+        reversed.push_back(
+            Reversed{ std::string(name.rbegin(), name.rend()), position });
+    }
+    std::sort(reversed.begin(), reversed.end(),
+        [](const Reversed& lhs, const Reversed& rhs) {
+            return lhs.name < rhs.name;
+        });
+}
+
+std::vector<std::uint32_t> DbQuery::NameIndex::find(
+    const std::string& pattern) const
+{
+    std::vector<std::uint32_t> items;
+    const auto wildcard = pattern.find_first_of("*?");
+    if (wildcard == std::string::npos) {
+        const auto it = exact.find(pattern);
+        if (it != exact.end()) {
+            for (auto i = it->second.first; i < it->second.last; ++i) {
+                items.push_back(sorted[i].item);
+            }
+        }
+        return items;
+    }
+
+    const auto suffixStart = pattern.find_last_of("*?") + 1;
+    if (wildcard == 0 && suffixStart < pattern.size()) {
+        const std::string suffix(pattern.rbegin(),
+            pattern.rend() - static_cast<std::ptrdiff_t>(suffixStart));
+        auto it = std::lower_bound(reversed.begin(), reversed.end(), suffix,
+            [](const Reversed& entry, const std::string& name) {
+                return entry.name < name;
+            });
+        std::vector<std::uint32_t> positions;
+        for (; it != reversed.end()
+             && it->name.compare(0, suffix.size(), suffix) == 0;
+             ++it) {
+            if (globMatch(pattern, *sorted[it->position].name)) {
+                positions.push_back(it->position);
+            }
+        }
+        std::sort(positions.begin(), positions.end());
+        for (const auto position : positions) {
+            items.push_back(sorted[position].item);
+        }
+        return items;
+    }
+
+    const auto prefix = pattern.substr(0, wildcard);
+    auto it = std::lower_bound(sorted.begin(), sorted.end(), prefix,
+        [](const Entry& entry, const std::string& name) {
+            return *entry.name < name;
+        });
+    for (; it != sorted.end()
+         && it->name->compare(0, prefix.size(), prefix) == 0;
+         ++it) {
+        if (globMatch(pattern, *it->name)) {
+            items.push_back(it->item);
+        }
+    }
+    return items;
+}
+
+} // namespace CANdb
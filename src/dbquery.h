@@ -0,0 +1,84 @@
+#ifndef DBQUERY_H_W4HC8NXE
+#define DBQUERY_H_W4HC8NXE
+
+#include "cantypes.hpp"
+
+#include <memory>
+#include <unordered_map>
+
+namespace CANdb {
+
+// True if the text matches a pattern in which * matches any run of
+// characters and ? any single character
+bool globMatch(const std::string& pattern, const std::string& text);
+
+// Immutable lookup indexes over a database. Ids and ECUs are looked up in
+// hash indexes. Names are looked up in a hash index when exact and in name
+// sorted indexes when they contain wildcards: only the names starting with
+// the part before the first wildcard, or ending with the part after the last
+// one for patterns starting with a wildcard, are matched against the
+// pattern.
+struct DbQuery {
+    struct SignalRef {
+        const CANmessage* message;
+        const CANsignal* signal;
+    };
+
+    explicit DbQuery(const CANdb_t& db);
+
+    // nullptr if the database has no such message, ids as used by DBC files
+    const CANmessage* message(std::uint32_t id) const;
+    const std::vector<CANsignal>& signalsOf(const CANmessage& message) const
+    {
+        return can_db->messages.at(message);
+    }
+
+    // Matches in name order, names may contain wildcards
+    std::vector<const CANmessage*> messages(const std::string& pattern) const;
+    std::vector<SignalRef> signals(const std::string& pattern) const;
+    // Messages sent by an ECU, in database order
+    std::vector<const CANmessage*> transmittedBy(const std::string& ecu) const;
+
+    std::size_t messageCount() const noexcept { return messageList.size(); }
+    std::size_t signalCount() const noexcept { return signalList.size(); }
+    const CANdb_t& db() const noexcept { return *can_db; }
+
+private:
+    struct NameIndex {
+        struct Entry {
+            const std::string* name;
+            std::uint32_t item;
+        };
+        struct Range {
+            std::uint32_t first;
+            std::uint32_t last;
+        };
+        struct Reversed {
+            std::string name;
+            // In sorted
+            std::uint32_t position;
+        };
+
+        void build(std::vector<Entry> entries);
+        // Items named by the pattern, in name order
+        std::vector<std::uint32_t> find(const std::string& pattern) const;
+
+        std::vector<Entry> sorted;
+        // Sorted by reversed name
+        std::vector<Reversed> reversed;
+        std::unordered_map<std::string, Range> exact;
+    };
+
+    std::shared_ptr<const CANdb_t> can_db;
+
+    std::vector<const CANmessage*> messageList;
+    std::vector<SignalRef> signalList;
+    std::unordered_map<std::uint32_t, std::uint32_t> ids;
+    std::unordered_map<std::string, std::vector<std::uint32_t>> senders;
+    NameIndex messageNames;
+    NameIndex signalNames;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: DBQUERY_H_W4HC8NXE */
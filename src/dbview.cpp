@@ -0,0 +1,62 @@
+#include "dbview.h"
+
+namespace CANdb {
+
+const std::uint8_t DbView::MOTOROLA;
+const std::uint8_t DbView::SIGNED_VALUE;
+const std::uint8_t DbView::MULTIPLEXED;
+
+DbView::DbView(const CANdb_t& db)
+    : can_db(std::make_shared<const CANdb_t>(db))
+{
+    std::size_t signalTotal = 0;
+    for (const auto& message : can_db->messages) {
+        signalTotal += message.second.size();
+    }
+    ids.reserve(can_db->messages.size());
+    payloadLengths.reserve(can_db->messages.size());
+    firsts.reserve(can_db->messages.size() + 1);
+    messages.reserve(can_db->messages.size());
+    starts.reserve(signalTotal);
+    bits.reserve(signalTotal);
+    flagBits.reserve(signalTotal);
+    scales.reserve(signalTotal);
+    shifts.reserve(signalTotal);
+    mins.reserve(signalTotal);
+    maxs.reserve(signalTotal);
+    owners.reserve(signalTotal);
+    signals.reserve(signalTotal);
+
+    for (const auto& message : can_db->messages) {
+        const auto index = static_cast<std::uint32_t>(ids.size());
+        ids.push_back(message.first.id);
+        payloadLengths.push_back(message.first.length());
+        firsts.push_back(static_cast<std::uint32_t>(starts.size()));
+        messages.push_back(&message.first);
+
+        for (const auto& signal : message.second) {
+            starts.push_back(signal.startBit);
+            bits.push_back(signal.signalSize);
+            std::uint8_t flags = 0;
+            if (signal.endianness == CANsignalEndianness::BigEndianMotorola) {
+                flags |= MOTOROLA;
+            }
+            if (signal.valueSigned) {
+                flags |= SIGNED_VALUE;
+            }
+            if (signal.muxType != CANsignalMuxType::NotMuxed) {
+                flags |= MULTIPLEXED;
+            }
+            flagBits.push_back(flags);
+            scales.push_back(signal.factor);
+            shifts.push_back(signal.offset);
+            mins.push_back(signal.min);
+            maxs.push_back(signal.max);
+            owners.push_back(index);
+            signals.push_back(&signal);
+        }
+    }
+    firsts.push_back(static_cast<std::uint32_t>(starts.size()));
+}
+
+} // namespace CANdb
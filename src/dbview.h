@@ -0,0 +1,98 @@
+#ifndef DBVIEW_H_J7TN3QWB
+#define DBVIEW_H_J7TN3QWB
+
+#include "cantypes.hpp"
+
+#include <memory>
+
+namespace CANdb {
+
+// Immutable structure of arrays view of a database for scans over all
+// signals. The layout and scaling of the signals are split into parallel
+// arrays indexed by signal, in database order: the signals of the first
+// message, then those of the second one and so on. Names, units, comments,
+// value descriptions and the other cold metadata stay in the database copy
+// reached through signal() and message().
+struct DbView {
+    static const std::uint8_t MOTOROLA{ 1 };
+    static const std::uint8_t SIGNED_VALUE{ 2 };
+    static const std::uint8_t MULTIPLEXED{ 4 };
+
+    explicit DbView(const CANdb_t& db);
+
+    std::size_t messageCount() const noexcept { return ids.size(); }
+    std::size_t signalCount() const noexcept { return starts.size(); }
+
+    // Per message, ids as used by DBC files
+    const std::vector<std::uint32_t>& messageIds() const noexcept
+    {
+        return ids;
+    }
+    const std::vector<std::uint32_t>& lengths() const noexcept
+    {
+        return payloadLengths;
+    }
+    // Signals of message m are [firstSignals()[m], firstSignals()[m + 1])
+    const std::vector<std::uint32_t>& firstSignals() const noexcept
+    {
+        return firsts;
+    }
+
+    // Per signal
+    const std::vector<std::uint16_t>& startBits() const noexcept
+    {
+        return starts;
+    }
+    const std::vector<std::uint16_t>& sizes() const noexcept { return bits; }
+    // MOTOROLA, SIGNED_VALUE and MULTIPLEXED
+    const std::vector<std::uint8_t>& flags() const noexcept { return flagBits; }
+    const std::vector<std::double_t>& factors() const noexcept
+    {
+        return scales;
+    }
+    const std::vector<std::double_t>& offsets() const noexcept
+    {
+        return shifts;
+    }
+    const std::vector<std::double_t>& minimums() const noexcept
+    {
+        return mins;
+    }
+    const std::vector<std::double_t>& maximums() const noexcept
+    {
+        return maxs;
+    }
+    // Index of the message of each signal
+    const std::vector<std::uint32_t>& messageIndexes() const noexcept
+    {
+        return owners;
+    }
+
+    // Cold metadata
+    const CANmessage& message(std::size_t m) const { return *messages[m]; }
+    const CANsignal& signal(std::size_t s) const { return *signals[s]; }
+    const CANdb_t& db() const noexcept { return *can_db; }
+
+private:
+    std::shared_ptr<const CANdb_t> can_db;
+
+    std::vector<std::uint32_t> ids;
+    std::vector<std::uint32_t> payloadLengths;
+    std::vector<std::uint32_t> firsts;
+
+    std::vector<std::uint16_t> starts;
+    std::vector<std::uint16_t> bits;
+    std::vector<std::uint8_t> flagBits;
+    std::vector<std::double_t> scales;
+    std::vector<std::double_t> shifts;
+    std::vector<std::double_t> mins;
+    std::vector<std::double_t> maxs;
+    std::vector<std::uint32_t> owners;
+
+    std::vector<const CANmessage*> messages;
+    std::vector<const CANsignal*> signals;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: DBVIEW_H_J7TN3QWB */
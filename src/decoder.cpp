@@ -0,0 +1,745 @@
+#include "decoder.h"
+#include "log.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+
+namespace {
+
+using Range = std::pair<std::uint64_t, std::uint64_t>;
+using Ranges = std::vector<Range>;
+
+// Multiplexor switches with values below this limit get a direct lookup table
+const std::uint64_t DENSE_MUX_LIMIT{ 256 };
+// Value descriptions get a direct lookup table when they span no more values
+// than this factor times their count (or DENSE_LABELS_MIN_SPAN)
+const std::uint64_t DENSE_LABELS_FACTOR{ 4 };
+const std::uint64_t DENSE_LABELS_MIN_SPAN{ 64 };
+const std::uint32_t NO_PLAN{ 0xFFFFFFFF };
+
+// Signals are read through 8 byte windows of the payload, shorter payloads
+// are zero padded to a full window
+const std::size_t WINDOW{ 8 };
+// Largest payload, of a CAN FD frame
+const unsigned MAX_PAYLOAD{ 64 };
+
+inline std::uint64_t loadLittleEndian(const std::uint8_t* data)
+{
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < WINDOW; ++i) {
+        value |= static_cast<std::uint64_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+inline std::uint64_t loadBigEndian(const std::uint8_t* data)
+{
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < WINDOW; ++i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+inline void storeLittleEndian(std::uint64_t value, std::uint8_t* data)
+{
+    for (std::size_t i = 0; i < WINDOW; ++i) {
+        data[i] = static_cast<std::uint8_t>(value >> (8 * i));
+    }
+}
+
+inline void storeBigEndian(std::uint64_t value, std::uint8_t* data)
+{
+    for (std::size_t i = 0; i < WINDOW; ++i) {
+        data[i] = static_cast<std::uint8_t>(value >> (56 - 8 * i));
+    }
+}
+
+bool compileSignal(
+    const CANsignal& signal, std::uint32_t index, CANdb::SignalPlan& plan)
+{
+    const unsigned size = signal.signalSize;
+    if (size == 0 || size > 64) {
+        return false;
+    }
+
+    plan.index = index;
+    plan.labels = CANdb::MessagePlan::NO_LABELS;
+    plan.mask = size == 64 ? ~std::uint64_t{ 0 }
+                           : (std::uint64_t{ 1 } << size) - 1;
+    plan.bigEndian
+        = signal.endianness == CANsignalEndianness::BigEndianMotorola;
+    plan.valueSigned = signal.valueSigned;
+    plan.type = signal.type();
+    plan.factor = signal.factor;
+    plan.offset = signal.offset;
+
+    if ((plan.type == CANsignalType::Float && size != 32)
+        || (plan.type == CANsignalType::Double && size != 64)) {
+        return false;
+    }
+    if (plan.type != CANsignalType::Float
+        && plan.type != CANsignalType::Double) {
+        plan.type = CANsignalType::SignedUnsignedInt;
+    }
+
+    // Every signal gets the window ending with its last byte. Signals of more
+    // than 57 bits may start in the byte before the window, these bits are
+    // spilled in from that byte.
+    if (plan.bigEndian) {
+        // The start bit is the MSB in the sawtooth numbering of the DBC, map
+        // it to a linear position counted from the MSB of the first byte
+        const unsigned msb
+            = (signal.startBit / 8) * 8 + (7 - signal.startBit % 8);
+        const unsigned lsb = msb + size - 1;
+        if (lsb >= MAX_PAYLOAD * 8) {
+            return false;
+        }
+        const unsigned last = lsb / 8;
+        const unsigned first = last < 7 ? 0 : last - 7;
+        plan.byte = static_cast<std::uint8_t>(first);
+        plan.shift = static_cast<std::uint8_t>(8 * first + 63 - lsb);
+        plan.spill
+            = static_cast<std::uint8_t>(msb < 8 * first ? 8 * first - msb : 0);
+        plan.bytes = static_cast<std::uint8_t>(last + 1);
+    } else {
+        const unsigned lsb = signal.startBit;
+        const unsigned msb = lsb + size - 1;
+        if (msb >= MAX_PAYLOAD * 8) {
+            return false;
+        }
+        const unsigned last = msb / 8;
+        const unsigned first = last < 7 ? 0 : last - 7;
+        const bool spills = lsb < 8 * first;
+        plan.byte = static_cast<std::uint8_t>(first);
+        plan.shift = static_cast<std::uint8_t>(spills ? 0 : lsb - 8 * first);
+        plan.spill = static_cast<std::uint8_t>(spills ? 8 * first - lsb : 0);
+        plan.bytes = static_cast<std::uint8_t>(last + 1);
+    }
+
+    return true;
+}
+
+template <bool BigEndian>
+inline std::uint64_t extractOf(
+    const CANdb::SignalPlan& plan, const std::uint8_t* data)
+{
+    const auto* window = data + plan.byte;
+    if (BigEndian) {
+        auto raw = loadBigEndian(window) >> plan.shift;
+        if (plan.spill != 0) {
+            raw |= static_cast<std::uint64_t>(window[-1]) << (64 - plan.shift);
+        }
+        return raw & plan.mask;
+    }
+    if (plan.spill != 0) {
+        return ((loadLittleEndian(window) << plan.spill)
+                   | (window[-1] >> (8 - plan.spill)))
+            & plan.mask;
+    }
+    return (loadLittleEndian(window) >> plan.shift) & plan.mask;
+}
+
+template <bool BigEndian>
+inline void storeOf(
+    const CANdb::SignalPlan& plan, std::uint64_t raw, std::uint8_t* data)
+{
+    auto* window = data + plan.byte;
+    const unsigned spillMask = (1u << plan.spill) - 1;
+    raw &= plan.mask;
+    if (BigEndian) {
+        const auto word = loadBigEndian(window);
+        storeBigEndian(
+            (word & ~(plan.mask << plan.shift)) | (raw << plan.shift), window);
+        if (plan.spill != 0) {
+            window[-1] = static_cast<std::uint8_t>((window[-1] & ~spillMask)
+                | ((raw >> (64 - plan.shift)) & spillMask));
+        }
+        return;
+    }
+    const auto word = loadLittleEndian(window);
+    if (plan.spill != 0) {
+        storeLittleEndian(
+            (word & ~(plan.mask >> plan.spill)) | (raw >> plan.spill), window);
+        window[-1] = static_cast<std::uint8_t>(
+            (window[-1] & (0xFF >> plan.spill))
+            | ((raw & spillMask) << (8 - plan.spill)));
+        return;
+    }
+    storeLittleEndian(
+        (word & ~(plan.mask << plan.shift)) | (raw << plan.shift), window);
+}
+
+inline std::uint64_t extract(
+    const CANdb::SignalPlan& plan, const std::uint8_t* data)
+{
+    return plan.bigEndian ? extractOf<true>(plan, data)
+                          : extractOf<false>(plan, data);
+}
+
+inline std::uint64_t signBitOf(const CANdb::SignalPlan& plan)
+{
+    return plan.valueSigned ? plan.mask ^ (plan.mask >> 1) : 0;
+}
+
+inline std::int64_t signExtend(std::uint64_t raw, std::uint64_t signBit)
+{
+    return static_cast<std::int64_t>((raw ^ signBit) - signBit);
+}
+
+template <CANsignalType Type> struct Convert;
+
+template <> struct Convert<CANsignalType::SignedUnsignedInt> {
+    static std::double_t toPhysical(
+        std::uint64_t raw, std::uint64_t signBit, const CANdb::SignalPlan& plan)
+    {
+        return signBit != 0
+            ? static_cast<std::double_t>(signExtend(raw, signBit)) * plan.factor
+                + plan.offset
+            : static_cast<std::double_t>(raw) * plan.factor + plan.offset;
+    }
+
+    static std::uint64_t toRaw(std::double_t value, std::uint64_t signBit,
+        const CANdb::SignalPlan& plan)
+    {
+        const auto scaled = plan.factor != 0
+            ? std::round((value - plan.offset) / plan.factor)
+            : 0.0;
+        const auto maxRaw = signBit != 0 ? signBit - 1 : plan.mask;
+        const auto minRaw = signBit;
+        const auto maxValue = static_cast<std::double_t>(maxRaw);
+        const auto minValue
+            = signBit != 0 ? -static_cast<std::double_t>(signBit) : 0.0;
+        if (!(scaled > minValue)) {
+            return minRaw;
+        }
+        if (scaled >= maxValue) {
+            return maxRaw;
+        }
+        return (signBit != 0
+                       ? static_cast<std::uint64_t>(
+                             static_cast<std::int64_t>(scaled))
+                       : static_cast<std::uint64_t>(scaled))
+            & plan.mask;
+    }
+};
+
+template <> struct Convert<CANsignalType::Float> {
+    static std::double_t toPhysical(
+        std::uint64_t raw, std::uint64_t, const CANdb::SignalPlan& plan)
+    {
+        const auto bits = static_cast<std::uint32_t>(raw);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return static_cast<std::double_t>(value) * plan.factor + plan.offset;
+    }
+
+    static std::uint64_t toRaw(
+        std::double_t value, std::uint64_t, const CANdb::SignalPlan& plan)
+    {
+        const auto scaled = static_cast<float>(
+            plan.factor != 0 ? (value - plan.offset) / plan.factor : 0.0);
+        std::uint32_t bits;
+        std::memcpy(&bits, &scaled, sizeof(bits));
+        return bits;
+    }
+};
+
+template <> struct Convert<CANsignalType::Double> {
+    static std::double_t toPhysical(
+        std::uint64_t raw, std::uint64_t, const CANdb::SignalPlan& plan)
+    {
+        std::double_t value;
+        std::memcpy(&value, &raw, sizeof(value));
+        return value * plan.factor + plan.offset;
+    }
+
+    static std::uint64_t toRaw(
+        std::double_t value, std::uint64_t, const CANdb::SignalPlan& plan)
+    {
+        const std::double_t scaled
+            = plan.factor != 0 ? (value - plan.offset) / plan.factor : 0.0;
+        std::uint64_t bits;
+        std::memcpy(&bits, &scaled, sizeof(bits));
+        return bits;
+    }
+};
+
+template <bool BigEndian, CANsignalType Type>
+void decodeColumnOf(const CANdb::SignalPlan& plan,
+    const std::uint8_t* payloads, std::size_t stride, std::size_t count,
+    std::double_t* values)
+{
+    const auto signBit = signBitOf(plan);
+    for (std::size_t i = 0; i < count; ++i) {
+        values[i] = Convert<Type>::toPhysical(
+            extractOf<BigEndian>(plan, payloads + i * stride), signBit, plan);
+    }
+}
+
+template <bool BigEndian, CANsignalType Type>
+void encodeColumnOf(const CANdb::SignalPlan& plan,
+    const std::double_t* values, std::size_t count, std::uint8_t* payloads,
+    std::size_t stride)
+{
+    const auto signBit = signBitOf(plan);
+    for (std::size_t i = 0; i < count; ++i) {
+        storeOf<BigEndian>(plan, Convert<Type>::toRaw(values[i], signBit, plan),
+            payloads + i * stride);
+    }
+}
+
+template <CANsignalType Type>
+void decodeColumnOf(const CANdb::SignalPlan& plan,
+    const std::uint8_t* payloads, std::size_t stride, std::size_t count,
+    std::double_t* values)
+{
+    if (plan.bigEndian) {
+        decodeColumnOf<true, Type>(plan, payloads, stride, count, values);
+    } else {
+        decodeColumnOf<false, Type>(plan, payloads, stride, count, values);
+    }
+}
+
+template <CANsignalType Type>
+void encodeColumnOf(const CANdb::SignalPlan& plan,
+    const std::double_t* values, std::size_t count, std::uint8_t* payloads,
+    std::size_t stride)
+{
+    if (plan.bigEndian) {
+        encodeColumnOf<true, Type>(plan, values, count, payloads, stride);
+    } else {
+        encodeColumnOf<false, Type>(plan, values, count, payloads, stride);
+    }
+}
+
+// Splits possibly overlapping multiplexor ranges into disjoint branches, so
+// that a single lookup yields every node enabled by a multiplexor value
+void compileSwitch(CANdb::MuxSwitch& muxSwitch,
+    const std::vector<std::pair<Range, std::uint32_t>>& targets)
+{
+    std::set<std::uint64_t> bounds;
+    for (const auto& target : targets) {
+        bounds.insert(target.first.first);
+        bounds.insert(target.first.second + 1);
+    }
+
+    for (auto it = bounds.begin(); it != bounds.end()
+         && std::next(it) != bounds.end();
+         ++it) {
+        CANdb::MuxBranch branch{ *it, *std::next(it) - 1, {} };
+        for (const auto& target : targets) {
+            if (target.first.first <= branch.from
+                && branch.to <= target.first.second
+                && std::find(branch.nodes.begin(), branch.nodes.end(),
+                       target.second)
+                    == branch.nodes.end()) {
+                branch.nodes.push_back(target.second);
+            }
+        }
+        if (branch.nodes.empty()) {
+            continue;
+        }
+        if (!muxSwitch.branches.empty()
+            && muxSwitch.branches.back().to + 1 == branch.from
+            && muxSwitch.branches.back().nodes == branch.nodes) {
+            muxSwitch.branches.back().to = branch.to;
+        } else {
+            muxSwitch.branches.push_back(branch);
+        }
+    }
+
+    if (!muxSwitch.branches.empty()
+        && muxSwitch.branches.back().to < DENSE_MUX_LIMIT) {
+        muxSwitch.dense.assign(muxSwitch.branches.back().to + 1, 0);
+        for (std::uint32_t i = 0; i < muxSwitch.branches.size(); ++i) {
+            const auto& branch = muxSwitch.branches[i];
+            for (auto v = branch.from; v <= branch.to; ++v) {
+                muxSwitch.dense[v] = i + 1;
+            }
+        }
+    }
+}
+
+CANdb::MessagePlan compileMessage(
+    const CANmessage& message, const std::vector<CANsignal>& signals)
+{
+    CANdb::MessagePlan plan{
+        &message, &signals, {}, { CANdb::MuxNode{} }, {} };
+
+    std::map<std::string, std::uint32_t> byName;
+    for (std::uint32_t i = 0; i < signals.size(); ++i) {
+        CANdb::SignalPlan signalPlan;
+        if (!compileSignal(signals[i], i, signalPlan)) {
+            cdb_warn("Unsupported layout of signal {}:{}, skipping",
+                message.id, signals[i].signal_name);
+            continue;
+        }
+        if (!signals[i].valueDescriptions().empty()) {
+            signalPlan.labels = static_cast<std::uint32_t>(plan.labels.size());
+            plan.labels.push_back(CANdb::ValueLabels{ signals[i] });
+        }
+        byName[signals[i].signal_name]
+            = static_cast<std::uint32_t>(plan.plans.size());
+        plan.plans.push_back(signalPlan);
+    }
+
+    // Without SG_MUL_VAL_ muxed signals depend on the top level multiplexor
+    std::uint32_t defaultMuxer = NO_PLAN;
+    for (const auto muxType :
+        { CANsignalMuxType::Muxer, CANsignalMuxType::MuxedMuxer }) {
+        for (std::uint32_t p = 0;
+             p < plan.plans.size() && defaultMuxer == NO_PLAN; ++p) {
+            if (signals[plan.plans[p].index].muxType == muxType) {
+                defaultMuxer = p;
+            }
+        }
+    }
+
+    // Group signals by the multiplexor and values they depend on. Every group
+    // becomes a node of the decision tree.
+    std::map<std::pair<std::uint32_t, Ranges>, std::uint32_t> groups;
+    std::vector<std::uint32_t> nodeOf(plan.plans.size(), NO_PLAN);
+    for (std::uint32_t p = 0; p < plan.plans.size(); ++p) {
+        const auto& signal = signals[plan.plans[p].index];
+
+        std::uint32_t muxer = NO_PLAN;
+        Ranges ranges;
+        if (const auto* dependency = signal.dependency()) {
+            const auto it = byName.find(dependency->muxSwitch);
+            muxer = it != byName.end() ? it->second : NO_PLAN;
+            for (const auto& range : dependency->ranges) {
+                ranges.push_back(Range{ range.from, range.to });
+            }
+        } else if (signal.has(CANsignal::MUX_NDX)
+            && (signal.muxType == CANsignalMuxType::Muxed
+                   || signal.muxType == CANsignalMuxType::MuxedMuxer)) {
+            muxer = defaultMuxer;
+            ranges.push_back(Range{ signal.muxIndex(), signal.muxIndex() });
+        } else {
+            nodeOf[p] = 0;
+            plan.nodes[0].signals.push_back(p);
+            continue;
+        }
+
+        if (muxer == NO_PLAN || muxer == p || ranges.empty()) {
+            cdb_warn("Unable to resolve the multiplexor of signal {}:{}",
+                message.id, signal.signal_name);
+            continue;
+        }
+
+        std::sort(ranges.begin(), ranges.end());
+        const auto key = std::make_pair(muxer, ranges);
+        auto group = groups.find(key);
+        if (group == groups.end()) {
+            group = groups
+                        .insert(std::make_pair(key,
+                            static_cast<std::uint32_t>(plan.nodes.size())))
+                        .first;
+            plan.nodes.push_back(CANdb::MuxNode{});
+        }
+        nodeOf[p] = group->second;
+        plan.nodes[group->second].signals.push_back(p);
+    }
+
+    // Attach every group to the node that holds its multiplexor
+    std::map<std::uint32_t, std::vector<std::pair<Range, std::uint32_t>>>
+        targets;
+    for (const auto& group : groups) {
+        for (const auto& range : group.first.second) {
+            targets[group.first.first].push_back(
+                std::make_pair(range, group.second));
+        }
+    }
+    for (const auto& target : targets) {
+        if (nodeOf[target.first] == NO_PLAN) {
+            continue;
+        }
+        CANdb::MuxSwitch muxSwitch;
+        muxSwitch.muxer = target.first;
+        compileSwitch(muxSwitch, target.second);
+        plan.nodes[nodeOf[target.first]].switches.push_back(muxSwitch);
+    }
+
+    return plan;
+}
+
+} // namespace
+
+namespace CANdb {
+
+ValueLabels::ValueLabels(const CANsignal& signal)
+{
+    if (signal.valueSigned && signal.signalSize > 0
+        && signal.signalSize <= 64) {
+        signBit = std::uint64_t{ 1 } << (signal.signalSize - 1);
+    }
+
+    const auto& descriptions = signal.valueDescriptions();
+    if (descriptions.empty()) {
+        return;
+    }
+    for (const auto& description : descriptions) {
+        values.push_back(description.value);
+        labels.push_back(description.label);
+    }
+
+    const auto span = static_cast<std::uint64_t>(values.back())
+        - static_cast<std::uint64_t>(values.front());
+    if (span < std::max(DENSE_LABELS_MIN_SPAN,
+                   DENSE_LABELS_FACTOR
+                       * static_cast<std::uint64_t>(values.size()))) {
+        base = values.front();
+        dense.assign(span + 1, 0);
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            dense[static_cast<std::uint64_t>(values[i])
+                - static_cast<std::uint64_t>(base)]
+                = static_cast<std::uint32_t>(i + 1);
+        }
+        values.clear();
+    }
+}
+
+const std::string* ValueLabels::find(std::uint64_t raw) const
+{
+    const auto value = static_cast<std::int64_t>(
+        (raw & signBit) != 0 ? raw | ~(signBit | (signBit - 1)) : raw);
+
+    if (!dense.empty()) {
+        const auto index = static_cast<std::uint64_t>(value)
+            - static_cast<std::uint64_t>(base);
+        return index < dense.size() && dense[index] != 0
+            ? &labels[dense[index] - 1]
+            : nullptr;
+    }
+
+    const auto it = std::lower_bound(values.begin(), values.end(), value);
+    return it != values.end() && *it == value
+        ? &labels[static_cast<std::size_t>(it - values.begin())]
+        : nullptr;
+}
+
+const MuxBranch* MuxSwitch::find(std::uint64_t value) const
+{
+    if (!dense.empty()) {
+        return value < dense.size() && dense[value] != 0
+            ? &branches[dense[value] - 1]
+            : nullptr;
+    }
+
+    auto it = std::upper_bound(branches.begin(), branches.end(), value,
+        [](std::uint64_t v, const MuxBranch& branch) {
+            return v < branch.from;
+        });
+    if (it == branches.begin()) {
+        return nullptr;
+    }
+    --it;
+    return value <= it->to ? &*it : nullptr;
+}
+
+std::uint64_t extractRaw(const SignalPlan& plan, const std::uint8_t* data)
+{
+    return extract(plan, data);
+}
+
+std::double_t toPhysical(const SignalPlan& plan, std::uint64_t raw)
+{
+    switch (plan.type) {
+    case CANsignalType::Float:
+        return Convert<CANsignalType::Float>::toPhysical(raw, 0, plan);
+    case CANsignalType::Double:
+        return Convert<CANsignalType::Double>::toPhysical(raw, 0, plan);
+    default:
+        return Convert<CANsignalType::SignedUnsignedInt>::toPhysical(
+            raw, signBitOf(plan), plan);
+    }
+}
+
+std::uint64_t toRaw(const SignalPlan& plan, std::double_t value)
+{
+    switch (plan.type) {
+    case CANsignalType::Float:
+        return Convert<CANsignalType::Float>::toRaw(value, 0, plan);
+    case CANsignalType::Double:
+        return Convert<CANsignalType::Double>::toRaw(value, 0, plan);
+    default:
+        return Convert<CANsignalType::SignedUnsignedInt>::toRaw(
+            value, signBitOf(plan), plan);
+    }
+}
+
+bool encodeSignal(const SignalPlan& plan, std::double_t value,
+    std::uint8_t* data, std::size_t size)
+{
+    if (plan.bytes > size) {
+        return false;
+    }
+
+    std::uint8_t padded[WINDOW]{};
+    auto* frame = data;
+    if (size < WINDOW) {
+        std::memcpy(padded, data, size);
+        frame = padded;
+    }
+
+    const auto raw = toRaw(plan, value);
+    if (plan.bigEndian) {
+        storeOf<true>(plan, raw, frame);
+    } else {
+        storeOf<false>(plan, raw, frame);
+    }
+
+    if (frame == padded) {
+        std::memcpy(data, padded, size);
+    }
+    return true;
+}
+
+void decodeColumn(const SignalPlan& plan, const std::uint8_t* payloads,
+    std::size_t stride, std::size_t count, std::double_t* values)
+{
+    switch (plan.type) {
+    case CANsignalType::Float:
+        decodeColumnOf<CANsignalType::Float>(
+            plan, payloads, stride, count, values);
+        break;
+    case CANsignalType::Double:
+        decodeColumnOf<CANsignalType::Double>(
+            plan, payloads, stride, count, values);
+        break;
+    default:
+        decodeColumnOf<CANsignalType::SignedUnsignedInt>(
+            plan, payloads, stride, count, values);
+        break;
+    }
+}
+
+void encodeColumn(const SignalPlan& plan, const std::double_t* values,
+    std::size_t count, std::uint8_t* payloads, std::size_t stride)
+{
+    switch (plan.type) {
+    case CANsignalType::Float:
+        encodeColumnOf<CANsignalType::Float>(
+            plan, values, count, payloads, stride);
+        break;
+    case CANsignalType::Double:
+        encodeColumnOf<CANsignalType::Double>(
+            plan, values, count, payloads, stride);
+        break;
+    default:
+        encodeColumnOf<CANsignalType::SignedUnsignedInt>(
+            plan, values, count, payloads, stride);
+        break;
+    }
+}
+
+Decoder::Decoder(const CANdb_t& db)
+    : can_db(std::make_shared<const CANdb_t>(db))
+    , prefilter(*can_db)
+{
+    for (const auto& message : can_db->messages) {
+        plans.insert(std::make_pair(
+            message.first.id, compileMessage(message.first, message.second)));
+    }
+}
+
+const MessagePlan* Decoder::plan(std::uint32_t id) const
+{
+    if (!prefilter.mayContain(id)) {
+        return nullptr;
+    }
+    const auto it = plans.find(id);
+    return it != plans.end() ? &it->second : nullptr;
+}
+
+bool Decoder::encode(std::uint32_t id, const std::string& signal,
+    std::double_t value, std::uint8_t* data, std::size_t size) const
+{
+    const auto it = plans.find(id);
+    if (it == plans.end()) {
+        return false;
+    }
+
+    const auto& plan = it->second;
+    const auto signalPlan = std::find_if(plan.plans.begin(), plan.plans.end(),
+        [&plan, &signal](const SignalPlan& p) {
+            return (*plan.signals)[p.index].signal_name == signal;
+        });
+    if (signalPlan == plan.plans.end()) {
+        return false;
+    }
+
+    return encodeSignal(*signalPlan, value, data, size);
+}
+
+bool Decoder::decode(std::uint32_t id, const std::uint8_t* data,
+    std::size_t size, std::vector<DecodedSignal>& out) const
+{
+    const auto* messagePlan = plan(id);
+    if (messagePlan == nullptr) {
+        return false;
+    }
+
+    decode(*messagePlan, data, size, out);
+    return true;
+}
+
+void Decoder::decode(const MessagePlan& plan, const std::uint8_t* data,
+    std::size_t size, std::vector<DecodedSignal>& out) const
+{
+    if (size < WINDOW) {
+        std::uint8_t padded[WINDOW]{};
+        std::memcpy(padded, data, size);
+        evaluate(plan, 0, padded, nullptr, size, out);
+    } else {
+        evaluate(plan, 0, data, nullptr,
+            std::min<std::size_t>(size, MAX_PAYLOAD), out);
+    }
+}
+
+void Decoder::decode(const MessagePlan& plan, const std::uint8_t* data,
+    const std::uint8_t* diff, std::size_t size,
+    std::vector<DecodedSignal>& out) const
+{
+    evaluate(
+        plan, 0, data, diff, std::min<std::size_t>(size, MAX_PAYLOAD), out);
+}
+
+void Decoder::evaluate(const MessagePlan& plan, std::uint32_t node,
+    const std::uint8_t* data, const std::uint8_t* diff, std::size_t size,
+    std::vector<DecodedSignal>& out) const
+{
+    const auto& muxNode = plan.nodes[node];
+    for (const auto p : muxNode.signals) {
+        const auto& signalPlan = plan.plans[p];
+        if (signalPlan.bytes > size
+            || (diff != nullptr && extract(signalPlan, diff) == 0)) {
+            continue;
+        }
+        const auto raw = extract(signalPlan, data);
+        out.push_back(DecodedSignal{ &(*plan.signals)[signalPlan.index], raw,
+            toPhysical(signalPlan, raw),
+            signalPlan.labels != MessagePlan::NO_LABELS
+                ? &plan.labels[signalPlan.labels]
+                : nullptr });
+    }
+
+    for (const auto& muxSwitch : muxNode.switches) {
+        const auto& muxerPlan = plan.plans[muxSwitch.muxer];
+        if (muxerPlan.bytes > size) {
+            continue;
+        }
+        const auto* branch = muxSwitch.find(extract(muxerPlan, data));
+        if (branch == nullptr) {
+            continue;
+        }
+        for (const auto child : branch->nodes) {
+            evaluate(plan, child, data, diff, size, out);
+        }
+    }
+}
+
+} // namespace CANdb
@@ -0,0 +1,169 @@
+#ifndef DECODER_H_QX7RVN2C
+#define DECODER_H_QX7RVN2C
+
+#include "cantypes.hpp"
+#include "idfilter.h"
+
+#include <memory>
+#include <unordered_map>
+
+namespace CANdb {
+
+// Raw value to label lookup compiled from a signal's value descriptions.
+// Direct indexed when the described values are dense, binary searched
+// otherwise. Holds its own copy of the labels.
+struct ValueLabels {
+    explicit ValueLabels(const CANsignal& signal);
+
+    // Valid as long as the ValueLabels
+    const std::string* find(std::uint64_t raw) const;
+
+private:
+    // Set for signed signals to sign extend raw values before the lookup
+    std::uint64_t signBit{ 0 };
+    std::int64_t base{ 0 };
+    // Label index + 1 by value - base, 0 for values without a label
+    std::vector<std::uint32_t> dense;
+    // Sorted, empty when dense
+    std::vector<std::int64_t> values;
+    std::vector<std::string> labels;
+};
+
+// Precomputed extraction parameters of a single signal
+struct SignalPlan {
+    // Index of the signal within its message's signal vector
+    std::uint32_t index;
+    // Index into MessagePlan::labels, NO_LABELS if the signal has none
+    std::uint32_t labels;
+    std::uint64_t mask;
+    // First byte of the 8 byte payload window holding the signal
+    std::uint8_t byte;
+    std::uint8_t shift;
+    // Bits of the signal stored in the byte before the window
+    std::uint8_t spill;
+    // Number of payload bytes required to hold the signal
+    std::uint8_t bytes;
+    bool bigEndian;
+    bool valueSigned;
+    // Float and Double signals are bit cast from their raw value
+    CANsignalType type;
+    std::double_t factor;
+    std::double_t offset;
+};
+
+// Raw value of a signal, data holds at least max(8, plan.bytes) bytes
+std::uint64_t extractRaw(const SignalPlan& plan, const std::uint8_t* data);
+
+// Physical value of a raw signal value
+std::double_t toPhysical(const SignalPlan& plan, std::uint64_t raw);
+
+// Raw value of a physical value, saturated to the range of integer signals
+std::uint64_t toRaw(const SignalPlan& plan, std::double_t value);
+
+// Writes the physical value of a signal into a CAN or CAN FD payload of
+// `size` bytes. Returns false if the signal does not fit the payload.
+bool encodeSignal(const SignalPlan& plan, std::double_t value,
+    std::uint8_t* data, std::size_t size);
+
+// Batch variants working on one signal of many payloads of the same message.
+// Payloads are `stride` bytes apart and hold at least max(8, plan.bytes)
+// bytes each. The type and byte order dispatch is hoisted out of the loops so
+// they can be vectorized by the compiler.
+void decodeColumn(const SignalPlan& plan, const std::uint8_t* payloads,
+    std::size_t stride, std::size_t count, std::double_t* values);
+void encodeColumn(const SignalPlan& plan, const std::double_t* values,
+    std::size_t count, std::uint8_t* payloads, std::size_t stride);
+
+// Disjoint range of multiplexor values and the nodes it enables
+struct MuxBranch {
+    std::uint64_t from;
+    std::uint64_t to;
+    std::vector<std::uint32_t> nodes;
+};
+
+struct MuxSwitch {
+    // Signal plan of the multiplexor
+    std::uint32_t muxer;
+    // Sorted by range, searched with a binary search
+    std::vector<MuxBranch> branches;
+    // Direct value -> branch + 1 table for small multiplexor ranges
+    std::vector<std::uint32_t> dense;
+
+    const MuxBranch* find(std::uint64_t value) const;
+};
+
+// Signals present whenever the node is reached, and the switches leading to
+// the nested nodes. Node 0 is the root of the message.
+struct MuxNode {
+    std::vector<std::uint32_t> signals;
+    std::vector<MuxSwitch> switches;
+};
+
+struct MessagePlan {
+    static const std::uint32_t NO_LABELS{ 0xFFFFFFFF };
+
+    const CANmessage* message;
+    const std::vector<CANsignal>* signals;
+    std::vector<SignalPlan> plans;
+    std::vector<MuxNode> nodes;
+    std::vector<ValueLabels> labels;
+};
+
+struct DecodedSignal {
+    const CANsignal* signal;
+    std::uint64_t raw;
+    std::double_t value;
+    const ValueLabels* labels;
+
+    // Label of the raw value, nullptr if the value is not described
+    const std::string* label() const
+    {
+        return labels != nullptr ? labels->find(raw) : nullptr;
+    }
+};
+
+struct Decoder {
+    explicit Decoder(const CANdb_t& db);
+
+    // Decodes the signals present in a CAN or CAN FD payload of up to 64
+    // bytes. Returns false if the id is not part of the database.
+    bool decode(std::uint32_t id, const std::uint8_t* data, std::size_t size,
+        std::vector<DecodedSignal>& out) const;
+
+    // Decodes a payload of a message already looked up with plan()
+    void decode(const MessagePlan& plan, const std::uint8_t* data,
+        std::size_t size, std::vector<DecodedSignal>& out) const;
+
+    // Decodes the present signals with a bit set in `diff`, a mask of the
+    // payload. Both hold at least max(8, size) bytes.
+    void decode(const MessagePlan& plan, const std::uint8_t* data,
+        const std::uint8_t* diff, std::size_t size,
+        std::vector<DecodedSignal>& out) const;
+
+    // Writes the physical value of a signal into a CAN or CAN FD payload.
+    // Returns false if the message or signal are unknown or the payload is too
+    // short to hold the signal.
+    bool encode(std::uint32_t id, const std::string& signal,
+        std::double_t value, std::uint8_t* data, std::size_t size) const;
+
+    // Null for ids that are not part of the database, most of them are
+    // rejected by filter() without a lookup
+    const MessagePlan* plan(std::uint32_t id) const;
+    const CANdb_t& db() const noexcept { return *can_db; }
+    const IdFilter& filter() const noexcept { return prefilter; }
+
+private:
+    // Walks the multiplexing tree, skipping signals without a bit in diff
+    // unless it is null
+    void evaluate(const MessagePlan& plan, std::uint32_t node,
+        const std::uint8_t* data, const std::uint8_t* diff, std::size_t size,
+        std::vector<DecodedSignal>& out) const;
+
+    std::shared_ptr<const CANdb_t> can_db;
+    IdFilter prefilter;
+    std::unordered_map<std::uint32_t, MessagePlan> plans;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: DECODER_H_QX7RVN2C */
@@ -0,0 +1,396 @@
+#include "fingerprint.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+inline std::uint64_t rotate(std::uint64_t value, unsigned bits)
+{
+    return value << bits | value >> (64 - bits);
+}
+
+// Up to 8 bytes as a little endian word
+inline std::uint64_t load(const char* bytes, std::size_t count)
+{
+    std::uint64_t word = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (std::size_t b = 0; b < count; ++b) {
+        word |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[b]))
+            << (8 * b);
+    }
+#else
+    std::memcpy(&word, bytes, count);
+#endif
+    return word;
+}
+
+// Finalizer of splitmix64
+inline std::uint64_t finish(std::uint64_t value)
+{
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EB;
+    return value ^ value >> 31;
+}
+
+// Tells signals from messages of the same id
+const std::uint64_t SIGNAL_ITEM{ std::uint64_t{ 1 } << 32 };
+
+struct ItemPrints {
+    CANdb::Fingerprint core;
+    CANdb::Fingerprint comment;
+    CANdb::Fingerprint attributes;
+};
+
+ItemPrints itemPrints(const CANmessage& message)
+{
+    const auto aspects = CANdb::aspectsOf(message);
+    ItemPrints prints;
+    prints.core
+        = CANdb::Hasher{}.add(message.id).add(aspects.layout).value();
+    prints.comment
+        = CANdb::Hasher{}.add(message.id).add(aspects.comment).value();
+    prints.attributes
+        = CANdb::Hasher{}.add(message.id).add(aspects.attributes).value();
+    return prints;
+}
+
+ItemPrints itemPrints(std::uint32_t id, const CANsignal& signal)
+{
+    const auto aspects = CANdb::aspectsOf(signal);
+    const auto key = CANdb::Hasher{}
+                         .add(id | SIGNAL_ITEM)
+                         .addText(signal.signal_name)
+                         .value();
+    ItemPrints prints;
+    prints.core = CANdb::Hasher{}
+                      .add(key)
+                      .add(aspects.layout)
+                      .add(aspects.scaling)
+                      .add(aspects.mux)
+                      .value();
+    prints.comment = CANdb::Hasher{}.add(key).add(aspects.comment).value();
+    prints.attributes
+        = CANdb::Hasher{}.add(key).add(aspects.attributes).value();
+    return prints;
+}
+
+// Node lists are sets, the order they are listed in does not matter
+void addNames(CANdb::Hasher& hasher, std::vector<std::string> names)
+{
+    std::sort(names.begin(), names.end());
+    hasher.add(names.size());
+    for (const auto& name : names) {
+        hasher.addText(name);
+    }
+}
+
+void addLimit(
+    CANdb::Hasher& hasher, const boost::optional<std::double_t>& limit)
+{
+    hasher.add(limit.is_initialized()).addReal(limit.value_or(0.0));
+}
+
+} // namespace
+
+namespace CANdb {
+
+std::string Fingerprint::hex() const
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string text(32, '0');
+    for (std::size_t i = 0; i < 16; ++i) {
+        text[15 - i] = digits[(high >> (4 * i)) & 15];
+        text[31 - i] = digits[(low >> (4 * i)) & 15];
+    }
+    return text;
+}
+
+Hasher& Hasher::add(std::uint64_t value) noexcept
+{
+    first = (first ^ value) * 0x9E3779B97F4A7C15;
+    first ^= first >> 32;
+    second = rotate(second + value, 29) * 0xFF51AFD7ED558CCD;
+    ++count;
+    return *this;
+}
+
+Hasher& Hasher::addReal(std::double_t value) noexcept
+{
+    std::uint64_t bits = 0;
+    if (value != value) {
+        bits = 0x7FF8000000000000;
+    } else if (value != 0.0) {
+        std::memcpy(&bits, &value, sizeof bits);
+    }
+    return add(bits);
+}
+
+Hasher& Hasher::addText(const std::string& text) noexcept
+{
+    add(text.size());
+    const auto* bytes = text.data();
+    std::size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8) {
+        add(load(bytes + i, 8));
+    }
+    if (i < text.size()) {
+        add(load(bytes + i, text.size() - i));
+    }
+    return *this;
+}
+
+Fingerprint Hasher::value() const noexcept
+{
+    Fingerprint fingerprint;
+    fingerprint.low = finish(first ^ count);
+    fingerprint.high = finish(second ^ rotate(first, 17) ^ ~count);
+    return fingerprint;
+}
+
+std::uint8_t AspectPrints::differences(const AspectPrints& rhs) const noexcept
+{
+    return static_cast<std::uint8_t>((layout != rhs.layout ? LAYOUT : 0)
+        | (scaling != rhs.scaling ? SCALING : 0) | (mux != rhs.mux ? MUX : 0)
+        | (comment != rhs.comment ? COMMENT : 0)
+        | (attributes != rhs.attributes ? ATTRIBUTES : 0));
+}
+
+AspectPrints aspectsOf(const CANsignal& signal)
+{
+    AspectPrints prints;
+    // Small fields are packed into words, every word costs a hashing step
+    const auto layout = std::uint64_t{ signal.startBit }
+        | std::uint64_t{ signal.signalSize } << 16
+        | static_cast<std::uint64_t>(signal.endianness) << 32
+        | static_cast<std::uint64_t>(signal.valueSigned) << 40
+        | std::uint64_t{ static_cast<std::uint8_t>(signal.type()) } << 48;
+    prints.layout = Hasher{}.add(layout).value();
+
+    Hasher scaling;
+    scaling.addReal(signal.factor)
+        .addReal(signal.offset)
+        .addReal(signal.min)
+        .addReal(signal.max)
+        .addText(signal.unit)
+        .add(signal.valueDescriptions().size());
+    for (const auto& description : signal.valueDescriptions()) {
+        scaling.add(static_cast<std::uint64_t>(description.value))
+            .addText(description.label);
+    }
+    prints.scaling = scaling.value();
+
+    const auto* dependency = signal.dependency();
+    Hasher mux;
+    mux.add(static_cast<std::uint64_t>(signal.muxType)
+        | static_cast<std::uint64_t>(signal.has(CANsignal::MUX_NDX)) << 8
+        | static_cast<std::uint64_t>(dependency != nullptr) << 9
+        | std::uint64_t{ signal.muxIndex() } << 16);
+    if (dependency != nullptr) {
+        mux.addText(dependency->muxSwitch).add(dependency->ranges.size());
+        for (const auto& range : dependency->ranges) {
+            mux.add(range.from).add(range.to);
+        }
+    }
+    prints.mux = mux.value();
+
+    prints.comment = Hasher{}
+                         .add(signal.has(CANsignal::COMMENT))
+                         .addText(signal.commentText())
+                         .value();
+
+    const std::vector<std::string>& receivers = signal.receivers;
+    Hasher attributes;
+    attributes.add(
+        static_cast<std::uint64_t>(signal.has(CANsignal::START_VALUE))
+        | static_cast<std::uint64_t>(signal.has(CANsignal::START_TEXT)) << 1);
+    if (signal.has(CANsignal::START_TEXT)) {
+        attributes.addText(signal.startText());
+    } else if (signal.has(CANsignal::START_VALUE)) {
+        attributes.addReal(signal.startNumber());
+    }
+    attributes.add(receivers.size());
+    for (const auto& receiver : receivers) {
+        attributes.addText(receiver);
+    }
+    prints.attributes = attributes.value();
+    return prints;
+}
+
+AspectPrints aspectsOf(const CANmessage& message)
+{
+    AspectPrints prints;
+    prints.layout
+        = Hasher{}.addText(message.name).add(message.length()).value();
+    prints.comment = Hasher{}
+                         .add(message.comment.is_initialized())
+                         .addText(message.comment.value_or(std::string()))
+                         .value();
+
+    Hasher attributes;
+    attributes.add(message.cycleTime.is_initialized())
+        .add(message.cycleTime.value_or(0))
+        .add(message.ecus.size());
+    for (const auto& ecu : message.ecus) {
+        attributes.addText(ecu);
+    }
+    prints.attributes = attributes.value();
+    return prints;
+}
+
+Fingerprint definitionOf(
+    const CANmessage& message, const std::vector<CANsignal>& signals)
+{
+    // Signals are sorted by their fingerprint, the order of a DBC file does
+    // not change the definition
+    std::vector<Fingerprint> signalPrints;
+    signalPrints.reserve(signals.size());
+    for (const auto& signal : signals) {
+        const auto aspects = aspectsOf(signal);
+        signalPrints.push_back(Hasher{}
+                                   .addText(signal.signal_name)
+                                   .add(aspects.layout)
+                                   .add(aspects.scaling)
+                                   .add(aspects.mux)
+                                   .add(aspects.attributes)
+                                   .value());
+    }
+    std::sort(signalPrints.begin(), signalPrints.end());
+
+    const auto aspects = aspectsOf(message);
+    Hasher hasher;
+    hasher.add(message.id)
+        .add(aspects.layout)
+        .add(aspects.attributes)
+        .add(signalPrints.size());
+    for (const auto& signalPrint : signalPrints) {
+        hasher.add(signalPrint);
+    }
+    return hasher.value();
+}
+
+void DbFingerprint::Sum::add(const Fingerprint& print) noexcept
+{
+    low += print.low;
+    high += print.high;
+    ++count;
+}
+
+void DbFingerprint::Sum::remove(const Fingerprint& print) noexcept
+{
+    low -= print.low;
+    high -= print.high;
+    --count;
+}
+
+void DbFingerprint::add(const CANmessage& message)
+{
+    const auto prints = itemPrints(message);
+    core.add(prints.core);
+    comments.add(prints.comment);
+    attributes.add(prints.attributes);
+}
+
+void DbFingerprint::remove(const CANmessage& message)
+{
+    const auto prints = itemPrints(message);
+    core.remove(prints.core);
+    comments.remove(prints.comment);
+    attributes.remove(prints.attributes);
+}
+
+void DbFingerprint::add(std::uint32_t id, const CANsignal& signal)
+{
+    const auto prints = itemPrints(id, signal);
+    core.add(prints.core);
+    comments.add(prints.comment);
+    attributes.add(prints.attributes);
+}
+
+void DbFingerprint::remove(std::uint32_t id, const CANsignal& signal)
+{
+    const auto prints = itemPrints(id, signal);
+    core.remove(prints.core);
+    comments.remove(prints.comment);
+    attributes.remove(prints.attributes);
+}
+
+void DbFingerprint::setGlobals(const CANdb_t& db)
+{
+    Hasher hasher;
+    addNames(hasher, db.nodes);
+    addNames(hasher, db.ecus);
+    // Value tables are referenced by name, sorted the same way
+    std::vector<const CANdb_t::ValTable*> tables;
+    tables.reserve(db.val_tables.size());
+    for (const auto& table : db.val_tables) {
+        tables.push_back(&table);
+    }
+    std::sort(tables.begin(), tables.end(),
+        [](const CANdb_t::ValTable* lhs, const CANdb_t::ValTable* rhs) {
+            return lhs->identifier < rhs->identifier;
+        });
+    hasher.add(tables.size());
+    for (const auto* table : tables) {
+        hasher.addText(table->identifier).add(table->entries.size());
+        for (const auto& entry : table->entries) {
+            hasher.add(static_cast<std::uint64_t>(entry.value))
+                .addText(entry.label);
+        }
+    }
+    globals = hasher.value();
+
+    Hasher definitions;
+    definitions.addText(db.version);
+    for (const auto* cycleTime : { &db.genMsgCycleTimeMin,
+             &db.genMsgCycleTimeMax, &db.genMsgCycleTimeDefault }) {
+        definitions.add(cycleTime->is_initialized())
+            .add(cycleTime->value_or(0));
+    }
+    addLimit(definitions, db.genSigStartValueMin);
+    addLimit(definitions, db.genSigStartValueMax);
+    addLimit(definitions, db.genSigStartValueDefault);
+    globalAttributes = definitions.value();
+    complete = true;
+}
+
+Fingerprint DbFingerprint::value(std::uint8_t include) const noexcept
+{
+    if (!complete) {
+        return Fingerprint{};
+    }
+    include &= COMMENT | ATTRIBUTES;
+    Hasher hasher;
+    hasher.add(include)
+        .add(core.low)
+        .add(core.high)
+        .add(core.count)
+        .add(globals);
+    if ((include & COMMENT) != 0) {
+        hasher.add(comments.low).add(comments.high).add(comments.count);
+    }
+    if ((include & ATTRIBUTES) != 0) {
+        hasher.add(attributes.low)
+            .add(attributes.high)
+            .add(attributes.count)
+            .add(globalAttributes);
+    }
+    return hasher.value();
+}
+
+Fingerprint fingerprintOf(const CANdb_t& db, std::uint8_t include)
+{
+    DbFingerprint fingerprint;
+    for (const auto& message : db.messages) {
+        fingerprint.add(message.first);
+        for (const auto& signal : message.second) {
+            fingerprint.add(message.first.id, signal);
+        }
+    }
+    fingerprint.setGlobals(db);
+    return fingerprint.value(include);
+}
+
+} // namespace CANdb
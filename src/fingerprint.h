@@ -0,0 +1,130 @@
+#ifndef FINGERPRINT_H_R6ZK2TMA
+#define FINGERPRINT_H_R6ZK2TMA
+
+#include "cantypes.hpp"
+
+namespace CANdb {
+
+// 128 bit content hash, not meant to resist deliberate collisions
+struct Fingerprint {
+    std::uint64_t low{ 0 };
+    std::uint64_t high{ 0 };
+
+    bool operator==(const Fingerprint& rhs) const noexcept
+    {
+        return low == rhs.low && high == rhs.high;
+    }
+    bool operator!=(const Fingerprint& rhs) const noexcept
+    {
+        return !(*this == rhs);
+    }
+    bool operator<(const Fingerprint& rhs) const noexcept
+    {
+        return high != rhs.high ? high < rhs.high : low < rhs.low;
+    }
+
+    // 32 lower case hex digits, high half first
+    std::string hex() const;
+};
+
+// Order dependent hash of a sequence of values in two independent 64 bit
+// lanes. Values are hashed by content, not by memory representation, so
+// fingerprints are the same on every platform.
+struct Hasher {
+    Hasher& add(std::uint64_t value) noexcept;
+    // -0.0 is hashed as 0.0 and every NaN alike
+    Hasher& addReal(std::double_t value) noexcept;
+    // The length and the bytes
+    Hasher& addText(const std::string& text) noexcept;
+    Hasher& add(const Fingerprint& value) noexcept
+    {
+        return add(value.low).add(value.high);
+    }
+
+    Fingerprint value() const noexcept;
+
+private:
+    std::uint64_t first{ 0x243F6A8885A308D3 };
+    std::uint64_t second{ 0x13198A2E03707344 };
+    std::uint64_t count{ 0 };
+};
+
+// Parts of a message or signal that are fingerprinted separately
+enum Aspect : std::uint8_t {
+    LAYOUT = 1,
+    SCALING = 2,
+    MUX = 4,
+    COMMENT = 8,
+    ATTRIBUTES = 16,
+};
+
+struct AspectPrints {
+    Fingerprint layout;
+    Fingerprint scaling;
+    Fingerprint mux;
+    Fingerprint comment;
+    Fingerprint attributes;
+
+    // Aspects that differ
+    std::uint8_t differences(const AspectPrints& rhs) const noexcept;
+};
+
+// Signal aspects: the layout is the start bit, size, byte order, signedness
+// and value type; the scaling the factor, offset, range, unit and value
+// descriptions; the multiplexing the multiplexor type, value and switch;
+// the attributes the start value and receivers. The name is left out.
+AspectPrints aspectsOf(const CANsignal& signal);
+// Message aspects: the layout is the name and length, the attributes are the
+// senders and cycle time. Messages have no scaling or multiplexing of their
+// own, the id and the signals are left out.
+AspectPrints aspectsOf(const CANmessage& message);
+
+// Definition of a message: its id and every aspect of it and of its signals
+// but comments. Signals are taken in any order.
+Fingerprint definitionOf(
+    const CANmessage& message, const std::vector<CANsignal>& signals);
+
+// Canonical fingerprint of a whole database, kept up to date while the
+// database is built. Messages and signals are hashed one by one and their
+// prints summed lane by lane, so the order of a DBC file does not matter and
+// an item is updated by removing its old state and adding the new one.
+// Comments and attributes are summed apart to be left out on demand.
+struct DbFingerprint {
+    // The fields of the message itself, not its signals
+    void add(const CANmessage& message);
+    void remove(const CANmessage& message);
+    // A signal of the message with the id
+    void add(std::uint32_t id, const CANsignal& signal);
+    void remove(std::uint32_t id, const CANsignal& signal);
+    // The nodes and value tables, and the version and attribute definitions
+    // as attributes. Replaces the ones set before and completes the print.
+    void setGlobals(const CANdb_t& db);
+
+    // include takes COMMENT and ATTRIBUTES. All zero until the globals are
+    // set, never the print of a database.
+    Fingerprint value(std::uint8_t include = 0) const noexcept;
+
+private:
+    struct Sum {
+        std::uint64_t low{ 0 };
+        std::uint64_t high{ 0 };
+        std::uint64_t count{ 0 };
+
+        void add(const Fingerprint& print) noexcept;
+        void remove(const Fingerprint& print) noexcept;
+    };
+
+    Sum core;
+    Sum comments;
+    Sum attributes;
+    Fingerprint globals;
+    Fingerprint globalAttributes;
+    bool complete{ false };
+};
+
+// Same as a DbFingerprint built from every item of the database
+Fingerprint fingerprintOf(const CANdb_t& db, std::uint8_t include = 0);
+
+} // namespace CANdb
+
+#endif /* end of include guard: FINGERPRINT_H_R6ZK2TMA */
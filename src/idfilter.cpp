@@ -0,0 +1,72 @@
+#include "idfilter.h"
+
+namespace {
+
+// Bloom filter bits per extended id, at least. The false positive rate with
+// four bits per id is below 0.2% at 32 bits per id.
+const std::size_t BITS_PER_ID{ 32 };
+
+} // namespace
+
+namespace CANdb {
+
+const std::uint32_t IdFilter::STANDARD_IDS;
+
+IdFilter::IdFilter()
+    : extended(1, 0)
+{
+    standard.fill(0);
+}
+
+IdFilter::IdFilter(const CANdb_t& db)
+{
+    standard.fill(0);
+
+    std::size_t count = 0;
+    for (const auto& message : db.messages) {
+        count += message.first.id >= STANDARD_IDS ? 1 : 0;
+    }
+    std::size_t words = 1;
+    while (words * 64 < count * BITS_PER_ID) {
+        words *= 2;
+    }
+    extended.assign(words, 0);
+
+    for (const auto& message : db.messages) {
+        insert(message.first.id);
+    }
+}
+
+void IdFilter::insert(std::uint32_t id)
+{
+    if (id < STANDARD_IDS) {
+        standard[id / 64] |= std::uint64_t{ 1 } << (id % 64);
+    } else {
+        const auto hash = mix(id);
+        extended[(hash >> 32) & (extended.size() - 1)] |= mask(hash);
+    }
+}
+
+std::size_t IdFilter::select(const CANframe* frames, std::size_t count,
+    std::uint32_t* passed) const noexcept
+{
+    std::size_t selected = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        passed[selected] = static_cast<std::uint32_t>(i);
+        selected += mayContain(frames[i]) ? 1 : 0;
+    }
+    return selected;
+}
+
+std::size_t IdFilter::select(const std::uint32_t* ids, std::size_t count,
+    std::uint32_t* passed) const noexcept
+{
+    std::size_t selected = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        passed[selected] = static_cast<std::uint32_t>(i);
+        selected += mayContain(ids[i]) ? 1 : 0;
+    }
+    return selected;
+}
+
+} // namespace CANdb
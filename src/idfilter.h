@@ -0,0 +1,79 @@
+#ifndef IDFILTER_H_P2VK7MRT
+#define IDFILTER_H_P2VK7MRT
+
+#include "canframe.h"
+#include "cantypes.hpp"
+
+#include <array>
+
+namespace CANdb {
+
+// Rejects frames of messages missing from a database before they are looked
+// up. Ids below 2048, the standard ids, are tested in a bitmap and never
+// pass by mistake. Extended ids are tested in a register blocked Bloom
+// filter: an id sets four bits of a single 64 bit word, so the test is one
+// load and compare, and about one in a thousand unknown ids passes.
+struct IdFilter {
+    static const std::uint32_t STANDARD_IDS{ 2048 };
+
+    // Passes no id
+    IdFilter();
+    // Passes the messages of the database, ids as used by DBC files
+    explicit IdFilter(const CANdb_t& db);
+
+    // True if the id may belong to the database
+    bool mayContain(std::uint32_t id) const noexcept
+    {
+        if (id < STANDARD_IDS) {
+            return (standard[id / 64] >> (id % 64) & 1) != 0;
+        }
+        const auto hash = mix(id);
+        const auto bits = mask(hash);
+        return (extended[(hash >> 32) & (extended.size() - 1)] & bits) == bits;
+    }
+    bool mayContain(const CANframe& frame) const noexcept
+    {
+        return mayContain(frame.dbcId());
+    }
+
+    // Batch tests for logs, passing indexes are stored without a branch on
+    // the result. Write the indexes of the frames or ids that may belong to
+    // the database to `passed`, which holds `count` entries, and return
+    // their number.
+    std::size_t select(const CANframe* frames, std::size_t count,
+        std::uint32_t* passed) const noexcept;
+    std::size_t select(const std::uint32_t* ids, std::size_t count,
+        std::uint32_t* passed) const noexcept;
+
+    // Memory used by the bitmap and the Bloom filter
+    std::size_t bytes() const noexcept
+    {
+        return sizeof standard + extended.size() * sizeof(std::uint64_t);
+    }
+
+private:
+    static std::uint64_t mix(std::uint32_t id) noexcept
+    {
+        std::uint64_t hash = id * std::uint64_t{ 0x9E3779B97F4A7C15 };
+        hash ^= hash >> 29;
+        hash *= std::uint64_t{ 0xBF58476D1CE4E5B9 };
+        return hash ^ hash >> 32;
+    }
+    static std::uint64_t mask(std::uint64_t hash) noexcept
+    {
+        return std::uint64_t{ 1 } << (hash & 63)
+            | std::uint64_t{ 1 } << (hash >> 6 & 63)
+            | std::uint64_t{ 1 } << (hash >> 12 & 63)
+            | std::uint64_t{ 1 } << (hash >> 18 & 63);
+    }
+
+    void insert(std::uint32_t id);
+
+    std::array<std::uint64_t, STANDARD_IDS / 64> standard;
+    // Power of two number of words
+    std::vector<std::uint64_t> extended;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: IDFILTER_H_P2VK7MRT */
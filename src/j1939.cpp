@@ -0,0 +1,67 @@
+#include "j1939.h"
+#include "log.hpp"
+
+namespace CANdb {
+
+J1939Decoder::J1939Decoder(const CANdb_t& db)
+    : can_decoder(db)
+{
+    for (const auto& message : can_decoder.db().messages) {
+        const auto id = message.first.id;
+        if ((id & CAN_EXTENDED_ID_FLAG) == 0) {
+            continue;
+        }
+
+        const auto* messagePlan = can_decoder.plan(id);
+        if (messagePlan == nullptr) {
+            continue;
+        }
+
+        const auto pgn = parseJ1939Id(id & ~CAN_EXTENDED_ID_FLAG).pgn;
+        const auto inserted
+            = pgns.insert(std::make_pair(pgn, PgnEntry{ messagePlan, false }));
+        if (!inserted.second) {
+            cdb_debug("PGN {} defined by more than one message, {} and {}",
+                pgn, inserted.first->second.plan->message->name,
+                message.first.name);
+            inserted.first->second.shared = true;
+        }
+    }
+}
+
+const MessagePlan* J1939Decoder::plan(std::uint32_t id) const
+{
+    if ((id & CAN_EXTENDED_ID_FLAG) == 0) {
+        return nullptr;
+    }
+
+    id &= ~CAN_EXTENDED_ID_FLAG;
+    const auto it = pgns.find(parseJ1939Id(id).pgn);
+    if (it == pgns.end()) {
+        return nullptr;
+    }
+
+    if (it->second.shared) {
+        const auto* exact = can_decoder.plan(id | CAN_EXTENDED_ID_FLAG);
+        if (exact != nullptr) {
+            return exact;
+        }
+    }
+    return it->second.plan;
+}
+
+bool J1939Decoder::decode(std::uint32_t id, const std::uint8_t* data,
+    std::size_t size, J1939Header& header,
+    std::vector<DecodedSignal>& out) const
+{
+    const auto* messagePlan = plan(id);
+    if (messagePlan == nullptr) {
+        return false;
+    }
+
+    header = parseJ1939Id(id & ~CAN_EXTENDED_ID_FLAG);
+    can_decoder.decode(*messagePlan, data, size, out);
+    return true;
+}
+
+} // namespace CANdb
@@ -0,0 +1,72 @@
+#ifndef J1939_H_H4TQZP8M
+#define J1939_H_H4TQZP8M
+
+#include "canframe.h"
+#include "decoder.h"
+
+namespace CANdb {
+
+// Fields of a 29-bit J1939 identifier
+struct J1939Header {
+    std::uint32_t pgn;
+    std::uint8_t priority;
+    std::uint8_t source;
+    // Destination of PDU1 messages, 0xFF (global) for PDU2 messages
+    std::uint8_t destination;
+};
+
+const std::uint8_t J1939_GLOBAL_ADDRESS{ 0xFF };
+
+// PDU format values below this carry a destination address in the PDU
+// specific field (PDU1), others carry a group extension (PDU2)
+const std::uint8_t J1939_PDU2_FORMAT{ 240 };
+
+inline J1939Header parseJ1939Id(std::uint32_t id)
+{
+    const auto format = static_cast<std::uint8_t>(id >> 16);
+    const auto specific = static_cast<std::uint8_t>(id >> 8);
+    const bool pdu2 = format >= J1939_PDU2_FORMAT;
+
+    J1939Header header;
+    header.pgn = (id >> 8) & (pdu2 ? 0x3FFFF : 0x3FF00);
+    header.priority = static_cast<std::uint8_t>((id >> 26) & 0x7);
+    header.source = static_cast<std::uint8_t>(id);
+    header.destination = pdu2 ? J1939_GLOBAL_ADDRESS : specific;
+    return header;
+}
+
+// Resolves J1939 frames through the PGN of their id, so a message defined
+// for one source or destination address decodes frames of every ECU
+// sending the same PGN.
+struct J1939Decoder {
+    explicit J1939Decoder(const CANdb_t& db);
+    // The PGN index points into the plans of the decoder
+    J1939Decoder(const J1939Decoder&) = delete;
+    J1939Decoder& operator=(const J1939Decoder&) = delete;
+
+    // Plan of the message defining the PGN of an extended id, nullptr if none
+    // or if the id is a standard one.
+    // An exact id match wins when the database defines a PGN more than once.
+    const MessagePlan* plan(std::uint32_t id) const;
+
+    // Decodes a frame and its J1939 header. Returns false if the PGN is not
+    // part of the database.
+    bool decode(std::uint32_t id, const std::uint8_t* data, std::size_t size,
+        J1939Header& header, std::vector<DecodedSignal>& out) const;
+
+    const Decoder& decoder() const noexcept { return can_decoder; }
+
+private:
+    struct PgnEntry {
+        const MessagePlan* plan;
+        // Set if several messages share the PGN
+        bool shared;
+    };
+
+    Decoder can_decoder;
+    std::unordered_map<std::uint32_t, PgnEntry> pgns;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: J1939_H_H4TQZP8M */
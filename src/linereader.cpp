@@ -0,0 +1,107 @@
+#include "linereader.h"
+
+#include <cstring>
+
+namespace CANdb {
+
+LineReader::LineReader(std::FILE* _file, std::size_t bufferSize)
+    : file(_file)
+    , buffer(bufferSize)
+{
+}
+
+bool LineReader::next(const char*& begin, const char*& end)
+{
+    for (;;) {
+        const auto* data = buffer.data();
+        const auto* newline = static_cast<const char*>(
+            std::memchr(data + head, '\n', tail - head));
+
+        if (newline != nullptr) {
+            const auto start = head;
+            head = static_cast<std::size_t>(newline - data) + 1;
+            if (discarding) {
+                discarding = false;
+                continue;
+            }
+            begin = data + start;
+            end = newline;
+            ++lineCount;
+            return true;
+        }
+
+        if (eof) {
+            if (head == tail || discarding) {
+                return false;
+            }
+            begin = data + head;
+            end = data + tail;
+            head = tail;
+            ++lineCount;
+            return true;
+        }
+
+        // Keep the partial line and refill the rest of the buffer
+        if (discarding) {
+            tail = 0;
+        } else if (head == 0 && tail == buffer.size()) {
+            // Lines longer than the buffer are skipped up to the next break
+            ++overlongCount;
+            discarding = true;
+            tail = 0;
+        } else {
+            std::memmove(buffer.data(), data + head, tail - head);
+            tail -= head;
+        }
+        head = 0;
+
+        const auto read
+            = std::fread(buffer.data() + tail, 1, buffer.size() - tail, file);
+        tail += read;
+        eof = read == 0;
+    }
+}
+
+namespace scan {
+
+const char* number(
+    const char* it, const char* end, unsigned base, std::uint64_t& value)
+{
+    const char* digits = it;
+    value = 0;
+    int digit = 0;
+    while (it != end && (digit = hexValue(*it)) >= 0
+        && static_cast<unsigned>(digit) < base) {
+        value = value * base + static_cast<std::uint64_t>(digit);
+        ++it;
+    }
+    return it != digits ? it : nullptr;
+}
+
+const char* seconds(const char* it, const char* end, std::uint64_t& value)
+{
+    std::uint64_t whole = 0;
+    it = number(it, end, 10, whole);
+    if (it == nullptr) {
+        return nullptr;
+    }
+
+    std::uint64_t fraction = 0;
+    std::uint64_t scale = 1000000000;
+    if (it != end && *it == '.') {
+        ++it;
+        while (it != end && *it >= '0' && *it <= '9') {
+            if (scale > 1) {
+                scale /= 10;
+                fraction += static_cast<std::uint64_t>(*it - '0') * scale;
+            }
+            ++it;
+        }
+    }
+
+    value = whole * 1000000000 + fraction;
+    return it;
+}
+
+} // namespace scan
+} // namespace CANdb
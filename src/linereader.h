@@ -0,0 +1,91 @@
+#ifndef LINEREADER_H_B3XH7KQA
+#define LINEREADER_H_B3XH7KQA
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace CANdb {
+
+// Streams the lines of a text file through a fixed size buffer. Lines are
+// returned in place, without the line break, and stay valid until the next
+// call. Memory use does not depend on the size of the file.
+struct LineReader {
+    static const std::size_t DEFAULT_BUFFER{ 1 << 20 };
+
+    // The file stays owned by the caller
+    explicit LineReader(
+        std::FILE* file, std::size_t bufferSize = DEFAULT_BUFFER);
+
+    // Returns false at the end of the file
+    bool next(const char*& begin, const char*& end);
+
+    std::uint64_t lines() const noexcept { return lineCount; }
+    // Lines longer than the buffer, these are skipped
+    std::uint64_t overlong() const noexcept { return overlongCount; }
+
+private:
+    std::FILE* file;
+    std::vector<char> buffer;
+    std::size_t head{ 0 };
+    std::size_t tail{ 0 };
+    bool eof{ false };
+    bool discarding{ false };
+    std::uint64_t lineCount{ 0 };
+    std::uint64_t overlongCount{ 0 };
+};
+
+// Allocation free helpers to scan log lines
+namespace scan {
+
+inline int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline const char* skipSpaces(const char* it, const char* end)
+{
+    while (it != end && isSpace(*it)) {
+        ++it;
+    }
+    return it;
+}
+
+// Splits the next whitespace separated token [begin, tokenEnd) off `it`.
+// Returns false if the line has no more tokens.
+inline bool token(const char*& it, const char* end, const char*& begin,
+    const char*& tokenEnd)
+{
+    begin = skipSpaces(it, end);
+    tokenEnd = begin;
+    while (tokenEnd != end && !isSpace(*tokenEnd)) {
+        ++tokenEnd;
+    }
+    it = tokenEnd;
+    return begin != tokenEnd;
+}
+
+// Parses an unsigned number of the given base (10 or 16) and returns the
+// position after it, nullptr if there are no digits
+const char* number(const char* it, const char* end, unsigned base,
+    std::uint64_t& value);
+
+// Parses "seconds.fraction" into nanoseconds and returns the position after
+// it, nullptr if there are no digits
+const char* seconds(const char* it, const char* end, std::uint64_t& value);
+
+} // namespace scan
+} // namespace CANdb
+
+#endif /* end of include guard: LINEREADER_H_B3XH7KQA */
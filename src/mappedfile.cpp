@@ -0,0 +1,103 @@
+#include "mappedfile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace CANdb {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+{
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        file = nullptr;
+        throw std::runtime_error("Failed to open " + path);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to get the size of " + path);
+    }
+    length = static_cast<std::size_t>(size.QuadPart);
+    if (length == 0) {
+        return;
+    }
+
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* view = mapping != nullptr
+        ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)
+        : nullptr;
+    if (view == nullptr) {
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map " + path);
+    }
+    begin = static_cast<const std::uint8_t*>(view);
+}
+
+MappedFile::~MappedFile()
+{
+    if (begin != nullptr) {
+        UnmapViewOfFile(begin);
+    }
+    if (mapping != nullptr) {
+        CloseHandle(mapping);
+    }
+    if (file != nullptr) {
+        CloseHandle(file);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to get the size of " + path);
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length == 0) {
+        ::close(fd);
+        return;
+    }
+
+    void* view = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("Failed to map " + path);
+    }
+    // Objects are read front to back
+    ::madvise(view, length, MADV_SEQUENTIAL);
+    begin = static_cast<const std::uint8_t*>(view);
+}
+
+MappedFile::~MappedFile()
+{
+    if (begin != nullptr) {
+        ::munmap(const_cast<std::uint8_t*>(begin), length);
+    }
+}
+
+#endif
+
+} // namespace CANdb
@@ -0,0 +1,33 @@
+#ifndef MAPPEDFILE_H_P4ZC8NRV
+#define MAPPEDFILE_H_P4ZC8NRV
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace CANdb {
+
+// Read only memory mapping of a whole file
+struct MappedFile {
+    // Throws std::runtime_error if the file can not be opened or mapped
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::uint8_t* data() const noexcept { return begin; }
+    std::size_t size() const noexcept { return length; }
+
+private:
+    const std::uint8_t* begin{ nullptr };
+    std::size_t length{ 0 };
+#ifdef _WIN32
+    void* file{ nullptr };
+    void* mapping{ nullptr };
+#endif
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: MAPPEDFILE_H_P4ZC8NRV */
@@ -0,0 +1,91 @@
+#include "multibus.h"
+
+#include <algorithm>
+
+namespace CANdb {
+
+const std::uint32_t MultiBusDb::NO_BUS;
+
+MultiBusDb MultiBusDb::merge(std::vector<BusDb> inputs)
+{
+    MultiBusDb merged;
+    std::size_t total = 0;
+    for (const auto& input : inputs) {
+        total += input.db.messages.size();
+    }
+    merged.sources.reserve(inputs.size());
+    merged.entries.reserve(total);
+    merged.dispatch.reserve(total);
+
+    std::unordered_map<std::string, std::uint32_t> buses;
+    // Of the messages defined more than once, by index in entries
+    std::unordered_map<std::uint32_t, Fingerprint> definitions;
+    for (std::uint32_t source = 0; source < inputs.size(); ++source) {
+        auto& input = inputs[source];
+        const auto found = buses.emplace(
+            input.bus, static_cast<std::uint32_t>(merged.busNames.size()));
+        if (found.second) {
+            merged.busNames.push_back(input.bus);
+        }
+        const auto bus = found.first->second;
+        merged.sources.push_back(
+            std::make_shared<const CANdb_t>(std::move(input.db)));
+        const auto& db = *merged.sources.back();
+
+        for (const auto& node : db.nodes) {
+            merged.nodeNames.push_back(CANstring(node));
+        }
+        for (const auto& message : db.messages) {
+            const auto inserted
+                = merged.dispatch.emplace(key(bus, message.first.id),
+                    static_cast<std::uint32_t>(merged.entries.size()));
+            if (!inserted.second) {
+                const auto index = inserted.first->second;
+                const auto& kept = merged.entries[index];
+                auto known = definitions.find(index);
+                if (known == definitions.end()) {
+                    known = definitions
+                                .emplace(index,
+                                    definitionOf(*kept.message, *kept.signals))
+                                .first;
+                }
+                if (known->second
+                    != definitionOf(message.first, message.second)) {
+                    merged.clashes.push_back(Conflict{
+                        bus, message.first.id, kept.source, source });
+                }
+                continue;
+            }
+            merged.entries.push_back(
+                Message{ bus, &message.first, &message.second, source });
+        }
+    }
+
+    std::sort(merged.entries.begin(), merged.entries.end(),
+        [](const Message& lhs, const Message& rhs) {
+            return key(lhs.bus, lhs.message->id)
+                < key(rhs.bus, rhs.message->id);
+        });
+    for (std::uint32_t i = 0; i < merged.entries.size(); ++i) {
+        const auto& entry = merged.entries[i];
+        merged.dispatch[key(entry.bus, entry.message->id)] = i;
+    }
+
+    auto& nodes = merged.nodeNames;
+    std::sort(nodes.begin(), nodes.end(),
+        [](const CANstring& lhs, const CANstring& rhs) {
+            return lhs.get() < rhs.get();
+        });
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    return merged;
+}
+
+std::uint32_t MultiBusDb::bus(const std::string& name) const
+{
+    const auto it = std::find(busNames.begin(), busNames.end(), name);
+    return it != busNames.end()
+        ? static_cast<std::uint32_t>(it - busNames.begin())
+        : NO_BUS;
+}
+
+} // namespace CANdb
@@ -0,0 +1,89 @@
+#ifndef MULTIBUS_H_F8LX3CQP
+#define MULTIBUS_H_F8LX3CQP
+
+#include "cantypes.hpp"
+#include "fingerprint.h"
+
+#include <memory>
+#include <unordered_map>
+
+namespace CANdb {
+
+// Database of one bus, several of them may name the same bus
+struct BusDb {
+    std::string bus;
+    CANdb_t db;
+};
+
+// Databases of several buses merged into one, messages are keyed by bus and
+// id. The merged databases are moved in and shared, not copied: messages
+// and signals are reached through pointers into them. Units and node names
+// are interned, each distinct string is stored once for all buses.
+struct MultiBusDb {
+    static const std::uint32_t NO_BUS{ 0xFFFFFFFF };
+
+    struct Message {
+        std::uint32_t bus;
+        const CANmessage* message;
+        const std::vector<CANsignal>* signals;
+        // Index of the input that defined the message first
+        std::uint32_t source;
+    };
+
+    // The same bus and id defined differently by two inputs, the first
+    // definition is kept
+    struct Conflict {
+        std::uint32_t bus;
+        std::uint32_t id;
+        // Indexes of the inputs
+        std::uint32_t first;
+        std::uint32_t second;
+    };
+
+    // Buses are numbered in the order they first appear in the inputs.
+    // Messages defined by several inputs of a bus are kept once when their
+    // definitions (definitionOf()) hash alike and reported as conflicts
+    // otherwise. Only these messages are hashed.
+    static MultiBusDb merge(std::vector<BusDb> inputs);
+
+    std::size_t busCount() const noexcept { return busNames.size(); }
+    const std::string& busName(std::uint32_t bus) const
+    {
+        return busNames.at(bus);
+    }
+    // NO_BUS if there is no such bus
+    std::uint32_t bus(const std::string& name) const;
+
+    // nullptr if the bus has no such message, ids as used by DBC files
+    const Message* find(std::uint32_t bus, std::uint32_t id) const
+    {
+        const auto it = dispatch.find(key(bus, id));
+        return it != dispatch.end() ? &entries[it->second] : nullptr;
+    }
+
+    // Sorted by bus and id
+    const std::vector<Message>& messages() const noexcept { return entries; }
+    const std::vector<Conflict>& conflicts() const noexcept
+    {
+        return clashes;
+    }
+    // Nodes of all buses, sorted by name
+    const std::vector<CANstring>& nodes() const noexcept { return nodeNames; }
+
+private:
+    static std::uint64_t key(std::uint32_t bus, std::uint32_t id) noexcept
+    {
+        return static_cast<std::uint64_t>(bus) << 32 | id;
+    }
+
+    std::vector<std::shared_ptr<const CANdb_t>> sources;
+    std::vector<std::string> busNames;
+    std::vector<Message> entries;
+    std::unordered_map<std::uint64_t, std::uint32_t> dispatch;
+    std::vector<Conflict> clashes;
+    std::vector<CANstring> nodeNames;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: MULTIBUS_H_F8LX3CQP */
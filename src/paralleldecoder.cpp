@@ -0,0 +1,269 @@
+#include "paralleldecoder.h"
+#include "ascreader.h"
+#include "candump.h"
+
+#include <cstring>
+
+namespace {
+
+// Splits the next line off [it, end), without the line break. Returns false
+// at the end of the range.
+inline bool nextLine(
+    const char*& it, const char* end, const char*& begin, const char*& lineEnd)
+{
+    if (it == end) {
+        return false;
+    }
+    begin = it;
+    const auto* newline = static_cast<const char*>(
+        std::memchr(it, '\n', static_cast<std::size_t>(end - it)));
+    lineEnd = newline != nullptr ? newline : end;
+    it = newline != nullptr ? newline + 1 : end;
+    return true;
+}
+
+std::uint16_t channelIndex(
+    std::vector<std::string>& names, const char* begin, const char* end)
+{
+    const auto length = static_cast<std::size_t>(end - begin);
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        if (names[i].size() == length
+            && std::memcmp(names[i].data(), begin, length) == 0) {
+            return static_cast<std::uint16_t>(i);
+        }
+    }
+    names.emplace_back(begin, end);
+    return static_cast<std::uint16_t>(names.size() - 1);
+}
+
+} // namespace
+
+namespace CANdb {
+
+ParallelLogDecoder::ParallelLogDecoder(const std::string& path, Format format,
+    const Decoder& decoder, unsigned threads, std::size_t chunkSize)
+    : file(path)
+    , format(format)
+    , decoder(decoder)
+    , threads(threads)
+    , chunkSize(chunkSize != 0 ? chunkSize : DEFAULT_CHUNK)
+    , chunkCount((file.size() + this->chunkSize - 1) / this->chunkSize)
+{
+    if (format != Format::Asc) {
+        return;
+    }
+
+    // The header ends with the first frame
+    const auto* it = reinterpret_cast<const char*>(file.data());
+    const auto* end = it + file.size();
+    const char* begin;
+    const char* lineEnd;
+    CANframe frame;
+    while (nextLine(it, end, begin, lineEnd)
+        && !parseAscLine(begin, lineEnd, hex, frame)) {
+        parseAscBase(begin, lineEnd, hex, relative);
+    }
+}
+
+ParallelLogDecoder::~ParallelLogDecoder() { stop(); }
+
+void ParallelLogDecoder::start()
+{
+    slots.clear();
+    slots.resize(threads != 0 ? 2 * threads : 1);
+    assigned = 0;
+    emitted = 0;
+    stopping = false;
+
+    channelNames.clear();
+    carry = 0;
+    frameCount = 0;
+    decodedCount = 0;
+    lineCount = 0;
+    skippedCount = 0;
+
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(&ParallelLogDecoder::work, this);
+    }
+}
+
+void ParallelLogDecoder::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+ParallelLogDecoder::Chunk* ParallelLogDecoder::next()
+{
+    if (emitted == chunkCount) {
+        return nullptr;
+    }
+
+    auto& slot = slots[emitted % slots.size()];
+    if (workers.empty()) {
+        parse(slot, emitted);
+    } else {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock,
+            [this, &slot] { return slot.ready && slot.index == emitted; });
+    }
+    stitch(slot);
+    return &slot;
+}
+
+void ParallelLogDecoder::release(Chunk* chunk)
+{
+    if (workers.empty()) {
+        ++emitted;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        chunk->ready = false;
+        ++emitted;
+    }
+    changed.notify_all();
+}
+
+void ParallelLogDecoder::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        changed.wait(lock, [this] {
+            return stopping
+                || (assigned < chunkCount && assigned < emitted + slots.size());
+        });
+        if (stopping) {
+            return;
+        }
+
+        const auto index = assigned++;
+        auto& slot = slots[index % slots.size()];
+
+        lock.unlock();
+        parse(slot, index);
+        lock.lock();
+
+        slot.ready = true;
+        changed.notify_all();
+    }
+}
+
+std::size_t ParallelLogDecoder::boundary(std::size_t offset) const
+{
+    if (offset == 0 || offset >= file.size()) {
+        return offset == 0 ? 0 : file.size();
+    }
+    // A chunk starts after the first line break at or after its nominal
+    // start, so a line break right before it keeps the offset
+    const auto* data = file.data();
+    const auto* newline = static_cast<const std::uint8_t*>(
+        std::memchr(data + offset - 1, '\n', file.size() - offset + 1));
+    return newline != nullptr ? static_cast<std::size_t>(newline - data) + 1
+                              : file.size();
+}
+
+void ParallelLogDecoder::parse(Chunk& chunk, std::size_t index) const
+{
+    chunk.index = index;
+    chunk.size = 0;
+    chunk.channels.clear();
+    chunk.lines = 0;
+    chunk.skipped = 0;
+    chunk.elapsed = 0;
+
+    const auto* data = reinterpret_cast<const char*>(file.data());
+    const auto* it = data + boundary(index * chunkSize);
+    const auto* end = data + boundary((index + 1) * chunkSize);
+    const char* begin;
+    const char* lineEnd;
+    const MessagePlan* plan = nullptr;
+    // No frame has this id
+    std::uint32_t id = 0xFFFFFFFF;
+    while (nextLine(it, end, begin, lineEnd)) {
+        ++chunk.lines;
+        if (chunk.size == chunk.frames.size()) {
+            const auto grown = chunk.size != 0 ? 2 * chunk.size : 1024;
+            chunk.frames.resize(grown);
+            chunk.plans.resize(grown);
+            chunk.signals.resize(grown);
+        }
+
+        auto& frame = chunk.frames[chunk.size];
+        if (format == Format::Candump) {
+            if (scan::skipSpaces(begin, lineEnd) == lineEnd) {
+                continue;
+            }
+            const char* channel;
+            const char* channelEnd;
+            if (!parseCandumpLine(begin, lineEnd, frame, channel, channelEnd)) {
+                ++chunk.skipped;
+                continue;
+            }
+            frame.channel = channelIndex(chunk.channels, channel, channelEnd);
+            frame.transmitted = false;
+        } else {
+            if (!parseAscLine(begin, lineEnd, hex, frame)) {
+                // Only the header selects the number base
+                bool lineHex;
+                bool lineRelative;
+                if (!parseAscBase(begin, lineEnd, lineHex, lineRelative)) {
+                    ++chunk.skipped;
+                }
+                continue;
+            }
+            if (relative) {
+                chunk.elapsed += frame.timestamp;
+                frame.timestamp = chunk.elapsed;
+            }
+        }
+
+        // Logs tend to repeat the same message, keep its plan at hand
+        if (frame.dbcId() != id) {
+            id = frame.dbcId();
+            plan = decoder.plan(id);
+        }
+        chunk.plans[chunk.size] = plan;
+        if (plan != nullptr) {
+            chunk.signals[chunk.size].clear();
+            decoder.decode(
+                *plan, frame.data, frame.size, chunk.signals[chunk.size]);
+        }
+        ++chunk.size;
+    }
+}
+
+void ParallelLogDecoder::stitch(Chunk& chunk)
+{
+    channelMap.clear();
+    for (const auto& name : chunk.channels) {
+        channelMap.push_back(channelIndex(
+            channelNames, name.data(), name.data() + name.size()));
+    }
+
+    for (std::size_t i = 0; i < chunk.size; ++i) {
+        auto& frame = chunk.frames[i];
+        if (format == Format::Candump) {
+            frame.channel = channelMap[frame.channel];
+        } else if (relative) {
+            frame.timestamp += carry;
+        }
+        if (chunk.plans[i] != nullptr) {
+            ++decodedCount;
+        }
+    }
+
+    carry += chunk.elapsed;
+    frameCount += chunk.size;
+    lineCount += chunk.lines;
+    skippedCount += chunk.skipped;
+}
+
+} // namespace CANdb
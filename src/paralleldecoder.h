@@ -0,0 +1,134 @@
+#ifndef PARALLELDECODER_H_T2HC7YQE
+#define PARALLELDECODER_H_T2HC7YQE
+
+#include "canframe.h"
+#include "decoder.h"
+#include "mappedfile.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace CANdb {
+
+// Decodes a candump or ASC log file in parallel chunks. The file is memory
+// mapped and cut into chunks of about `chunkSize` bytes, each boundary is
+// moved to the start of the next line so every line belongs to exactly one
+// chunk. Worker threads parse and decode chunks ahead of the caller, which
+// receives the frames in file order.
+//
+// The ASC "base" header applies to the whole file, "base" lines after the
+// first frame are ignored. Relative ASC timestamps are summed per chunk and
+// carried from chunk to chunk as the chunks are handed out.
+struct ParallelLogDecoder {
+    enum class Format { Candump, Asc };
+
+    static const std::size_t DEFAULT_CHUNK{ 4 << 20 };
+
+    // With `threads` 0 the chunks are decoded on the calling thread. Throws
+    // std::runtime_error if the file can not be mapped.
+    ParallelLogDecoder(const std::string& path, Format format,
+        const Decoder& decoder, unsigned threads,
+        std::size_t chunkSize = DEFAULT_CHUNK);
+    ~ParallelLogDecoder();
+
+    ParallelLogDecoder(const ParallelLogDecoder&) = delete;
+    ParallelLogDecoder& operator=(const ParallelLogDecoder&) = delete;
+
+    // Decodes the whole file. The sink, void(const CANframe&,
+    // const MessagePlan&, const std::vector<DecodedSignal>&), is called on
+    // the calling thread for every frame of a message in the database.
+    template <typename Sink> void run(Sink sink);
+
+    // Candump channel names, indexed by CANframe::channel
+    const std::vector<std::string>& channels() const noexcept
+    {
+        return channelNames;
+    }
+
+    std::uint64_t frames() const noexcept { return frameCount; }
+    std::uint64_t decoded() const noexcept { return decodedCount; }
+    std::uint64_t lines() const noexcept { return lineCount; }
+    // Lines that are not a frame
+    std::uint64_t skipped() const noexcept { return skippedCount; }
+
+private:
+    struct Chunk {
+        std::vector<CANframe> frames;
+        // Null for frames of unknown messages
+        std::vector<const MessagePlan*> plans;
+        std::vector<std::vector<DecodedSignal>> signals;
+        std::size_t size;
+        // Candump channel names, CANframe::channel indexes this chunk's list
+        // until the chunk is handed out
+        std::vector<std::string> channels;
+        std::uint64_t lines;
+        std::uint64_t skipped;
+        // Sum of the relative ASC timestamps of the chunk
+        std::uint64_t elapsed;
+        std::size_t index;
+        bool ready;
+    };
+
+    void start();
+    void stop();
+    // Next chunk in file order, nullptr at the end of the file
+    Chunk* next();
+    void release(Chunk* chunk);
+    void work();
+    void parse(Chunk& chunk, std::size_t index) const;
+    void stitch(Chunk& chunk);
+    std::size_t boundary(std::size_t offset) const;
+
+    MappedFile file;
+    const Format format;
+    const Decoder& decoder;
+    const unsigned threads;
+    const std::size_t chunkSize;
+    const std::size_t chunkCount;
+    // ASC header settings
+    bool hex{ true };
+    bool relative{ false };
+
+    std::vector<Chunk> slots;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable changed;
+    // Chunks handed to the workers and to the caller
+    std::size_t assigned{ 0 };
+    std::size_t emitted{ 0 };
+    bool stopping{ false };
+
+    std::vector<std::string> channelNames;
+    std::vector<std::uint16_t> channelMap;
+    std::uint64_t carry{ 0 };
+    std::uint64_t frameCount{ 0 };
+    std::uint64_t decodedCount{ 0 };
+    std::uint64_t lineCount{ 0 };
+    std::uint64_t skippedCount{ 0 };
+};
+
+template <typename Sink> void ParallelLogDecoder::run(Sink sink)
+{
+    start();
+    try {
+        while (Chunk* chunk = next()) {
+            for (std::size_t i = 0; i < chunk->size; ++i) {
+                if (chunk->plans[i] != nullptr) {
+                    sink(chunk->frames[i], *chunk->plans[i],
+                        chunk->signals[i]);
+                }
+            }
+            release(chunk);
+        }
+    } catch (...) {
+        stop();
+        throw;
+    }
+    stop();
+}
+
+} // namespace CANdb
+
+#endif /* end of include guard: PARALLELDECODER_H_T2HC7YQE */
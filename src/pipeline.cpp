@@ -0,0 +1,295 @@
+#include "pipeline.h"
+
+#include <algorithm>
+
+namespace {
+
+// Spins shortly before yielding the core to the other stages
+struct Backoff {
+    unsigned spins{ 0 };
+
+    void operator()()
+    {
+        if (++spins > 64) {
+            std::this_thread::yield();
+        }
+    }
+};
+
+template <typename Queue, typename T>
+void push(Queue& queue, const T& value, std::atomic<std::uint64_t>& stalls)
+{
+    if (queue.push(value)) {
+        return;
+    }
+    stalls.fetch_add(1, std::memory_order_relaxed);
+    Backoff backoff;
+    while (!queue.push(value)) {
+        backoff();
+    }
+}
+
+template <typename Queue, typename T>
+void pop(Queue& queue, T& value, std::atomic<std::uint64_t>& stalls)
+{
+    if (queue.pop(value)) {
+        return;
+    }
+    stalls.fetch_add(1, std::memory_order_relaxed);
+    Backoff backoff;
+    while (!queue.pop(value)) {
+        backoff();
+    }
+}
+
+inline void add(std::atomic<std::uint64_t>& counter, std::uint64_t value)
+{
+    // Every counter has a single writer
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+        std::memory_order_relaxed);
+}
+
+inline void raise(std::atomic<std::size_t>& maximum, std::size_t value)
+{
+    if (value > maximum.load(std::memory_order_relaxed)) {
+        maximum.store(value, std::memory_order_relaxed);
+    }
+}
+
+CANdb::PipelineOptions sanitize(CANdb::PipelineOptions options)
+{
+    options.workers = std::max(options.workers, 1u);
+    options.batchSize = std::max<std::size_t>(options.batchSize, 1);
+    options.queueDepth = std::max<std::size_t>(options.queueDepth, 1);
+    return options;
+}
+
+} // namespace
+
+namespace CANdb {
+
+// A worker owns an input ring written by the reader and an output ring read
+// by the writer. A null batch marks the end of the input.
+struct DecodePipeline::Worker {
+    explicit Worker(std::size_t depth)
+        : input(depth)
+        , output(depth)
+    {
+    }
+
+    SpscRing<Batch*> input;
+    SpscRing<Batch*> output;
+    std::thread thread;
+};
+
+DecodePipeline::DecodePipeline(const Decoder& decoder, PipelineOptions options)
+    : decoder(decoder)
+    , options(sanitize(options))
+{
+    for (unsigned i = 0; i < this->options.workers; ++i) {
+        workers.emplace_back(new Worker(this->options.queueDepth));
+    }
+
+    // Enough batches to fill every queue, plus those being read, decoded
+    // and written
+    const auto batches
+        = this->options.workers * (2 * this->options.queueDepth + 1) + 2;
+    free.reset(new SpscRing<Batch*>(batches));
+    for (std::size_t i = 0; i < batches; ++i) {
+        std::unique_ptr<Batch> batch{ new Batch };
+        batch->frames.resize(this->options.batchSize);
+        batch->size = 0;
+        batch->plans.resize(this->options.batchSize);
+        batch->signals.resize(this->options.batchSize);
+        batch->order.resize(this->options.batchSize);
+        free->push(batch.get());
+        pool.push_back(std::move(batch));
+    }
+}
+
+DecodePipeline::~DecodePipeline() { stop(); }
+
+PipelineStats DecodePipeline::stats() const
+{
+    const auto stage = [](const Counter& counter) {
+        return PipelineStats::Stage{
+            counter.frames.load(std::memory_order_relaxed),
+            counter.batches.load(std::memory_order_relaxed),
+            counter.stalls.load(std::memory_order_relaxed)
+        };
+    };
+
+    PipelineStats stats{ stage(readerCounter), stage(decoderCounter),
+        stage(writerCounter), decoded.load(std::memory_order_relaxed), 0,
+        maxDecodeQueue.load(std::memory_order_relaxed), 0,
+        maxWriteQueue.load(std::memory_order_relaxed) };
+    if (stats.writer.batches != 0) {
+        stats.meanDecodeQueue
+            = static_cast<double>(decodeQueue.load(std::memory_order_relaxed))
+            / static_cast<double>(stats.writer.batches);
+        stats.meanWriteQueue
+            = static_cast<double>(writeQueue.load(std::memory_order_relaxed))
+            / static_cast<double>(stats.writer.batches);
+    }
+    return stats;
+}
+
+void DecodePipeline::start()
+{
+    for (auto* counter : { &readerCounter, &decoderCounter, &writerCounter }) {
+        counter->frames = 0;
+        counter->batches = 0;
+        counter->stalls = 0;
+    }
+    decoded = 0;
+    decodeQueue = 0;
+    writeQueue = 0;
+    maxDecodeQueue = 0;
+    maxWriteQueue = 0;
+    submitted = 0;
+    collected = 0;
+    cancelled = false;
+
+    for (auto& worker : workers) {
+        auto* self = worker.get();
+        worker->thread = std::thread([this, self] { work(*self); });
+    }
+}
+
+void DecodePipeline::stop()
+{
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+        // End markers of the workers the writer did not reach
+        Batch* batch;
+        while (worker->output.pop(batch)) {
+        }
+    }
+}
+
+DecodePipeline::Batch* DecodePipeline::acquire()
+{
+    Batch* batch;
+    if (cancelled.load(std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    if (free->pop(batch)) {
+        return batch;
+    }
+    readerCounter.stalls.fetch_add(1, std::memory_order_relaxed);
+    Backoff backoff;
+    while (!free->pop(batch)) {
+        if (cancelled.load(std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        backoff();
+    }
+    return batch;
+}
+
+void DecodePipeline::submit(Batch* batch)
+{
+    auto& worker = *workers[submitted++ % workers.size()];
+    add(readerCounter.frames, batch->size);
+    add(readerCounter.batches, 1);
+    push(worker.input, batch, readerCounter.stalls);
+}
+
+void DecodePipeline::finishInput()
+{
+    for (auto& worker : workers) {
+        push(worker->input, static_cast<Batch*>(nullptr),
+            readerCounter.stalls);
+    }
+}
+
+DecodePipeline::Batch* DecodePipeline::next()
+{
+    auto& worker = *workers[collected % workers.size()];
+    Batch* batch;
+    pop(worker.output, batch, writerCounter.stalls);
+    if (batch == nullptr) {
+        return nullptr;
+    }
+    ++collected;
+
+    std::size_t decodeQueued = 0;
+    std::size_t writeQueued = 0;
+    for (const auto& queue : workers) {
+        decodeQueued += queue->input.size();
+        writeQueued += queue->output.size();
+    }
+    add(decodeQueue, decodeQueued);
+    add(writeQueue, writeQueued);
+    raise(maxDecodeQueue, decodeQueued);
+    raise(maxWriteQueue, writeQueued);
+    return batch;
+}
+
+void DecodePipeline::release(Batch* batch)
+{
+    add(writerCounter.frames, batch->size);
+    add(writerCounter.batches, 1);
+    // The ring holds the whole pool, so there is always room
+    free->push(batch);
+}
+
+void DecodePipeline::cancel() { cancelled = true; }
+
+void DecodePipeline::work(Worker& worker)
+{
+    for (;;) {
+        Batch* batch;
+        pop(worker.input, batch, decoderCounter.stalls);
+        if (batch != nullptr) {
+            decode(*batch);
+            decoderCounter.frames.fetch_add(
+                batch->size, std::memory_order_relaxed);
+            decoderCounter.batches.fetch_add(1, std::memory_order_relaxed);
+        }
+        push(worker.output, batch, decoderCounter.stalls);
+        if (batch == nullptr) {
+            return;
+        }
+    }
+}
+
+void DecodePipeline::decode(Batch& batch)
+{
+    // Frames of other messages are dropped before sorting
+    const auto& filter = decoder.filter();
+    std::size_t relevant = 0;
+    for (std::size_t i = 0; i < batch.size; ++i) {
+        const auto& frame = batch.frames[i];
+        batch.plans[i] = nullptr;
+        batch.order[relevant]
+            = static_cast<std::uint64_t>(frame.dbcId()) << 32 | i;
+        relevant += filter.mayContain(frame) ? 1 : 0;
+    }
+    std::sort(batch.order.begin(), batch.order.begin() + relevant);
+
+    std::uint64_t count = 0;
+    const MessagePlan* plan = nullptr;
+    std::uint64_t id = ~std::uint64_t{ 0 };
+    for (std::size_t k = 0; k < relevant; ++k) {
+        const auto i = static_cast<std::size_t>(batch.order[k] & 0xFFFFFFFF);
+        if (batch.order[k] >> 32 != id) {
+            id = batch.order[k] >> 32;
+            plan = decoder.plan(static_cast<std::uint32_t>(id));
+        }
+        batch.plans[i] = plan;
+        if (plan != nullptr) {
+            const auto& frame = batch.frames[i];
+            batch.signals[i].clear();
+            decoder.decode(*plan, frame.data, frame.size, batch.signals[i]);
+            ++count;
+        }
+    }
+
+    // Workers share the decode counters
+    decoded.fetch_add(count, std::memory_order_relaxed);
+}
+
+} // namespace CANdb
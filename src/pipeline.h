@@ -0,0 +1,189 @@
+#ifndef PIPELINE_H_B6VN3RKT
+#define PIPELINE_H_B6VN3RKT
+
+#include "canframe.h"
+#include "decoder.h"
+#include "ringbuffer.h"
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+
+namespace CANdb {
+
+struct PipelineOptions {
+    // Decode worker threads, at least one
+    unsigned workers{ 2 };
+    // Frames per batch handed from stage to stage
+    std::size_t batchSize{ 4096 };
+    // Batches each queue between the stages holds before the previous stage
+    // has to wait
+    std::size_t queueDepth{ 8 };
+};
+
+struct PipelineStats {
+    struct Stage {
+        std::uint64_t frames;
+        std::uint64_t batches;
+        // Times the stage waited on a full or empty queue
+        std::uint64_t stalls;
+    };
+
+    Stage reader;
+    // All decode workers together
+    Stage decoder;
+    Stage writer;
+    // Frames with a message in the database
+    std::uint64_t decoded;
+    // Batches queued to and from the decode workers, sampled by the writer
+    // once per batch
+    double meanDecodeQueue;
+    std::size_t maxDecodeQueue;
+    double meanWriteQueue;
+    std::size_t maxWriteQueue;
+};
+
+// Decodes a stream of frames on a reader -> N decode workers -> writer
+// pipeline. The reader stage fills batches of frames from the source, the
+// workers decode them grouped by message id so each plan is looked up once
+// per batch, and the writer hands the frames to the sink in source order.
+// Stages are connected by bounded SPSC rings: batches are dealt round robin
+// to the workers, and the writer collects them in the same order.
+struct DecodePipeline {
+    explicit DecodePipeline(
+        const Decoder& decoder, PipelineOptions options = PipelineOptions{});
+    ~DecodePipeline();
+
+    DecodePipeline(const DecodePipeline&) = delete;
+    DecodePipeline& operator=(const DecodePipeline&) = delete;
+
+    // Runs the pipeline until `source` returns false. The source,
+    // bool(CANframe&), is called on a reader thread. The sink,
+    // void(const CANframe&, const MessagePlan&,
+    // const std::vector<DecodedSignal>&), is called on the calling thread for
+    // every frame of a message in the database. Exceptions of either are
+    // rethrown once the pipeline has stopped.
+    template <typename Source, typename Sink>
+    void run(Source source, Sink sink);
+
+    // Counters of the current or last run, callable from any thread
+    PipelineStats stats() const;
+
+    struct Batch {
+        std::vector<CANframe> frames;
+        std::size_t size;
+        // Null for frames of unknown messages
+        std::vector<const MessagePlan*> plans;
+        std::vector<std::vector<DecodedSignal>> signals;
+        // Message id << 32 | frame index of the frames passing the decoder's
+        // filter, sorted to group the frames
+        std::vector<std::uint64_t> order;
+    };
+
+private:
+    struct Worker;
+    struct Counter {
+        std::atomic<std::uint64_t> frames{ 0 };
+        std::atomic<std::uint64_t> batches{ 0 };
+        std::atomic<std::uint64_t> stalls{ 0 };
+    };
+
+    void start();
+    void stop();
+    // Reader side, acquire() returns nullptr once the run is cancelled
+    Batch* acquire();
+    void submit(Batch* batch);
+    void finishInput();
+    // Writer side, next() returns nullptr at the end of the input
+    Batch* next();
+    void release(Batch* batch);
+    void cancel();
+
+    void decode(Batch& batch);
+    void work(Worker& worker);
+
+    const Decoder& decoder;
+    const PipelineOptions options;
+    std::vector<std::unique_ptr<Batch>> pool;
+    // Batches returned by the writer to the reader
+    std::unique_ptr<SpscRing<Batch*>> free;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::uint64_t submitted{ 0 };
+    std::uint64_t collected{ 0 };
+    std::atomic<bool> cancelled{ false };
+
+    Counter readerCounter;
+    Counter decoderCounter;
+    Counter writerCounter;
+    std::atomic<std::uint64_t> decoded{ 0 };
+    std::atomic<std::uint64_t> decodeQueue{ 0 };
+    std::atomic<std::uint64_t> writeQueue{ 0 };
+    std::atomic<std::size_t> maxDecodeQueue{ 0 };
+    std::atomic<std::size_t> maxWriteQueue{ 0 };
+};
+
+template <typename Source, typename Sink>
+void DecodePipeline::run(Source source, Sink sink)
+{
+    start();
+
+    std::exception_ptr readError;
+    std::thread reader([this, &source, &readError] {
+        Batch* batch = nullptr;
+        try {
+            while ((batch = acquire()) != nullptr) {
+                batch->size = 0;
+                while (batch->size < options.batchSize
+                    && source(batch->frames[batch->size])) {
+                    ++batch->size;
+                }
+                const bool end = batch->size < options.batchSize;
+                submit(batch);
+                batch = nullptr;
+                if (end) {
+                    break;
+                }
+            }
+        } catch (...) {
+            readError = std::current_exception();
+            // The frames read so far are still written
+            if (batch != nullptr) {
+                submit(batch);
+            }
+        }
+        finishInput();
+    });
+
+    std::exception_ptr writeError;
+    while (Batch* batch = next()) {
+        if (!writeError) {
+            try {
+                for (std::size_t i = 0; i < batch->size; ++i) {
+                    if (batch->plans[i] != nullptr) {
+                        sink(batch->frames[i], *batch->plans[i],
+                            batch->signals[i]);
+                    }
+                }
+            } catch (...) {
+                // Stop reading and drain the batches in flight
+                writeError = std::current_exception();
+                cancel();
+            }
+        }
+        release(batch);
+    }
+
+    reader.join();
+    stop();
+    if (writeError) {
+        std::rethrow_exception(writeError);
+    }
+    if (readError) {
+        std::rethrow_exception(readError);
+    }
+}
+
+} // namespace CANdb
+
+#endif /* end of include guard: PIPELINE_H_B6VN3RKT */
@@ -0,0 +1,86 @@
+#ifndef RINGBUFFER_H_J5XQ2MWD
+#define RINGBUFFER_H_J5XQ2MWD
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace CANdb {
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+// The capacity is rounded up to a power of two. push() fails when the ring
+// is full and pop() when it is empty, waiting is left to the caller.
+template <typename T> struct SpscRing {
+    explicit SpscRing(std::size_t capacity)
+        : slots(roundUp(capacity))
+        , mask(slots.size() - 1)
+    {
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    bool push(const T& value)
+    {
+        const auto tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - headCache == slots.size()) {
+            headCache = head.load(std::memory_order_acquire);
+            if (tail - headCache == slots.size()) {
+                return false;
+            }
+        }
+        slots[tail & mask] = value;
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value)
+    {
+        const auto head = this->head.load(std::memory_order_relaxed);
+        if (head == tailCache) {
+            tailCache = tail.load(std::memory_order_acquire);
+            if (head == tailCache) {
+                return false;
+            }
+        }
+        value = slots[head & mask];
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate number of queued elements, callable from any thread
+    std::size_t size() const
+    {
+        const auto head = this->head.load(std::memory_order_acquire);
+        const auto tail = this->tail.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    std::size_t capacity() const noexcept { return slots.size(); }
+
+private:
+    static std::size_t roundUp(std::size_t capacity)
+    {
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    std::vector<T> slots;
+    const std::size_t mask;
+    // The producer and consumer indices live on separate cache lines, each
+    // next to the side's cached copy of the other index
+    char padding0[64];
+    std::atomic<std::size_t> tail{ 0 };
+    std::size_t headCache{ 0 };
+    char padding1[64];
+    std::atomic<std::size_t> head{ 0 };
+    std::size_t tailCache{ 0 };
+    char padding2[64];
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: RINGBUFFER_H_J5XQ2MWD */
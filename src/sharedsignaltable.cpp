@@ -0,0 +1,149 @@
+#include "sharedsignaltable.h"
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// "CANdbSHM", written last once the slots are initialized
+const std::uint64_t SEGMENT_MAGIC{ 0x4d4853626444414e };
+const std::uint32_t SEGMENT_VERSION{ 2 };
+
+// A cache line, the slots that follow stay line aligned
+struct Header {
+    std::atomic<std::uint64_t> magic;
+    std::uint32_t version;
+    std::uint32_t slotSize;
+    CANdb::Fingerprint schema;
+    std::uint64_t slots;
+    char padding[24];
+};
+static_assert(sizeof(Header) == 64, "The header must fill a cache line");
+
+std::runtime_error segmentError(const std::string& what)
+{
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+std::size_t segmentSize(std::size_t slots)
+{
+    return sizeof(Header) + slots * sizeof(CANdb::SignalSlot);
+}
+
+} // namespace
+
+namespace CANdb {
+
+Fingerprint signalSchemaHash(const CANdb_t& db)
+{
+    Hasher hash;
+    hash.add(db.messages.size());
+    for (const auto& message : db.messages) {
+        hash.add(message.first.id)
+            .addText(message.first.name)
+            .add(message.second.size());
+        for (const auto& signal : message.second) {
+            hash.addText(signal.signal_name)
+                .add(aspectsOf(signal).layout)
+                .addReal(signal.factor)
+                .addReal(signal.offset);
+        }
+    }
+    return hash.value();
+}
+
+SharedSignalWriter::SharedSignalWriter(
+    const std::string& name, const CANdb_t& db)
+    : SignalHandles(db)
+    , name(name)
+    , length(segmentSize(size()))
+{
+    // A segment left by a previous producer stays with the consumers that
+    // still map it, the new one never changes size under a live reader
+    shm_unlink(name.c_str());
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw segmentError("Failed to create shared memory " + name);
+    }
+    if (ftruncate(fd, static_cast<off_t>(length)) != 0) {
+        const auto error = segmentError("Failed to size shared memory " + name);
+        ::close(fd);
+        throw error;
+    }
+    mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw segmentError("Failed to map shared memory " + name);
+    }
+
+    // Readers see the zero filled segment as not ready until the magic is set
+    auto* header = new (mapping) Header;
+    header->magic.store(0, std::memory_order_relaxed);
+    header->version = SEGMENT_VERSION;
+    header->slotSize = sizeof(SignalSlot);
+    header->schema = signalSchemaHash(db);
+    header->slots = size();
+    slots = reinterpret_cast<SignalSlot*>(header + 1);
+    for (std::size_t i = 0; i < size(); ++i) {
+        new (slots + i) SignalSlot;
+    }
+    header->magic.store(SEGMENT_MAGIC, std::memory_order_release);
+}
+
+SharedSignalWriter::~SharedSignalWriter()
+{
+    munmap(mapping, length);
+    shm_unlink(name.c_str());
+}
+
+SharedSignalReader::SharedSignalReader(
+    const std::string& name, const CANdb_t& db)
+    : SignalHandles(db)
+    , length(segmentSize(size()))
+{
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw segmentError("Failed to open shared memory " + name);
+    }
+    // The writer sizes the segment after creating it
+    struct stat status;
+    if (fstat(fd, &status) != 0
+        || static_cast<std::size_t>(status.st_size) < sizeof(Header)) {
+        ::close(fd);
+        throw std::runtime_error("Shared memory " + name + " is not ready");
+    }
+    const auto mapped = static_cast<std::size_t>(status.st_size);
+    mapping = mmap(nullptr, mapped, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw segmentError("Failed to map shared memory " + name);
+    }
+
+    const auto* header = static_cast<const Header*>(mapping);
+    if (header->magic.load(std::memory_order_acquire) != SEGMENT_MAGIC) {
+        munmap(const_cast<void*>(mapping), mapped);
+        throw std::runtime_error("Shared memory " + name + " is not ready");
+    }
+    if (mapped != length || header->version != SEGMENT_VERSION
+        || header->slotSize != sizeof(SignalSlot)
+        || header->schema != signalSchemaHash(db) || header->slots != size()) {
+        munmap(const_cast<void*>(mapping), mapped);
+        throw std::runtime_error(
+            "Shared memory " + name + " has a different database");
+    }
+    slots = reinterpret_cast<const SignalSlot*>(header + 1);
+}
+
+SharedSignalReader::~SharedSignalReader()
+{
+    munmap(const_cast<void*>(mapping), length);
+}
+
+} // namespace CANdb
@@ -0,0 +1,72 @@
+#ifndef SHAREDSIGNALTABLE_H_R6MZ2QPD
+#define SHAREDSIGNALTABLE_H_R6MZ2QPD
+
+#include "fingerprint.h"
+#include "signalcache.h"
+
+namespace CANdb {
+
+// Fingerprint of the messages and signals of a database as far as they shape
+// a signal table: message ids and names, signal names, layouts and scaling
+Fingerprint signalSchemaHash(const CANdb_t& db);
+
+// Latest signal values published by one process in a POSIX shared memory
+// segment, for any number of consumer processes on the same machine. The
+// segment holds a header with the schema hash of the database, followed by
+// one SignalSlot per signal in handle order. POSIX only.
+struct SharedSignalWriter : SignalHandles {
+    // Creates the segment `name`, e.g. "/candb-can0", replacing an existing
+    // one whose consumers keep the old mapping. Throws std::runtime_error if
+    // the segment can not be set up.
+    SharedSignalWriter(const std::string& name, const CANdb_t& db);
+    // Removes the segment, consumers keep their mapping
+    ~SharedSignalWriter();
+
+    SharedSignalWriter(const SharedSignalWriter&) = delete;
+    SharedSignalWriter& operator=(const SharedSignalWriter&) = delete;
+
+    // Stores the decoded signals of a frame, from one thread only
+    void update(std::uint64_t timestamp, const MessagePlan& plan,
+        const std::vector<DecodedSignal>& signals)
+    {
+        store(slots, timestamp, plan, signals);
+    }
+    void update(std::uint32_t handle, std::uint64_t timestamp,
+        std::double_t value, std::uint64_t raw)
+    {
+        slots[handle].store(timestamp, value, raw);
+    }
+
+private:
+    const std::string name;
+    void* mapping{ nullptr };
+    std::size_t length{ 0 };
+    SignalSlot* slots{ nullptr };
+};
+
+// Read only view of a segment published by a SharedSignalWriter
+struct SharedSignalReader : SignalHandles {
+    // Throws std::runtime_error if the segment does not exist, is not ready
+    // yet, or was laid out for a different database
+    SharedSignalReader(const std::string& name, const CANdb_t& db);
+    ~SharedSignalReader();
+
+    SharedSignalReader(const SharedSignalReader&) = delete;
+    SharedSignalReader& operator=(const SharedSignalReader&) = delete;
+
+    // Copies the latest value of a signal, returns false if the signal has
+    // not been received yet. Callable from any thread.
+    bool read(std::uint32_t handle, SignalValue& value) const
+    {
+        return slots[handle].load(value);
+    }
+
+private:
+    const void* mapping{ nullptr };
+    std::size_t length{ 0 };
+    const SignalSlot* slots{ nullptr };
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: SHAREDSIGNALTABLE_H_R6MZ2QPD */
@@ -0,0 +1,131 @@
+#include "signalcache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace {
+
+const std::size_t CACHE_LINE{ 64 };
+static_assert(sizeof(CANdb::SignalSlot) == CACHE_LINE,
+    "Signal slots must fill a cache line");
+
+inline std::uint64_t bits(std::double_t value)
+{
+    std::uint64_t result;
+    std::memcpy(&result, &value, sizeof result);
+    return result;
+}
+
+inline std::double_t fromBits(std::uint64_t bits)
+{
+    std::double_t result;
+    std::memcpy(&result, &bits, sizeof result);
+    return result;
+}
+
+} // namespace
+
+namespace CANdb {
+
+const std::uint32_t SignalHandles::NO_HANDLE;
+
+void SignalSlot::store(std::uint64_t timestamp, std::double_t value,
+    std::uint64_t raw) noexcept
+{
+    // Only this thread writes, relaxed loads see its own stores
+    const auto sequence = this->sequence.load(std::memory_order_relaxed);
+    this->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    this->value.store(bits(value), std::memory_order_relaxed);
+    this->raw.store(raw, std::memory_order_relaxed);
+    this->timestamp.store(timestamp, std::memory_order_relaxed);
+    updates.store(
+        updates.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    this->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool SignalSlot::load(SignalValue& value) const noexcept
+{
+    for (;;) {
+        const auto before = sequence.load(std::memory_order_acquire);
+        if (before == 0) {
+            return false;
+        }
+        if ((before & 1) != 0) {
+            continue;
+        }
+        value.value = fromBits(this->value.load(std::memory_order_relaxed));
+        value.raw = raw.load(std::memory_order_relaxed);
+        value.timestamp = timestamp.load(std::memory_order_relaxed);
+        value.updates = updates.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+}
+
+SignalHandles::SignalHandles(const CANdb_t& db)
+{
+    for (const auto& message : db.messages) {
+        messages.insert(std::make_pair(
+            message.first.id, static_cast<std::uint32_t>(count)));
+        for (const auto& signal : message.second) {
+            names.insert(
+                std::make_pair(message.first.name + "." + signal.signal_name,
+                    static_cast<std::uint32_t>(count++)));
+        }
+    }
+}
+
+std::uint32_t SignalHandles::handle(const std::string& name) const
+{
+    const auto it = names.find(name);
+    if (it == names.end()) {
+        throw std::runtime_error("Unknown signal '" + name + "'");
+    }
+    return it->second;
+}
+
+std::uint32_t SignalHandles::handle(
+    const std::string& message, const std::string& signal) const
+{
+    return handle(message + "." + signal);
+}
+
+std::uint32_t SignalHandles::firstHandle(std::uint32_t id) const
+{
+    const auto it = messages.find(id);
+    return it != messages.end() ? it->second : NO_HANDLE;
+}
+
+void SignalHandles::store(SignalSlot* slots, std::uint64_t timestamp,
+    const MessagePlan& plan, const std::vector<DecodedSignal>& signals) const
+{
+    const auto first = firstHandle(plan.message->id);
+    if (first == NO_HANDLE) {
+        return;
+    }
+
+    const auto* base = plan.signals->data();
+    for (const auto& signal : signals) {
+        slots[first + static_cast<std::size_t>(signal.signal - base)].store(
+            timestamp, signal.value, signal.raw);
+    }
+}
+
+SignalCache::SignalCache(const Decoder& decoder)
+    : SignalHandles(decoder.db())
+    , storage(new char[size() * sizeof(SignalSlot) + CACHE_LINE - 1])
+{
+    const auto address
+        = reinterpret_cast<std::uintptr_t>(storage.get()) + CACHE_LINE - 1;
+    slots = reinterpret_cast<SignalSlot*>(address - address % CACHE_LINE);
+    for (std::size_t i = 0; i < size(); ++i) {
+        new (slots + i) SignalSlot;
+    }
+}
+
+} // namespace CANdb
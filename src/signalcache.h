@@ -0,0 +1,112 @@
+#ifndef SIGNALCACHE_H_K3PX9TWA
+#define SIGNALCACHE_H_K3PX9TWA
+
+#include "decoder.h"
+
+#include <atomic>
+#include <memory>
+
+namespace CANdb {
+
+// Snapshot of a signal slot
+struct SignalValue {
+    std::double_t value;
+    std::uint64_t raw;
+    // Timestamp of the frame that carried the value
+    std::uint64_t timestamp;
+    // Number of times the signal was received
+    std::uint64_t updates;
+};
+
+// Latest value of a signal guarded by a seqlock. The sequence number is odd
+// while the writer updates the slot, readers retry until they copied the
+// fields between two equal even sequence numbers. Fields are lock-free
+// atomics accessed relaxed and ordered by the sequence number, so slots also
+// work in memory shared between processes. Slots fill a cache line so that
+// neighbours written by the decoder do not slow down the readers of a slot.
+struct SignalSlot {
+    // Only one thread may store into a slot
+    void store(std::uint64_t timestamp, std::double_t value,
+        std::uint64_t raw) noexcept;
+    // Returns false if the slot has never been stored to
+    bool load(SignalValue& value) const noexcept;
+
+    std::atomic<std::uint64_t> sequence{ 0 };
+    std::atomic<std::uint64_t> value{ 0 };
+    std::atomic<std::uint64_t> raw{ 0 };
+    std::atomic<std::uint64_t> timestamp{ 0 };
+    std::atomic<std::uint64_t> updates{ 0 };
+    char padding[24];
+};
+
+// Handles of the signals of a database, the position of a signal in the
+// database: the signals of the first message, then those of the second one
+// and so on.
+struct SignalHandles {
+    static const std::uint32_t NO_HANDLE{ 0xFFFFFFFF };
+
+    explicit SignalHandles(const CANdb_t& db);
+
+    // Handle of a signal named "Message.Signal". Throws std::runtime_error
+    // if the signal is not part of the database.
+    std::uint32_t handle(const std::string& name) const;
+    std::uint32_t handle(
+        const std::string& message, const std::string& signal) const;
+    // First handle of a message's signals, NO_HANDLE for unknown messages
+    std::uint32_t firstHandle(std::uint32_t id) const;
+
+    // Number of signals, handles are below
+    std::size_t size() const noexcept { return count; }
+
+protected:
+    // Stores the decoded signals of a frame into slots[handle]
+    void store(SignalSlot* slots, std::uint64_t timestamp,
+        const MessagePlan& plan,
+        const std::vector<DecodedSignal>& signals) const;
+
+private:
+    std::size_t count{ 0 };
+    // Message id -> first handle
+    std::unordered_map<std::uint32_t, std::uint32_t> messages;
+    std::unordered_map<std::string, std::uint32_t> names;
+};
+
+// Latest value of every signal of a database, written by one decoding thread
+// and readable from any number of threads. The writer never waits for
+// readers, and readers never see a torn value.
+struct SignalCache : SignalHandles {
+    // One slot per signal of the decoder's database
+    explicit SignalCache(const Decoder& decoder);
+
+    SignalCache(const SignalCache&) = delete;
+    SignalCache& operator=(const SignalCache&) = delete;
+
+    // Writer thread: stores the decoded signals of a frame
+    void update(std::uint64_t timestamp, const MessagePlan& plan,
+        const std::vector<DecodedSignal>& signals)
+    {
+        store(slots, timestamp, plan, signals);
+    }
+    void update(std::uint32_t handle, std::uint64_t timestamp,
+        std::double_t value, std::uint64_t raw)
+    {
+        slots[handle].store(timestamp, value, raw);
+    }
+
+    // Any thread: copies the latest value of a signal, returns false if the
+    // signal has not been received yet
+    bool read(std::uint32_t handle, SignalValue& value) const
+    {
+        return slots[handle].load(value);
+    }
+
+private:
+    // Slots start on a cache line boundary within the storage, new does not
+    // align beyond alignof(std::max_align_t) before C++17
+    std::unique_ptr<char[]> storage;
+    SignalSlot* slots{ nullptr };
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: SIGNALCACHE_H_K3PX9TWA */
@@ -0,0 +1,282 @@
+#include "socketcan.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include <net/if.h>
+#include <unistd.h>
+
+namespace {
+
+// Ancillary data of a frame: hardware and software timestamps, kernel
+// timestamp fallback and the drop counter
+const std::size_t CONTROL_SIZE{ CMSG_SPACE(3 * sizeof(timespec))
+    + CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(std::uint32_t)) };
+
+// Large enough to ride out scheduling delays of the reading thread on a
+// saturated CAN FD bus
+const int RECEIVE_BUFFER{ 1 << 20 };
+
+// receive() checks for stop() this often while the bus is idle
+const long RECEIVE_TIMEOUT_US{ 100000 };
+
+std::runtime_error socketError(const std::string& what)
+{
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+inline std::uint64_t nanoseconds(const timespec& time)
+{
+    return static_cast<std::uint64_t>(time.tv_sec) * 1000000000u
+        + static_cast<std::uint64_t>(time.tv_nsec);
+}
+
+bool convert(const canfd_frame& raw, std::size_t length, CANdb::CANframe& frame)
+{
+    if ((length != CAN_MTU && length != CANFD_MTU)
+        || (raw.can_id & CAN_ERR_FLAG) != 0) {
+        return false;
+    }
+    frame.extended = (raw.can_id & CAN_EFF_FLAG) != 0;
+    frame.id = raw.can_id & (frame.extended ? CAN_EFF_MASK : CAN_SFF_MASK);
+    frame.remote = (raw.can_id & CAN_RTR_FLAG) != 0;
+    frame.fd = length == CANFD_MTU;
+    frame.size = std::min<std::uint8_t>(
+        raw.len, frame.fd ? CANFD_MAX_DLEN : CAN_MAX_DLEN);
+    std::memcpy(frame.data, raw.data, frame.size);
+    return true;
+}
+
+} // namespace
+
+namespace CANdb {
+
+std::vector<can_filter> socketCanFilters(const CANdb_t& db)
+{
+    std::vector<can_filter> filters;
+    if (db.messages.size() > CAN_RAW_FILTER_MAX) {
+        return filters;
+    }
+    // Remote and extended frames only pass filters asking for them
+    for (const auto& message : db.messages) {
+        const auto id = message.first.id;
+        can_filter filter;
+        if ((id & CAN_EXTENDED_ID_FLAG) != 0) {
+            filter.can_id = (id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+            filter.can_mask = CAN_EFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG;
+        } else {
+            filter.can_id = id & CAN_SFF_MASK;
+            filter.can_mask = CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG;
+        }
+        filters.push_back(filter);
+    }
+    return filters;
+}
+
+SocketCanSource::SocketCanSource(
+    const std::string& interface, const CANdb_t& db, std::size_t batch)
+    : fd(::socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC, CAN_RAW))
+{
+    if (fd < 0) {
+        throw socketError("Failed to open a SocketCAN socket");
+    }
+
+    try {
+        unsigned index = 0;
+        if (interface != "any") {
+            index = if_nametoindex(interface.c_str());
+            if (index == 0) {
+                throw socketError("Unknown CAN interface " + interface);
+            }
+        }
+
+        // Classic CAN only kernels keep the socket usable without CAN FD
+        const int enable = 1;
+        setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof enable);
+
+        const auto filters = socketCanFilters(db);
+        if (!filters.empty()
+            && setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, filters.data(),
+                   static_cast<socklen_t>(filters.size() * sizeof(can_filter)))
+                != 0) {
+            throw socketError("Failed to set the CAN filters");
+        }
+
+        sockaddr_can address;
+        std::memset(&address, 0, sizeof address);
+        address.can_family = AF_CAN;
+        address.can_ifindex = static_cast<int>(index);
+        if (bind(fd, reinterpret_cast<const sockaddr*>(&address),
+                sizeof address)
+            != 0) {
+            throw socketError("Failed to bind to " + interface);
+        }
+
+        setup(batch);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+}
+
+SocketCanSource::SocketCanSource(int socket, std::size_t batch)
+    : fd(socket)
+{
+    try {
+        setup(batch);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+}
+
+SocketCanSource::~SocketCanSource() { ::close(fd); }
+
+void SocketCanSource::setup(std::size_t batch)
+{
+    // Buffer size, timestamps and drop counters are best effort
+    setsockopt(
+        fd, SOL_SOCKET, SO_RCVBUF, &RECEIVE_BUFFER, sizeof RECEIVE_BUFFER);
+    const int timestamping = SOF_TIMESTAMPING_RX_HARDWARE
+        | SOF_TIMESTAMPING_RAW_HARDWARE | SOF_TIMESTAMPING_RX_SOFTWARE
+        | SOF_TIMESTAMPING_SOFTWARE;
+    const int enable = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &timestamping,
+            sizeof timestamping)
+        != 0) {
+        setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof enable);
+    }
+    setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof enable);
+
+    timeval timeout{ 0, RECEIVE_TIMEOUT_US };
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout)
+        != 0) {
+        throw socketError("Failed to set the receive timeout");
+    }
+
+    batch = std::max<std::size_t>(batch, 1);
+    buffers.resize(batch);
+    addresses.resize(batch);
+    controls.resize(batch * CONTROL_SIZE);
+    vectors.resize(batch);
+    messages.resize(batch);
+    pending.resize(batch);
+    for (std::size_t i = 0; i < batch; ++i) {
+        vectors[i].iov_base = &buffers[i];
+        vectors[i].iov_len = sizeof(canfd_frame);
+        std::memset(&messages[i], 0, sizeof(mmsghdr));
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
+std::size_t SocketCanSource::receive(CANframe* frames, std::size_t count)
+{
+    count = std::min(count, messages.size());
+    while (count != 0 && !closed && !stopped.load(std::memory_order_relaxed)) {
+        for (std::size_t i = 0; i < count; ++i) {
+            auto& header = messages[i].msg_hdr;
+            header.msg_name = &addresses[i];
+            header.msg_namelen = sizeof(sockaddr_can);
+            header.msg_control = &controls[i * CONTROL_SIZE];
+            header.msg_controllen = CONTROL_SIZE;
+            header.msg_flags = 0;
+        }
+
+        // Blocks for the first frame only, up to the receive timeout
+        const int read = recvmmsg(fd, messages.data(),
+            static_cast<unsigned>(count), MSG_WAITFORONE, nullptr);
+        if (read < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                continue;
+            }
+            throw socketError("Failed to receive CAN frames");
+        }
+
+        timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        std::size_t produced = 0;
+        for (int i = 0; i < read; ++i) {
+            auto& header = messages[i].msg_hdr;
+            // Only a closed socketpair delivers empty datagrams
+            if (messages[i].msg_len == 0) {
+                closed = true;
+                break;
+            }
+            ++receivedCount;
+
+            auto& frame = frames[produced];
+            if (!convert(buffers[i], messages[i].msg_len, frame)) {
+                ++skippedCount;
+                continue;
+            }
+            frame.channel = header.msg_namelen >= sizeof(sockaddr_can)
+                ? static_cast<std::uint16_t>(addresses[i].can_ifindex)
+                : 0;
+            // Set on frames sent from this host
+            frame.transmitted = (header.msg_flags & MSG_DONTROUTE) != 0;
+
+            frame.timestamp = 0;
+            for (auto* control = CMSG_FIRSTHDR(&header); control != nullptr;
+                 control = CMSG_NXTHDR(&header, control)) {
+                if (control->cmsg_level != SOL_SOCKET) {
+                    continue;
+                }
+                if (control->cmsg_type == SO_TIMESTAMPING) {
+                    timespec stamps[3];
+                    std::memcpy(stamps, CMSG_DATA(control), sizeof stamps);
+                    // Hardware time in the third entry, software in the first
+                    const auto hardware = nanoseconds(stamps[2]);
+                    frame.timestamp
+                        = hardware != 0 ? hardware : nanoseconds(stamps[0]);
+                } else if (control->cmsg_type == SO_TIMESTAMPNS) {
+                    timespec stamp;
+                    std::memcpy(&stamp, CMSG_DATA(control), sizeof stamp);
+                    frame.timestamp = nanoseconds(stamp);
+                } else if (control->cmsg_type == SO_RXQ_OVFL) {
+                    std::uint32_t drops;
+                    std::memcpy(&drops, CMSG_DATA(control), sizeof drops);
+                    droppedCount += drops - kernelDrops;
+                    kernelDrops = drops;
+                }
+            }
+            if (frame.timestamp == 0) {
+                frame.timestamp = nanoseconds(now);
+            }
+            ++produced;
+        }
+        if (produced != 0) {
+            return produced;
+        }
+    }
+    return 0;
+}
+
+bool SocketCanSource::next(CANframe& frame)
+{
+    if (position == available) {
+        position = 0;
+        available = receive(pending.data(), pending.size());
+        if (available == 0) {
+            return false;
+        }
+    }
+    frame = pending[position++];
+    return true;
+}
+
+std::string SocketCanSource::channelName(std::uint16_t channel)
+{
+    char name[IF_NAMESIZE];
+    if (channel != 0 && if_indextoname(channel, name) != nullptr) {
+        return name;
+    }
+    return std::to_string(channel);
+}
+
+} // namespace CANdb
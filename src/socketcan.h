@@ -0,0 +1,92 @@
+#ifndef SOCKETCAN_H_W8RD3FXK
+#define SOCKETCAN_H_W8RD3FXK
+
+#include "canframe.h"
+#include "cantypes.hpp"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <linux/can.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace CANdb {
+
+// Kernel side receive filters passing exactly the messages of the database.
+// Empty if the database has more messages than a socket accepts filters, the
+// socket then receives every frame.
+std::vector<can_filter> socketCanFilters(const CANdb_t& db);
+
+// Reads frames from a Linux SocketCAN raw socket, up to `batch` frames per
+// recvmmsg() call. Timestamps are taken from the hardware if the interface
+// provides them, from the kernel otherwise, and count nanoseconds since the
+// epoch. Frame channels are interface indexes. Linux only.
+struct SocketCanSource {
+    static const std::size_t DEFAULT_BATCH{ 64 };
+
+    // Opens a CAN FD raw socket on `interface`, or on every CAN interface
+    // for "any", and sets the receive filters from the messages of `db`.
+    // Throws std::runtime_error if the socket can not be set up.
+    SocketCanSource(const std::string& interface, const CANdb_t& db,
+        std::size_t batch = DEFAULT_BATCH);
+    // Reads struct can_frame and struct canfd_frame datagrams from a socket
+    // opened by the caller, e.g. one end of a socketpair. Takes ownership of
+    // the socket.
+    explicit SocketCanSource(int socket, std::size_t batch = DEFAULT_BATCH);
+    ~SocketCanSource();
+
+    SocketCanSource(const SocketCanSource&) = delete;
+    SocketCanSource& operator=(const SocketCanSource&) = delete;
+
+    // Waits for at least one frame and returns up to `count` frames without
+    // waiting for more. Returns 0 once the source is stopped or the peer of
+    // a socketpair is closed. Throws std::runtime_error on socket errors.
+    std::size_t receive(CANframe* frames, std::size_t count);
+
+    // Frame by frame view of receive(), returns false at the end
+    bool next(CANframe& frame);
+
+    // Ends receive() and next() within a receive timeout. Callable from any
+    // thread and from signal handlers.
+    void stop() noexcept { stopped.store(true, std::memory_order_relaxed); }
+
+    // Datagrams read, including error frames
+    std::uint64_t received() const noexcept { return receivedCount; }
+    // Error frames and datagrams that are not a CAN frame
+    std::uint64_t skipped() const noexcept { return skippedCount; }
+    // Frames dropped by the kernel because the receive buffer was full
+    std::uint64_t dropped() const noexcept { return droppedCount; }
+
+    // Name of the interface of a frame channel, its number if it has none
+    static std::string channelName(std::uint16_t channel);
+
+private:
+    void setup(std::size_t batch);
+
+    int fd{ -1 };
+    std::atomic<bool> stopped{ false };
+    bool closed{ false };
+
+    // recvmmsg() buffers, one entry per frame of a batch
+    std::vector<canfd_frame> buffers;
+    std::vector<sockaddr_can> addresses;
+    std::vector<char> controls;
+    std::vector<iovec> vectors;
+    std::vector<mmsghdr> messages;
+
+    std::vector<CANframe> pending;
+    std::size_t position{ 0 };
+    std::size_t available{ 0 };
+
+    std::uint64_t receivedCount{ 0 };
+    std::uint64_t skippedCount{ 0 };
+    std::uint64_t droppedCount{ 0 };
+    // Last kernel drop counter, it counts from the creation of the socket
+    std::uint32_t kernelDrops{ 0 };
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: SOCKETCAN_H_W8RD3FXK */
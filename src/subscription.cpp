@@ -0,0 +1,129 @@
+#include "subscription.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace CANdb {
+
+Subscription::Subscription(const CANdb_t& db)
+    : decoder(new Decoder(db))
+{
+}
+
+bool Subscription::decode(std::uint32_t id, const std::uint8_t* data,
+    std::size_t size, std::double_t* values)
+{
+    const auto it = routes.find(id);
+    if (it == routes.end()) {
+        return false;
+    }
+
+    const auto& route = it->second;
+    const auto* signals = route.plan->signals->data();
+    decoded.clear();
+    decoder->decode(*route.plan, data, size, decoded);
+    for (const auto& signal : decoded) {
+        const auto handle = route.handles[signal.signal - signals];
+        if (handle != NO_HANDLE) {
+            values[handle] = signal.value;
+        }
+    }
+    return true;
+}
+
+std::vector<std::uint32_t> Subscription::ids() const
+{
+    std::vector<std::uint32_t> result;
+    for (const auto& route : routes) {
+        result.push_back(route.first);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+SubscriptionBuilder::SubscriptionBuilder(const CANdb_t& db)
+    : can_db(db)
+{
+    for (const auto& message : can_db.messages) {
+        messages.insert(std::make_pair(message.first.name, &message.first));
+    }
+}
+
+std::uint32_t SubscriptionBuilder::subscribe(const std::string& name)
+{
+    const auto dot = name.find('.');
+    if (dot == std::string::npos) {
+        throw std::runtime_error(
+            "Signal name '" + name + "' is not of the form Message.Signal");
+    }
+    return subscribe(name.substr(0, dot), name.substr(dot + 1));
+}
+
+std::uint32_t SubscriptionBuilder::subscribe(
+    const std::string& message, const std::string& signal)
+{
+    const auto messageIt = messages.find(message);
+    if (messageIt == messages.end()) {
+        throw std::runtime_error("Unknown message '" + message + "'");
+    }
+
+    const auto& canSignals = can_db.messages.at(*messageIt->second);
+    const auto signalIt = std::find_if(canSignals.begin(), canSignals.end(),
+        [&signal](const CANsignal& s) { return s.signal_name == signal; });
+    if (signalIt == canSignals.end()) {
+        throw std::runtime_error(
+            "Unknown signal '" + signal + "' in message '" + message + "'");
+    }
+
+    const auto key = std::make_pair(messageIt->second->id,
+        static_cast<std::size_t>(signalIt - canSignals.begin()));
+    const auto inserted = signals.insert(
+        std::make_pair(key, static_cast<std::uint32_t>(signals.size())));
+    return inserted.first->second;
+}
+
+Subscription SubscriptionBuilder::build() const
+{
+    // Database of the subscribed signals, plus the multiplexors deciding
+    // whether they are present
+    CANdb_t db;
+    std::map<std::uint32_t, std::vector<std::uint32_t>> handles;
+    auto it = signals.begin();
+    while (it != signals.end()) {
+        const auto id = it->first.first;
+        const auto message = can_db.messages.find(CANmessage{ id });
+        const auto& canSignals = message->second;
+
+        std::vector<std::uint32_t> byIndex(
+            canSignals.size(), Subscription::NO_HANDLE);
+        bool muxed = false;
+        for (; it != signals.end() && it->first.first == id; ++it) {
+            byIndex[it->first.second] = it->second;
+            muxed |= canSignals[it->first.second].muxType
+                != CANsignalMuxType::NotMuxed;
+        }
+
+        auto& filtered = db.messages[message->first];
+        auto& messageHandles = handles[id];
+        for (std::size_t i = 0; i < canSignals.size(); ++i) {
+            const auto muxType = canSignals[i].muxType;
+            const bool muxer = muxType == CANsignalMuxType::Muxer
+                || muxType == CANsignalMuxType::MuxedMuxer;
+            if (byIndex[i] != Subscription::NO_HANDLE || (muxed && muxer)) {
+                filtered.push_back(canSignals[i]);
+                messageHandles.push_back(byIndex[i]);
+            }
+        }
+    }
+
+    Subscription subscription{ db };
+    subscription.handles = signals.size();
+    for (auto& message : handles) {
+        const auto* plan = subscription.decoder->plan(message.first);
+        subscription.routes.insert(std::make_pair(message.first,
+            Subscription::Route{ plan, std::move(message.second) }));
+    }
+    return subscription;
+}
+
+} // namespace CANdb
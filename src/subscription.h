@@ -0,0 +1,66 @@
+#ifndef SUBSCRIPTION_H_V8KD3NQS
+#define SUBSCRIPTION_H_V8KD3NQS
+
+#include "decoder.h"
+
+namespace CANdb {
+
+// Decoder restricted to a set of subscribed signals. Values are written to a
+// caller owned array indexed by the handles handed out by
+// SubscriptionBuilder.
+struct Subscription {
+    static const std::uint32_t NO_HANDLE{ 0xFFFFFFFF };
+
+    // Writes the subscribed signals present in a frame to values[handle].
+    // Returns false, after a single lookup, if the id has no subscribed
+    // signals.
+    bool decode(std::uint32_t id, const std::uint8_t* data, std::size_t size,
+        std::double_t* values);
+
+    // Number of handles, the size of the value array
+    std::size_t size() const noexcept { return handles; }
+
+    // Subscribed message ids
+    std::vector<std::uint32_t> ids() const;
+
+private:
+    friend struct SubscriptionBuilder;
+
+    struct Route {
+        const MessagePlan* plan;
+        // Signal index -> handle, NO_HANDLE for multiplexors only decoded
+        // to select the subscribed signals
+        std::vector<std::uint32_t> handles;
+    };
+
+    explicit Subscription(const CANdb_t& db);
+
+    std::unique_ptr<Decoder> decoder;
+    std::unordered_map<std::uint32_t, Route> routes;
+    std::size_t handles{ 0 };
+    std::vector<DecodedSignal> decoded;
+};
+
+struct SubscriptionBuilder {
+    explicit SubscriptionBuilder(const CANdb_t& db);
+
+    // Subscribes to a signal named "Message.Signal" and returns its handle.
+    // Subscribing twice returns the same handle. Throws std::runtime_error
+    // if the signal is not part of the database.
+    std::uint32_t subscribe(const std::string& name);
+    std::uint32_t subscribe(
+        const std::string& message, const std::string& signal);
+
+    // Compiles the subscribed messages and signals
+    Subscription build() const;
+
+private:
+    const CANdb_t& can_db;
+    std::unordered_map<std::string, const CANmessage*> messages;
+    // (message id, signal index) -> handle
+    std::map<std::pair<std::uint32_t, std::size_t>, std::uint32_t> signals;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: SUBSCRIPTION_H_V8KD3NQS */
@@ -0,0 +1,204 @@
+#include "validation.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)                                       \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CANDB_VALIDATION_SSE2
+#endif
+
+namespace {
+
+// Sets of up to this many values are compared against every value, larger
+// ones are binary searched
+const std::size_t SMALL_SET{ 16 };
+
+inline std::size_t popcount(std::uint64_t word)
+{
+    return std::bitset<64>(word).count();
+}
+
+inline std::uint64_t lowBits(std::size_t count)
+{
+    return count == 64 ? ~std::uint64_t{ 0 }
+                       : (std::uint64_t{ 1 } << count) - 1;
+}
+
+// Out of range bits of up to 64 values. Compares of NaN are false, so NaN is
+// out of range.
+std::uint64_t rangeWord(const std::double_t* values, std::size_t count,
+    std::double_t min, std::double_t max)
+{
+    std::uint64_t word = 0;
+    std::size_t i = 0;
+#ifdef CANDB_VALIDATION_SSE2
+    const auto low = _mm_set1_pd(min);
+    const auto high = _mm_set1_pd(max);
+    const auto inside = [low, high](const std::double_t* pair) {
+        const auto value = _mm_loadu_pd(pair);
+        return _mm_movemask_pd(_mm_and_pd(
+            _mm_cmpge_pd(value, low), _mm_cmple_pd(value, high)));
+    };
+    // Eight values per round keep the pipelines busy
+    for (; i + 8 <= count; i += 8) {
+        const auto bits = inside(values + i) | inside(values + i + 2) << 2
+            | inside(values + i + 4) << 4 | inside(values + i + 6) << 6;
+        word |= static_cast<std::uint64_t>(bits ^ 0xFF) << i;
+    }
+    for (; i + 2 <= count; i += 2) {
+        word |= static_cast<std::uint64_t>(inside(values + i) ^ 3) << i;
+    }
+#endif
+    for (; i < count; ++i) {
+        const bool inside = (values[i] >= min) & (values[i] <= max);
+        word |= static_cast<std::uint64_t>(!inside) << i;
+    }
+    return word;
+}
+
+// Bits of up to 64 values missing from a sorted set
+std::uint64_t membershipWord(const std::double_t* values, std::size_t count,
+    const std::double_t* allowed, std::size_t allowedCount)
+{
+    std::uint64_t found = 0;
+    if (allowedCount > SMALL_SET) {
+        for (std::size_t i = 0; i < count; ++i) {
+            found |= static_cast<std::uint64_t>(std::binary_search(
+                         allowed, allowed + allowedCount, values[i]))
+                << i;
+        }
+        return ~found & lowBits(count);
+    }
+
+    std::size_t i = 0;
+#ifdef CANDB_VALIDATION_SSE2
+    for (; i + 2 <= count; i += 2) {
+        const auto value = _mm_loadu_pd(values + i);
+        auto equal = _mm_setzero_pd();
+        for (std::size_t k = 0; k < allowedCount; ++k) {
+            equal = _mm_or_pd(
+                equal, _mm_cmpeq_pd(value, _mm_set1_pd(allowed[k])));
+        }
+        found |= static_cast<std::uint64_t>(_mm_movemask_pd(equal)) << i;
+    }
+#endif
+    for (; i < count; ++i) {
+        bool equal = false;
+        for (std::size_t k = 0; k < allowedCount; ++k) {
+            equal |= values[i] == allowed[k];
+        }
+        found |= static_cast<std::uint64_t>(equal) << i;
+    }
+    return ~found & lowBits(count);
+}
+
+template <typename Check>
+std::size_t checkWords(const std::double_t* values, std::size_t count,
+    std::uint64_t* violations, Check check)
+{
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count; i += 64) {
+        const auto word
+            = check(values + i, std::min<std::size_t>(64, count - i));
+        violations[i / 64] = word;
+        total += popcount(word);
+    }
+    return total;
+}
+
+} // namespace
+
+namespace CANdb {
+
+std::size_t checkRange(const std::double_t* values, std::size_t count,
+    std::double_t min, std::double_t max, std::uint64_t* violations)
+{
+    return checkWords(values, count, violations,
+        [min, max](const std::double_t* block, std::size_t size) {
+            return rangeWord(block, size, min, max);
+        });
+}
+
+std::size_t checkMembership(const std::double_t* values, std::size_t count,
+    const std::double_t* allowed, std::size_t allowedCount,
+    std::uint64_t* violations)
+{
+    return checkWords(values, count, violations,
+        [allowed, allowedCount](const std::double_t* block, std::size_t size) {
+            return membershipWord(block, size, allowed, allowedCount);
+        });
+}
+
+SignalValidator::SignalValidator(const MessagePlan& message, std::uint32_t plan)
+{
+    const auto& signalPlan = message.plans.at(plan);
+    checked = &(*message.signals)[signalPlan.index];
+    const bool integer = signalPlan.type == CANsignalType::SignedUnsignedInt;
+    // Half a raw step keeps bounds that are not exactly representable from
+    // failing the values rounded to them
+    const auto slack = integer ? std::abs(signalPlan.factor) / 2 : 0.0;
+
+    if (checked->min != checked->max) {
+        ranged = true;
+        min = std::min(checked->min, checked->max) - slack;
+        max = std::max(checked->min, checked->max) + slack;
+    }
+
+    const auto& descriptions = checked->valueDescriptions();
+    if (!integer || descriptions.empty()) {
+        return;
+    }
+    const auto physical = [&signalPlan](std::int64_t value) {
+        return toPhysical(
+            signalPlan, static_cast<std::uint64_t>(value) & signalPlan.mask);
+    };
+    // Descriptions are sorted by value
+    const auto first = descriptions.front().value;
+    const auto last = descriptions.back().value;
+    bool consecutive = true;
+    for (std::size_t i = 0; i < descriptions.size() && consecutive; ++i) {
+        consecutive = descriptions[i].value
+            == first + static_cast<std::int64_t>(i);
+    }
+    if (consecutive) {
+        described = true;
+        describedMin = std::min(physical(first), physical(last)) - slack;
+        describedMax = std::max(physical(first), physical(last)) + slack;
+        return;
+    }
+    for (const auto& description : descriptions) {
+        allowed.push_back(physical(description.value));
+    }
+    std::sort(allowed.begin(), allowed.end());
+    allowed.erase(std::unique(allowed.begin(), allowed.end()), allowed.end());
+}
+
+void SignalValidator::validate(const std::double_t* values, std::size_t count,
+    std::uint64_t* outOfRange, std::uint64_t* undescribed)
+{
+    valueCount += count;
+    const auto words = bitmapWords(count);
+    if (outOfRange != nullptr) {
+        if (ranged) {
+            outOfRangeCount += checkRange(values, count, min, max, outOfRange);
+        } else {
+            std::fill(outOfRange, outOfRange + words, 0);
+        }
+    }
+    if (undescribed != nullptr) {
+        if (described) {
+            undescribedCount += checkRange(
+                values, count, describedMin, describedMax, undescribed);
+        } else if (!allowed.empty()) {
+            undescribedCount += checkMembership(
+                values, count, allowed.data(), allowed.size(), undescribed);
+        } else {
+            std::fill(undescribed, undescribed + words, 0);
+        }
+    }
+}
+
+} // namespace CANdb
@@ -0,0 +1,63 @@
+#ifndef VALIDATION_H_R6JM4CXE
+#define VALIDATION_H_R6JM4CXE
+
+#include "decoder.h"
+
+namespace CANdb {
+
+// Violation bitmaps hold one bit per value, value i in bit i % 64 of word
+// i / 64. Bits past the last value are zero.
+inline std::size_t bitmapWords(std::size_t count) { return (count + 63) / 64; }
+
+// Marks the values outside [min, max] and NaN, returns their number. The
+// bitmap is overwritten.
+std::size_t checkRange(const std::double_t* values, std::size_t count,
+    std::double_t min, std::double_t max, std::uint64_t* violations);
+
+// Marks the values missing from the sorted set `allowed`, returns their
+// number. The bitmap is overwritten.
+std::size_t checkMembership(const std::double_t* values, std::size_t count,
+    const std::double_t* allowed, std::size_t allowedCount,
+    std::uint64_t* violations);
+
+// Checks columns of a signal decoded with decodeColumn() against the signal's
+// [min, max] range and, for integer signals with value descriptions, against
+// the described values. Ranges with min == max, which tools write for
+// unspecified ranges, are not checked. Counts the values checked and the
+// violations found.
+struct SignalValidator {
+    SignalValidator(const MessagePlan& message, std::uint32_t plan);
+
+    // Overwrites both bitmaps, either can be nullptr if its check is not
+    // needed
+    void validate(const std::double_t* values, std::size_t count,
+        std::uint64_t* outOfRange, std::uint64_t* undescribed);
+
+    bool checksRange() const noexcept { return ranged; }
+    bool checksValues() const noexcept { return described || !allowed.empty(); }
+
+    const CANsignal& signal() const noexcept { return *checked; }
+    std::uint64_t values() const noexcept { return valueCount; }
+    std::uint64_t outOfRange() const noexcept { return outOfRangeCount; }
+    std::uint64_t undescribed() const noexcept { return undescribedCount; }
+
+private:
+    const CANsignal* checked;
+    bool ranged{ false };
+    std::double_t min{ 0 };
+    std::double_t max{ 0 };
+    // Consecutive described raw values are checked as a range
+    bool described{ false };
+    std::double_t describedMin{ 0 };
+    std::double_t describedMax{ 0 };
+    // Sorted physical values of sparse value descriptions
+    std::vector<std::double_t> allowed;
+
+    std::uint64_t valueCount{ 0 };
+    std::uint64_t outOfRangeCount{ 0 };
+    std::uint64_t undescribedCount{ 0 };
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: VALIDATION_H_R6JM4CXE */
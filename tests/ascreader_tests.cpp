@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include "ascreader.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+bool parse(const std::string& line, CANdb::CANframe& frame, bool hex = true)
+{
+    return CANdb::parseAscLine(
+        line.data(), line.data() + line.size(), hex, frame);
+}
+
+std::FILE* logFile(const std::string& content)
+{
+    auto* file = std::tmpfile();
+    std::fwrite(content.data(), 1, content.size(), file);
+    std::rewind(file);
+    return file;
+}
+} // namespace
+
+TEST(AscReaderTests, classic_frames)
+{
+    CANdb::CANframe frame;
+    ASSERT_TRUE(parse("   0.010000 1  123             Rx   d 8 01 02 03 04 "
+                      "05 06 07 08  Length = 0 BitCount = 0 ID = 291",
+        frame));
+    EXPECT_EQ(frame.timestamp, 10000000u);
+    EXPECT_EQ(frame.channel, 1);
+    EXPECT_EQ(frame.id, 0x123u);
+    EXPECT_FALSE(frame.extended);
+    EXPECT_FALSE(frame.transmitted);
+    ASSERT_EQ(frame.size, 8);
+    EXPECT_EQ(frame.data[7], 8);
+
+    ASSERT_TRUE(parse("1.5 2 18FEF100x Tx d 2 FF 0a\r", frame));
+    EXPECT_EQ(frame.channel, 2);
+    EXPECT_TRUE(frame.extended);
+    EXPECT_TRUE(frame.transmitted);
+    EXPECT_EQ(frame.dbcId(), 0x98FEF100u);
+    EXPECT_EQ(frame.data[1], 0x0A);
+
+    ASSERT_TRUE(parse("2.0 1 291 Rx d 1 255", frame, false));
+    EXPECT_EQ(frame.id, 0x123u);
+    EXPECT_EQ(frame.data[0], 0xFF);
+
+    ASSERT_TRUE(parse("2.0 1 7FF Rx r", frame));
+    EXPECT_TRUE(frame.remote);
+    EXPECT_EQ(frame.size, 0);
+}
+
+TEST(AscReaderTests, fd_frames)
+{
+    CANdb::CANframe frame;
+    ASSERT_TRUE(parse("3.0 CANFD 1 Rx 123 EngineData 1 0 9 12 01 02 03 04 "
+                      "05 06 07 08 09 0A 0B 0C 130000 130 3000 1f0c 46500250 "
+                      "4b140250 20011736 2001040d",
+        frame));
+    EXPECT_TRUE(frame.fd);
+    EXPECT_EQ(frame.channel, 1);
+    EXPECT_EQ(frame.id, 0x123u);
+    ASSERT_EQ(frame.size, 12);
+    EXPECT_EQ(frame.data[11], 0x0C);
+
+    // Without symbolic name
+    ASSERT_TRUE(parse("3.1 CANFD 2 Tx 1ABx 0 0 2 2 AA BB", frame));
+    EXPECT_EQ(frame.channel, 2);
+    EXPECT_TRUE(frame.extended);
+    EXPECT_TRUE(frame.transmitted);
+    EXPECT_EQ(frame.size, 2);
+}
+
+TEST(AscReaderTests, other_lines)
+{
+    CANdb::CANframe frame;
+    EXPECT_FALSE(parse("", frame));
+    EXPECT_FALSE(parse("date Wed Jun 12 10:00:00 am 2019", frame));
+    EXPECT_FALSE(parse("   0.000000 Start of measurement", frame));
+    EXPECT_FALSE(parse("   0.100000 1  ErrorFrame", frame));
+    EXPECT_FALSE(parse("   0.200000 1  Statistic: D 0 R 0", frame));
+    EXPECT_FALSE(parse("0.3 1 123 Rx d 8 01 02", frame));
+}
+
+TEST(AscReaderTests, reader)
+{
+    const std::string log = "date Wed Jun 12 10:00:00 am 2019\n"
+                            "base dec  timestamps relative\n"
+                            "internal events logged\n"
+                            "Begin Triggerblock Wed Jun 12 10:00:00 am 2019\n"
+                            "   0.000000 Start of measurement\n"
+                            "   0.010000 1  291  Rx   d 1 1\n"
+                            "   0.010000 1  291  Rx   d 1 2\n"
+                            "   0.500000 2  256x Tx   d 1 3\n"
+                            "End TriggerBlock\n";
+
+    auto* file = logFile(log);
+    CANdb::AscReader reader{ file, 32 };
+    CANdb::CANframe frame;
+    std::vector<std::uint64_t> timestamps;
+    std::vector<std::uint8_t> values;
+    while (reader.next(frame)) {
+        timestamps.push_back(frame.timestamp);
+        values.push_back(frame.data[0]);
+    }
+    std::fclose(file);
+
+    EXPECT_FALSE(reader.hexBase());
+    EXPECT_TRUE(reader.relativeTimestamps());
+    EXPECT_EQ(timestamps,
+        (std::vector<std::uint64_t>{ 10000000, 20000000, 520000000 }));
+    EXPECT_EQ(values, (std::vector<std::uint8_t>{ 1, 2, 3 }));
+    EXPECT_EQ(frame.id, 256u);
+    EXPECT_TRUE(frame.extended);
+    // Lines longer than the buffer plus header and event lines
+    EXPECT_EQ(reader.skipped(), 5u);
+}
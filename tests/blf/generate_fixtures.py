@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Writes the BLF fixtures used by blfreader_tests.cpp.
+
+frames.blf      one object of every supported kind, uncompressed
+compressed.blf  1000 frames in small zlib containers, objects span containers
+oversized.blf   a zlib container stating an impossible size, then one frame
+"""
+
+import struct
+import zlib
+
+OBJECT_HEADER_BASE = struct.Struct("<4sHHLL")
+OBJECT_HEADER_V1 = struct.Struct("<LHHQ")
+
+CAN_MESSAGE = 1
+LOG_CONTAINER = 10
+APP_TEXT = 65
+CAN_MESSAGE2 = 86
+CAN_FD_MESSAGE = 100
+CAN_FD_MESSAGE_64 = 101
+
+TIME_TEN_MICS = 1
+TIME_ONE_NANS = 2
+EXTENDED = 0x80000000
+
+
+def lobj(object_type, body, timestamp=0, flags=TIME_ONE_NANS):
+    size = OBJECT_HEADER_BASE.size + OBJECT_HEADER_V1.size + len(body)
+    data = OBJECT_HEADER_BASE.pack(b"LOBJ", 32, 1, size, object_type)
+    data += OBJECT_HEADER_V1.pack(flags, 0, 0, timestamp) + body
+    return data + b"\0" * (size % 4)
+
+
+def can_message(channel, flags, can_id, data, timestamp, kind=CAN_MESSAGE):
+    body = struct.pack("<HBBL8s", channel, flags, len(data), can_id, data)
+    if kind == CAN_MESSAGE2:
+        body += struct.pack("<LBBH", 0, 0, 0, 0)
+    return lobj(kind, body, timestamp)
+
+
+def can_fd_message(channel, flags, fd_flags, can_id, data, timestamp):
+    body = struct.pack("<HBBLLBBB5x64s", channel, flags, 0, can_id, 0, 0,
+                       fd_flags, len(data), data)
+    return lobj(CAN_FD_MESSAGE, body, timestamp)
+
+
+def can_fd_message_64(channel, direction, flags, can_id, data, timestamp):
+    body = struct.pack("<BBBBLLLLLLLHBBL", channel, 0, len(data), 0, can_id,
+                       0, flags, 0, 0, 0, 0, 0, direction, 0, 0) + data
+    return lobj(CAN_FD_MESSAGE_64, body, timestamp)
+
+
+def container(data, compress, uncompressed=None):
+    payload = zlib.compress(data) if compress else data
+    size = OBJECT_HEADER_BASE.size + 16 + len(payload)
+    header = OBJECT_HEADER_BASE.pack(b"LOBJ", 16, 1, size, LOG_CONTAINER)
+    header += struct.pack("<H6xL4x", 2 if compress else 0,
+                          len(data) if uncompressed is None else uncompressed)
+    return header + payload + b"\0" * (size % 4)
+
+
+def blf(objects):
+    header = struct.pack("<4sL", b"LOGG", 144)
+    header += b"\0" * (144 - len(header))
+    return header + objects
+
+
+def frames():
+    objects = can_message(1, 0, 0x123, b"\x01\x02\x03", 100, CAN_MESSAGE)
+    # The TIME_TEN_MICS unit, 10 us ticks
+    objects = objects[:16] + struct.pack("<L", TIME_TEN_MICS) + objects[20:]
+
+    stream = can_message(2, 0x01, 0x18FEF100 | EXTENDED, bytes(range(8)),
+                         2000, CAN_MESSAGE2)
+    stream += lobj(APP_TEXT, b"comment\0")
+    stream += can_fd_message(1, 0, 0x1 | 0x2, 0x456, bytes(range(12)), 3000)
+    stream += can_fd_message_64(3, 1, 0x1000 | 0x2000, 0x1ABCDE | EXTENDED,
+                                bytes(range(64)), 4000)
+    stream += can_message(1, 0x80, 0x7FF, b"", 5000)
+    objects += container(stream, False)
+    return blf(objects)
+
+
+def compressed():
+    stream = b""
+    for i in range(1000):
+        data = struct.pack("<H", i)
+        if i % 3 == 0:
+            # Odd object sizes, so padding may cross containers as well
+            data += bytes(i % 13)
+            stream += can_fd_message_64(1, 0, 0x1000, i % 0x800, data, i)
+        else:
+            stream += can_message(1, 0, i % 0x800, data, i, CAN_MESSAGE2)
+
+    objects = b""
+    for offset in range(0, len(stream), 1001):
+        objects += container(stream[offset:offset + 1001], True)
+    return blf(objects)
+
+
+def oversized():
+    frame = can_message(1, 0, 0x100, b"\x01", 1, CAN_MESSAGE2)
+    objects = container(frame, True, 0xFFFFFFFF)
+    objects += container(frame, True)
+    return blf(objects)
+
+
+if __name__ == "__main__":
+    with open("frames.blf", "wb") as f:
+        f.write(frames())
+    with open("compressed.blf", "wb") as f:
+        f.write(compressed())
+    with open("oversized.blf", "wb") as f:
+        f.write(oversized())
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include "blfreader.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+namespace {
+std::vector<CANdb::CANframe> readAll(
+    const std::string& path, unsigned threads, std::uint64_t* skipped = nullptr)
+{
+    CANdb::BlfReader reader(BLF_DIR + path, threads);
+    std::vector<CANdb::CANframe> frames;
+    CANdb::CANframe frame;
+    while (reader.next(frame)) {
+        frames.push_back(frame);
+    }
+    if (skipped != nullptr) {
+        *skipped = reader.skipped();
+    }
+    return frames;
+}
+} // namespace
+
+TEST(BlfReaderTests, frame_objects)
+{
+    std::uint64_t skipped = 0;
+    const auto frames = readAll("frames.blf", 0, &skipped);
+    ASSERT_EQ(frames.size(), 5u);
+    // The text object is skipped
+    EXPECT_EQ(skipped, 1u);
+
+    // CAN_MESSAGE at the top level, 10 us timestamp
+    EXPECT_EQ(frames[0].timestamp, 1000000u);
+    EXPECT_EQ(frames[0].channel, 1);
+    EXPECT_EQ(frames[0].id, 0x123u);
+    EXPECT_FALSE(frames[0].extended);
+    EXPECT_FALSE(frames[0].fd);
+    ASSERT_EQ(frames[0].size, 3);
+    EXPECT_EQ(frames[0].data[2], 3);
+
+    // CAN_MESSAGE2 in an uncompressed container
+    EXPECT_EQ(frames[1].timestamp, 2000u);
+    EXPECT_EQ(frames[1].channel, 2);
+    EXPECT_TRUE(frames[1].extended);
+    EXPECT_TRUE(frames[1].transmitted);
+    EXPECT_EQ(frames[1].dbcId(), 0x98FEF100u);
+    ASSERT_EQ(frames[1].size, 8);
+    EXPECT_EQ(frames[1].data[7], 7);
+
+    // CAN_FD_MESSAGE
+    EXPECT_EQ(frames[2].id, 0x456u);
+    EXPECT_TRUE(frames[2].fd);
+    EXPECT_FALSE(frames[2].transmitted);
+    ASSERT_EQ(frames[2].size, 12);
+    EXPECT_EQ(frames[2].data[11], 11);
+
+    // CAN_FD_MESSAGE_64
+    EXPECT_EQ(frames[3].timestamp, 4000u);
+    EXPECT_EQ(frames[3].channel, 3);
+    EXPECT_EQ(frames[3].id, 0x1ABCDEu);
+    EXPECT_TRUE(frames[3].extended);
+    EXPECT_TRUE(frames[3].fd);
+    EXPECT_TRUE(frames[3].transmitted);
+    ASSERT_EQ(frames[3].size, 64);
+    EXPECT_EQ(frames[3].data[63], 63);
+
+    EXPECT_EQ(frames[4].id, 0x7FFu);
+    EXPECT_TRUE(frames[4].remote);
+    EXPECT_EQ(frames[4].size, 0);
+}
+
+TEST(BlfReaderTests, not_a_blf_file)
+{
+    EXPECT_THROW(CANdb::BlfReader(BLF_DIR "generate_fixtures.py"),
+        std::runtime_error);
+    EXPECT_THROW(
+        CANdb::BlfReader(BLF_DIR "missing.blf"), std::runtime_error);
+}
+
+#ifdef CANDB_WITH_ZLIB
+TEST(BlfReaderTests, compressed_containers)
+{
+    for (unsigned threads : { 0u, 1u, 3u }) {
+        std::uint64_t skipped = 1;
+        const auto frames = readAll("compressed.blf", threads, &skipped);
+        ASSERT_EQ(frames.size(), 1000u) << threads;
+        EXPECT_EQ(skipped, 0u);
+
+        for (unsigned i = 0; i < frames.size(); ++i) {
+            const auto& frame = frames[i];
+            ASSERT_EQ(frame.timestamp, i);
+            EXPECT_EQ(frame.id, i % 0x800);
+            EXPECT_EQ(frame.fd, i % 3 == 0);
+            EXPECT_EQ(frame.size, i % 3 == 0 ? 2 + i % 13 : 2);
+            EXPECT_EQ(frame.data[0] | frame.data[1] << 8, static_cast<int>(i));
+        }
+    }
+}
+
+TEST(BlfReaderTests, oversized_containers)
+{
+    for (unsigned threads : { 0u, 2u }) {
+        std::uint64_t skipped = 0;
+        const auto frames = readAll("oversized.blf", threads, &skipped);
+        ASSERT_EQ(frames.size(), 1u) << threads;
+        EXPECT_EQ(frames[0].id, 0x100u);
+        EXPECT_EQ(skipped, 1u);
+    }
+}
+#endif
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <spdlog/fmt/fmt.h>
+
+#include "candump.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+bool parse(const std::string& line, CANdb::CANframe& frame)
+{
+    const char* channel;
+    const char* channelEnd;
+    return CANdb::parseCandumpLine(line.data(), line.data() + line.size(),
+        frame, channel, channelEnd);
+}
+
+std::FILE* logFile(const std::string& content)
+{
+    auto* file = std::tmpfile();
+    std::fwrite(content.data(), 1, content.size(), file);
+    std::rewind(file);
+    return file;
+}
+} // namespace
+
+TEST(CandumpTests, classic_frames)
+{
+    CANdb::CANframe frame;
+    ASSERT_TRUE(parse("(1436509053.249713) can0 123#DEADBEEF", frame));
+    EXPECT_EQ(frame.timestamp, 1436509053249713000u);
+    EXPECT_EQ(frame.id, 0x123u);
+    EXPECT_FALSE(frame.extended);
+    EXPECT_FALSE(frame.fd);
+    ASSERT_EQ(frame.size, 4);
+    EXPECT_EQ(frame.data[0], 0xDE);
+    EXPECT_EQ(frame.data[3], 0xEF);
+    EXPECT_EQ(frame.dbcId(), 0x123u);
+
+    ASSERT_TRUE(parse("(0.5) vcan1 18FEF100#01.02.03\r", frame));
+    EXPECT_EQ(frame.timestamp, 500000000u);
+    EXPECT_TRUE(frame.extended);
+    EXPECT_EQ(frame.dbcId(), 0x98FEF100u);
+    EXPECT_EQ(frame.size, 3);
+
+    ASSERT_TRUE(parse("(1.0) can0 7FF#", frame));
+    EXPECT_EQ(frame.size, 0);
+
+    ASSERT_TRUE(parse("(1.0) can0 123#R4", frame));
+    EXPECT_TRUE(frame.remote);
+    EXPECT_EQ(frame.size, 4);
+}
+
+TEST(CandumpTests, fd_frames)
+{
+    CANdb::CANframe frame;
+    const std::string payload(128, 'A');
+    ASSERT_TRUE(parse("(1.0) can0 123##1" + payload, frame));
+    EXPECT_TRUE(frame.fd);
+    EXPECT_EQ(frame.size, 64);
+    EXPECT_EQ(frame.data[63], 0xAA);
+
+    EXPECT_FALSE(parse("(1.0) can0 123##1" + payload + "AA", frame));
+    EXPECT_FALSE(parse("(1.0) can0 123##", frame));
+}
+
+TEST(CandumpTests, malformed_lines)
+{
+    CANdb::CANframe frame;
+    EXPECT_FALSE(parse("", frame));
+    EXPECT_FALSE(parse("1.0 can0 123#00", frame));
+    EXPECT_FALSE(parse("(1.0) can0 123", frame));
+    EXPECT_FALSE(parse("(1.0) can0 123#0", frame));
+    EXPECT_FALSE(parse("(1.0) can0 123#0011223344556677AA", frame));
+    EXPECT_FALSE(parse("(1.0) can0 12G#00", frame));
+    // Error frame
+    EXPECT_FALSE(parse("(1.0) can0 20000004#0004000000000000", frame));
+}
+
+TEST(CandumpTests, reader_streams_through_small_buffer)
+{
+    std::string log;
+    for (int i = 0; i < 1000; ++i) {
+        log += fmt::format("({}.{:06}) can{} {:03X}#{:02X}\n", i, i, i % 2,
+            i % 0x800, i % 256);
+        if (i == 500) {
+            log += "garbage\n\n";
+            log += "(1.0) can0 123#" + std::string(200, '0') + "\n";
+        }
+    }
+    // Last line without a line break
+    log += "(2000.0) can2 001#FF";
+
+    auto* file = logFile(log);
+    CANdb::CandumpReader reader{ file, 64 };
+    CANdb::CANframe frame;
+    int frames = 0;
+    while (reader.next(frame)) {
+        if (frames < 1000) {
+            EXPECT_EQ(frame.id, static_cast<std::uint32_t>(frames % 0x800));
+            EXPECT_EQ(frame.data[0], frames % 256);
+            EXPECT_EQ(reader.channels()[frame.channel],
+                fmt::format("can{}", frames % 2));
+        }
+        ++frames;
+    }
+    std::fclose(file);
+
+    EXPECT_EQ(frames, 1001);
+    EXPECT_EQ(frame.data[0], 0xFF);
+    EXPECT_EQ(reader.channels().size(), 3u);
+    EXPECT_EQ(reader.skipped(), 2u);
+}
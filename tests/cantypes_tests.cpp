@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include "cantypes.hpp"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+TEST(CANsignalTests, fits_memory_budget)
+{
+    // The name and ten words for the layout, scaling, start value, interned
+    // unit and receivers and the optional fields, less than half of the
+    // former boost::optional members on 64 bit targets
+    EXPECT_LE(
+        sizeof(CANsignal), sizeof(std::string) + 11 * sizeof(std::double_t));
+}
+
+TEST(CANsignalTests, keeps_optional_fields)
+{
+    CANsignal signal{ "speed", 0, 16, CANsignalEndianness::LittleEndianIntel,
+        false, 0.1, 0, 0, 250, "km/h", { "ECU" }, CANsignalMuxType::Muxed, 3,
+        boost::any(12.5), std::string("Vehicle speed"), CANsignalType::Float,
+        CANvalueDescriptions_t{ { 0, "STOP" } },
+        CANmuxDependency{ "mux", { { 1, 3 } } } };
+
+    EXPECT_TRUE(signal.has(CANsignal::MUX_NDX));
+    EXPECT_EQ(signal.muxIndex(), 3);
+    EXPECT_DOUBLE_EQ(signal.startNumber(), 12.5);
+    EXPECT_FALSE(signal.has(CANsignal::START_TEXT));
+    EXPECT_EQ(signal.commentText(), "Vehicle speed");
+    EXPECT_EQ(signal.type(), CANsignalType::Float);
+    EXPECT_TRUE(signal.valueDescriptions()
+        == (CANvalueDescriptions_t{ { 0, "STOP" } }));
+    ASSERT_NE(signal.dependency(), nullptr);
+    EXPECT_EQ(signal.dependency()->muxSwitch, "mux");
+
+    // Migration shim
+    ASSERT_TRUE(signal.startValue());
+    EXPECT_DOUBLE_EQ(
+        boost::any_cast<std::double_t>(signal.startValue().get()), 12.5);
+    EXPECT_TRUE(signal.comment() == std::string("Vehicle speed"));
+    EXPECT_TRUE(signal.valueType() == CANsignalType::Float);
+    EXPECT_TRUE(signal.muxNdx() == std::uint16_t{ 3 });
+
+    signal.setStartValue(std::string("FAST"));
+    EXPECT_TRUE(signal.has(CANsignal::START_TEXT));
+    EXPECT_EQ(signal.startText(), "FAST");
+    EXPECT_EQ(boost::any_cast<std::string>(signal.startValue().get()), "FAST");
+}
+
+TEST(CANsignalTests, defaults_missing_fields)
+{
+    const CANsignal signal{ "raw", 0, 8, CANsignalEndianness::LittleEndianIntel,
+        false, 1, 0, 0, 255, "", {} };
+
+    EXPECT_FALSE(signal.has(CANsignal::MUX_NDX));
+    EXPECT_FALSE(signal.has(CANsignal::START_VALUE));
+    EXPECT_EQ(signal.type(), CANsignalType::SignedUnsignedInt);
+    EXPECT_TRUE(signal.valueDescriptions().empty());
+    EXPECT_EQ(signal.dependency(), nullptr);
+    EXPECT_FALSE(signal.startValue());
+    EXPECT_FALSE(signal.comment());
+    EXPECT_FALSE(signal.valueType());
+    EXPECT_EQ(signal.unit, "");
+}
+
+TEST(CANsignalTests, copies_share_metadata_until_written)
+{
+    CANsignal first{ "a", 0, 8, CANsignalEndianness::LittleEndianIntel, false,
+        1, 0, 0, 255, "V", {} };
+    first.setComment("first");
+    auto second = first;
+    second.setComment("second");
+
+    EXPECT_EQ(first.commentText(), "first");
+    EXPECT_EQ(second.commentText(), "second");
+    // Units and receivers are interned
+    EXPECT_TRUE(first.unit == second.unit);
+    EXPECT_TRUE(first.receivers == second.receivers);
+    EXPECT_EQ(&first.unit.get(), &CANstring("V").get());
+}
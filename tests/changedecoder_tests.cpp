@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include "changedecoder.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+std::vector<std::string> names(const std::vector<CANdb::DecodedSignal>& out)
+{
+    std::vector<std::string> result;
+    for (const auto& decoded : out) {
+        result.push_back(decoded.signal->signal_name);
+    }
+    return result;
+}
+} // namespace
+
+struct ChangeDecoderTests : public ::testing::Test {
+    ChangeDecoderTests()
+    {
+        db.messages[CANmessage{ 0x100, "STATUS", 8 }] = {
+            CANsignal{ "speed", 0, 16, CANsignalEndianness::LittleEndianIntel,
+                false, 0.1, 0, 0, 0, "", {} },
+            CANsignal{ "gear", 16, 4, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+            CANsignal{ "counter", 63, 4,
+                CANsignalEndianness::BigEndianMotorola, false, 1, 0, 0, 0, "",
+                {} },
+        };
+        db.messages[CANmessage{ 0x200, "MUXED", 8 }] = {
+            CANsignal{ "mux", 0, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {}, CANsignalMuxType::Muxer },
+            CANsignal{ "a", 8, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {}, CANsignalMuxType::Muxed, 0 },
+            CANsignal{ "b", 8, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {}, CANsignalMuxType::Muxed, 1 },
+            CANsignal{ "common", 16, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+        };
+        db.messages[CANmessage{ 0x300, "FD_STATUS", 64 }] = {
+            CANsignal{ "head", 0, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+            CANsignal{ "tail", 504, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+        };
+    }
+
+    CANdb_t db;
+};
+
+TEST_F(ChangeDecoderTests, repeated_payload_is_skipped)
+{
+    CANdb::ChangeDecoder decoder{ db };
+    std::vector<CANdb::DecodedSignal> out;
+
+    std::uint8_t payload[]{ 0x10, 0x00, 0x03, 0, 0, 0, 0, 0x10 };
+    ASSERT_TRUE(decoder.decode(0x100, payload, sizeof(payload), out));
+    EXPECT_EQ(out.size(), 3u);
+
+    out.clear();
+    ASSERT_TRUE(decoder.decode(0x100, payload, sizeof(payload), out));
+    EXPECT_TRUE(out.empty());
+
+    payload[7] = 0x20;
+    ASSERT_TRUE(decoder.decode(0x100, payload, sizeof(payload), out));
+    EXPECT_EQ(names(out), std::vector<std::string>{ "counter" });
+
+    // Bits outside of any signal do not emit anything
+    out.clear();
+    payload[4] = 0xFF;
+    ASSERT_TRUE(decoder.decode(0x100, payload, sizeof(payload), out));
+    EXPECT_TRUE(out.empty());
+
+    out.clear();
+    payload[1] = 0x01;
+    payload[2] = 0x04;
+    ASSERT_TRUE(decoder.decode(0x100, payload, sizeof(payload), out));
+    EXPECT_EQ(names(out), (std::vector<std::string>{ "speed", "gear" }));
+    EXPECT_DOUBLE_EQ(out[0].value, 0x110 * 0.1);
+
+    EXPECT_FALSE(decoder.decode(0x101, payload, sizeof(payload), out));
+}
+
+TEST_F(ChangeDecoderTests, length_change_and_reset_emit_everything)
+{
+    CANdb::ChangeDecoder decoder{ db };
+    std::vector<CANdb::DecodedSignal> out;
+
+    const std::uint8_t payload[]{ 1, 2, 3, 0, 0, 0, 0, 0 };
+    decoder.decode(0x100, payload, sizeof(payload), out);
+
+    out.clear();
+    decoder.decode(0x100, payload, 4, out);
+    EXPECT_EQ(names(out), (std::vector<std::string>{ "speed", "gear" }));
+
+    out.clear();
+    decoder.reset();
+    decoder.decode(0x100, payload, 4, out);
+    EXPECT_EQ(out.size(), 2u);
+}
+
+TEST_F(ChangeDecoderTests, multiplexor_change_emits_present_signals)
+{
+    CANdb::ChangeDecoder decoder{ db };
+    std::vector<CANdb::DecodedSignal> out;
+
+    std::uint8_t payload[]{ 0, 5, 7, 0, 0, 0, 0, 0 };
+    decoder.decode(0x200, payload, sizeof(payload), out);
+    EXPECT_EQ(out.size(), 3u);
+
+    // Same bits, but now they belong to another signal
+    out.clear();
+    payload[0] = 1;
+    decoder.decode(0x200, payload, sizeof(payload), out);
+    EXPECT_EQ(out.size(), 3u);
+
+    out.clear();
+    payload[2] = 8;
+    decoder.decode(0x200, payload, sizeof(payload), out);
+    EXPECT_EQ(names(out), std::vector<std::string>{ "common" });
+
+    // Only the signal of the selected branch is emitted for shared bits
+    out.clear();
+    payload[1] = 6;
+    decoder.decode(0x200, payload, sizeof(payload), out);
+    EXPECT_EQ(names(out), std::vector<std::string>{ "b" });
+    EXPECT_DOUBLE_EQ(out[0].value, 6);
+}
+
+TEST_F(ChangeDecoderTests, fd_payload)
+{
+    CANdb::ChangeDecoder decoder{ db };
+    std::vector<CANdb::DecodedSignal> out;
+
+    std::vector<std::uint8_t> payload(64, 0);
+    decoder.decode(0x300, payload.data(), payload.size(), out);
+    EXPECT_EQ(out.size(), 2u);
+
+    out.clear();
+    payload[63] = 1;
+    decoder.decode(0x300, payload.data(), payload.size(), out);
+    EXPECT_EQ(names(out), std::vector<std::string>{ "tail" });
+}
@@ -0,0 +1,260 @@
+#include <gtest/gtest.h>
+
+#include "columnarwriter.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+std::vector<std::uint8_t> readFile(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<std::uint8_t>(std::istreambuf_iterator<char>(in),
+        std::istreambuf_iterator<char>());
+}
+
+template <typename T>
+T load(const std::vector<std::uint8_t>& data, std::size_t at)
+{
+    T value;
+    std::memcpy(&value, &data[at], sizeof(value));
+    return value;
+}
+
+// Just enough flatbuffers to walk the Arrow footer and record batches
+struct Flat {
+    const std::vector<std::uint8_t>& data;
+    std::size_t base;
+
+    std::size_t deref(std::size_t at) const
+    {
+        return at + load<std::uint32_t>(data, at);
+    }
+
+    std::size_t field(std::size_t table, unsigned slot) const
+    {
+        const auto vtable = table - load<std::int32_t>(data, table);
+        if (4 + 2 * slot >= load<std::uint16_t>(data, vtable)) {
+            return 0;
+        }
+        const auto offset = load<std::uint16_t>(data, vtable + 4 + 2 * slot);
+        return offset != 0 ? table + offset : 0;
+    }
+
+    std::size_t root() const { return deref(base); }
+    std::size_t table(std::size_t table, unsigned slot) const
+    {
+        return deref(field(table, slot));
+    }
+
+    std::string string(std::size_t at) const
+    {
+        return std::string(reinterpret_cast<const char*>(&data[at + 4]),
+            load<std::uint32_t>(data, at));
+    }
+};
+
+struct Batch {
+    std::int64_t length;
+    std::vector<std::int64_t> nulls;
+    // Offset and length of the buffers in the file
+    std::vector<std::pair<std::size_t, std::size_t>> buffers;
+};
+
+struct ArrowFile {
+    std::vector<std::string> fields;
+    std::vector<std::string> units;
+    std::vector<Batch> batches;
+};
+
+ArrowFile readArrow(const std::vector<std::uint8_t>& data)
+{
+    ArrowFile file;
+    const auto size = data.size();
+    EXPECT_EQ(std::memcmp(data.data(), "ARROW1\0\0", 8), 0);
+    EXPECT_EQ(std::memcmp(&data[size - 6], "ARROW1", 6), 0);
+
+    const Flat footer{ data, size - 10 - load<std::int32_t>(data, size - 10) };
+    const auto schema = footer.table(footer.root(), 1);
+    const auto fields = footer.deref(footer.field(schema, 1));
+    for (std::uint32_t i = 0; i < load<std::uint32_t>(data, fields); ++i) {
+        const auto field = footer.deref(fields + 4 + 4 * i);
+        file.fields.push_back(footer.string(footer.table(field, 0)));
+        const auto metadata = footer.deref(footer.field(field, 6));
+        file.units.push_back(load<std::uint32_t>(data, metadata) != 0
+                ? footer.string(footer.table(footer.deref(metadata + 4), 1))
+                : "");
+    }
+
+    const auto blocks = footer.deref(footer.field(footer.root(), 3));
+    for (std::uint32_t i = 0; i < load<std::uint32_t>(data, blocks); ++i) {
+        const auto block = blocks + 4 + 24 * i;
+        const auto offset = load<std::int64_t>(data, block);
+        const auto metaDataLength = load<std::int32_t>(data, block + 8);
+        EXPECT_EQ(load<std::uint32_t>(data, offset), 0xFFFFFFFFu);
+
+        const Flat message{ data, static_cast<std::size_t>(offset + 8) };
+        const auto header = message.table(message.root(), 2);
+        Batch batch;
+        batch.length = load<std::int64_t>(data, message.field(header, 0));
+        const auto nodes = message.deref(message.field(header, 1));
+        for (std::uint32_t n = 0; n < load<std::uint32_t>(data, nodes); ++n) {
+            const auto nullCount = nodes + 12 + 16 * n;
+            batch.nulls.push_back(load<std::int64_t>(data, nullCount));
+        }
+        const auto buffers = message.deref(message.field(header, 2));
+        const auto body = offset + metaDataLength;
+        for (std::uint32_t b = 0; b < load<std::uint32_t>(data, buffers);
+             ++b) {
+            batch.buffers.emplace_back(
+                body + load<std::int64_t>(data, buffers + 4 + 16 * b),
+                load<std::int64_t>(data, buffers + 12 + 16 * b));
+        }
+        file.batches.push_back(batch);
+    }
+    return file;
+}
+} // namespace
+
+struct ColumnarWriterTests : public ::testing::Test {
+    ColumnarWriterTests()
+        : decoder(db())
+        , prefix("columnarwriter_tests_")
+    {
+    }
+
+    ~ColumnarWriterTests()
+    {
+        std::remove((prefix + "STATUS.arrow").c_str());
+        std::remove((prefix + "MUXED.arrow").c_str());
+    }
+
+    const CANdb_t& db()
+    {
+        database.messages[CANmessage{ 0x100, "STATUS", 8 }] = {
+            CANsignal{ "speed", 0, 16, CANsignalEndianness::LittleEndianIntel,
+                false, 0.1, 0, 0, 0, "km/h", {} },
+            CANsignal{ "temperature", 16, 8,
+                CANsignalEndianness::LittleEndianIntel, true, 1, 0, 0, 0,
+                "degC", {} },
+        };
+        database.messages[CANmessage{ 0x200, "MUXED", 8 }] = {
+            CANsignal{ "mux", 0, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {}, CANsignalMuxType::Muxer },
+            CANsignal{ "a", 8, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {}, CANsignalMuxType::Muxed, 0 },
+            CANsignal{ "b", 8, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {}, CANsignalMuxType::Muxed, 1 },
+        };
+        return database;
+    }
+
+    void append(CANdb::ColumnarWriter& writer, std::uint64_t timestamp,
+        std::uint32_t id, std::vector<std::uint8_t> payload)
+    {
+        payload.resize(8);
+        const auto* plan = decoder.plan(id);
+        ASSERT_NE(plan, nullptr);
+        std::vector<CANdb::DecodedSignal> out;
+        decoder.decode(*plan, payload.data(), payload.size(), out);
+        writer.append(timestamp, *plan, out);
+    }
+
+    CANdb_t database;
+    CANdb::Decoder decoder;
+    std::string prefix;
+};
+
+TEST_F(ColumnarWriterTests, signal_columns)
+{
+    CANdb::ColumnarWriter writer{ prefix, 2 };
+    append(writer, 1000, 0x100, { 0x10, 0x00, 0xFE });
+    append(writer, 2000, 0x100, { 0x20, 0x00, 0x05 });
+    append(writer, 3000, 0x100, { 0x30, 0x00, 0x80 });
+    writer.finish();
+
+    const auto data = readFile(prefix + "STATUS.arrow");
+    EXPECT_EQ(data.size(), writer.bytes());
+    const auto file = readArrow(data);
+    EXPECT_EQ(file.fields,
+        (std::vector<std::string>{ "timestamp", "speed", "temperature" }));
+    EXPECT_EQ(file.units, (std::vector<std::string>{ "", "km/h", "degC" }));
+
+    // Two rows, then the remaining row when finishing
+    ASSERT_EQ(file.batches.size(), 2u);
+    EXPECT_EQ(file.batches[0].length, 2);
+    EXPECT_EQ(file.batches[1].length, 1);
+
+    const auto& batch = file.batches[0];
+    ASSERT_EQ(batch.buffers.size(), 6u);
+    EXPECT_EQ(batch.nulls, (std::vector<std::int64_t>{ 0, 0, 0 }));
+    // No validity bitmaps without nulls
+    EXPECT_EQ(batch.buffers[2].second, 0u);
+    EXPECT_EQ(load<std::uint64_t>(data, batch.buffers[1].first + 8), 2000u);
+    EXPECT_DOUBLE_EQ(load<double>(data, batch.buffers[3].first + 8), 3.2);
+    EXPECT_EQ(load<std::int64_t>(data, batch.buffers[5].first), -2);
+    EXPECT_EQ(load<std::int64_t>(data, file.batches[1].buffers[5].first),
+        -128);
+}
+
+TEST_F(ColumnarWriterTests, multiplexed_signals_are_nullable)
+{
+    {
+        CANdb::ColumnarWriter writer{ prefix };
+        append(writer, 1, 0x200, { 0, 7 });
+        append(writer, 2, 0x200, { 1, 8 });
+        append(writer, 3, 0x200, { 1, 9 });
+    }
+
+    const auto data = readFile(prefix + "MUXED.arrow");
+    const auto file = readArrow(data);
+    ASSERT_EQ(file.batches.size(), 1u);
+    const auto& batch = file.batches[0];
+    EXPECT_EQ(batch.nulls, (std::vector<std::int64_t>{ 0, 0, 2, 1 }));
+
+    // Validity of "a" and "b"
+    ASSERT_EQ(batch.buffers[4].second, 1u);
+    EXPECT_EQ(data[batch.buffers[4].first], 0x01);
+    EXPECT_EQ(data[batch.buffers[6].first], 0x06);
+    EXPECT_EQ(load<std::uint64_t>(data, batch.buffers[7].first + 16), 9u);
+}
+
+TEST_F(ColumnarWriterTests, files_are_created_per_message)
+{
+    {
+        CANdb::ColumnarWriter writer{ prefix };
+        append(writer, 1, 0x100, {});
+    }
+    EXPECT_FALSE(readFile(prefix + "STATUS.arrow").empty());
+    EXPECT_TRUE(readFile(prefix + "MUXED.arrow").empty());
+
+    CANdb::ColumnarWriter writer{ "/nonexistent/" };
+    EXPECT_THROW(append(writer, 1, 0x100, {}), std::runtime_error);
+}
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include "cyclemonitor.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+#include <vector>
+
+namespace {
+const std::uint64_t MS{ 1000000 };
+
+CANmessage message(std::uint32_t id, std::uint32_t cycleTime)
+{
+    return CANmessage{ id, "M" + std::to_string(id), 8, {}, cycleTime };
+}
+} // namespace
+
+struct CycleMonitorTests : public ::testing::Test {
+    CANdb::CycleMonitor::Handler record()
+    {
+        return [this](const CANdb::CycleEvent& event) {
+            events.push_back(event);
+        };
+    }
+
+    CANdb_t db;
+    std::vector<CANdb::CycleEvent> events;
+};
+
+TEST_F(CycleMonitorTests, monitors_messages_with_a_cycle_time)
+{
+    db.messages[message(0x100, 10)] = {};
+    db.messages[message(0x200, 0)] = {};
+    db.messages[CANmessage{ 0x300, "Default", 8 }] = {};
+    CANdb::CycleMonitor withoutDefault{ db, record() };
+    EXPECT_EQ(withoutDefault.all().size(), 1u);
+    EXPECT_EQ(withoutDefault.stats(0x200), nullptr);
+    EXPECT_EQ(withoutDefault.stats(0x300), nullptr);
+
+    db.genMsgCycleTimeDefault = 100;
+    CANdb::CycleMonitor monitor{ db, record() };
+    ASSERT_EQ(monitor.all().size(), 2u);
+    ASSERT_NE(monitor.stats(0x300), nullptr);
+    EXPECT_EQ(monitor.stats(0x100)->period, 10 * MS);
+    EXPECT_EQ(monitor.stats(0x300)->period, 100 * MS);
+    EXPECT_EQ(monitor.stats(0x200), nullptr);
+}
+
+TEST_F(CycleMonitorTests, raises_late_too_fast_and_missing_events)
+{
+    db.messages[message(0x100, 10)] = {};
+    db.messages[message(0x200, 20)] = {};
+    CANdb::CycleMonitor monitor{ db, record() };
+
+    // 0x200 keeps the clock running while 0x100 misbehaves
+    const std::uint64_t frames[] = { 0, 10, 20, 32, 35, 45 };
+    for (const auto timestamp : frames) {
+        monitor.observe(0x100, timestamp * MS);
+    }
+    for (std::uint64_t timestamp = 0; timestamp <= 200; timestamp += 20) {
+        monitor.observe(0x200, timestamp * MS);
+    }
+    // Comes back after the missing event
+    monitor.observe(0x100, 210 * MS);
+
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0].kind, CANdb::CycleEvent::Kind::Late);
+    EXPECT_EQ(events[0].id, 0x100u);
+    EXPECT_EQ(events[0].timestamp, 32 * MS);
+    EXPECT_EQ(events[0].interval, 12 * MS);
+    EXPECT_EQ(events[1].kind, CANdb::CycleEvent::Kind::TooFast);
+    EXPECT_EQ(events[1].interval, 3 * MS);
+    // Three cycle times after the last frame
+    EXPECT_EQ(events[2].kind, CANdb::CycleEvent::Kind::Missing);
+    EXPECT_EQ(events[2].id, 0x100u);
+    EXPECT_EQ(events[2].timestamp, 75 * MS);
+    EXPECT_EQ(events[2].interval, 30 * MS);
+
+    const auto& stats = *monitor.stats(0x100);
+    EXPECT_EQ(stats.frames, 7u);
+    EXPECT_EQ(stats.intervals, 6u);
+    EXPECT_EQ(stats.late, 1u);
+    EXPECT_EQ(stats.tooFast, 1u);
+    EXPECT_EQ(stats.missing, 1u);
+    EXPECT_EQ(stats.minJitter, -7 * static_cast<std::int64_t>(MS));
+    EXPECT_EQ(stats.maxJitter, 155 * static_cast<std::int64_t>(MS));
+    EXPECT_EQ(stats.histogram[8], 3u);
+    EXPECT_EQ(stats.histogram[2], 1u);
+    EXPECT_EQ(stats.histogram[9], 1u);
+    EXPECT_EQ(stats.histogram[15], 1u);
+
+    const auto& regular = *monitor.stats(0x200);
+    EXPECT_EQ(regular.intervals, 10u);
+    EXPECT_EQ(regular.histogram[8], 10u);
+    EXPECT_EQ(regular.minJitter, 0);
+    EXPECT_EQ(regular.maxJitter, 0);
+}
+
+TEST_F(CycleMonitorTests, timeouts_cascade_down_the_wheel)
+{
+    // One second, a minute and an hour apart, on the first three levels
+    db.messages[message(0x100, 300)] = {};
+    db.messages[message(0x200, 20000)] = {};
+    db.messages[message(0x300, 1200000)] = {};
+    CANdb::CycleMonitor monitor{ db, record() };
+    for (std::uint32_t id : { 0x100, 0x200, 0x300 }) {
+        monitor.observe(id, 5 * MS);
+    }
+
+    for (std::uint64_t timestamp = 0; timestamp < 4000000; timestamp += 7) {
+        monitor.advance(timestamp * MS);
+    }
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0].id, 0x100u);
+    EXPECT_EQ(events[0].timestamp, 905 * MS);
+    EXPECT_EQ(events[1].id, 0x200u);
+    EXPECT_EQ(events[1].timestamp, 60005 * MS);
+    EXPECT_EQ(events[2].id, 0x300u);
+    EXPECT_EQ(events[2].timestamp, 3600005 * MS);
+
+    // A jump far ahead fires a timeout at its tick as well
+    monitor.observe(0x300, 4000000 * MS);
+    monitor.advance(100000000 * MS);
+    ASSERT_EQ(events.size(), 4u);
+    EXPECT_EQ(events[3].timestamp, 7600000 * MS);
+}
+
+TEST_F(CycleMonitorTests, tracks_ten_thousand_messages)
+{
+    // 10k messages every 500 ms are 20k frames per second
+    const std::uint32_t count = 10000;
+    for (std::uint32_t id = 0; id < count; ++id) {
+        db.messages[message(id, 500)] = {};
+    }
+    CANdb::CycleMonitor monitor{ db, record() };
+
+    // Ten seconds with a few percent of jitter, message 42 stops after five
+    for (std::uint64_t cycle = 0; cycle < 20; ++cycle) {
+        for (std::uint32_t id = 0; id < count; ++id) {
+            if (id == 42 && cycle >= 10) {
+                continue;
+            }
+            const auto offset = id * 50000 + (cycle * 7 + id) % 11 * MS;
+            monitor.observe(id, cycle * 500 * MS + offset);
+        }
+    }
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].kind, CANdb::CycleEvent::Kind::Missing);
+    EXPECT_EQ(events[0].id, 42u);
+
+    std::uint64_t intervals = 0;
+    for (const auto& stats : monitor.all()) {
+        intervals += stats.histogram[7] + stats.histogram[8];
+    }
+    EXPECT_EQ(intervals, (count - 1) * 19 + 9);
+
+    // Every message goes silent
+    monitor.advance(20000 * MS);
+    EXPECT_EQ(events.size(), count);
+}
@@ -180,7 +180,16 @@ BU_ :
     dbc += "\n";
     ASSERT_TRUE(parser.parse(dbc));
 
-    EXPECT_EQ(parser.getDb().val_tables.size(), values.size());
+    const auto db = parser.getDb();
+    ASSERT_EQ(db.val_tables.size(), values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const auto& table = db.val_tables[i];
+        EXPECT_EQ(table.identifier, values[i].substr(0, values[i].find(' ')));
+        EXPECT_TRUE(std::is_sorted(table.entries.begin(), table.entries.end(),
+            [](const CANvalueDescription& lhs, const CANvalueDescription& rhs) {
+                return lhs.value < rhs.value;
+            }));
+    }
 }
 
 TEST_F(MessageTests, messages)
@@ -280,6 +289,84 @@ BU_ :
     ASSERT_TRUE(parser.parse(dbc));
 }
 
+TEST_F(MessageTests, value_descriptions)
+{
+    std::string dbc =
+        R"(VERSION ""
+
+NS_ :
+  NS_DESC
+  NS_DESC2
+
+BU_ :
+  NEO
+  MCU
+  GTW
+
+VAL_TABLE_ GearTable 3 "DRIVE" 2 "NEUTRAL" 1 "REVERSE" 0 "PARK" ;
+
+)";
+    dbc += test_data::bo2;
+    dbc += R"(
+
+VAL_ 257 GTW_epasControlType 2 "TWO" -1 "INVALID" 0 "ZERO" ;
+VAL_ 257 GTW_epasPowerMode GearTable ;
+)";
+    ASSERT_TRUE(parser.parse(dbc));
+
+    const auto db = parser.getDb();
+    ASSERT_EQ(db.val_tables.size(), 1u);
+    EXPECT_EQ(db.val_tables[0].identifier, "GearTable");
+
+    const auto& signals = db.messages.at(CANmessage{ 257 });
+    auto signal = std::find(signals.begin(), signals.end(),
+        CANsignal{ "GTW_epasControlType", 0, 0,
+            CANsignalEndianness::LittleEndianIntel, false, 1, 0, 0, 0, "",
+            {} });
+    ASSERT_NE(signal, signals.end());
+    ASSERT_TRUE(signal->has(CANsignal::VALUE_DESCRIPTION));
+    EXPECT_TRUE(signal->valueDescriptions()
+        == (CANvalueDescriptions_t{
+               { -1, "INVALID" }, { 0, "ZERO" }, { 2, "TWO" } }));
+
+    signal = std::find(signals.begin(), signals.end(),
+        CANsignal{ "GTW_epasPowerMode", 0, 0,
+            CANsignalEndianness::LittleEndianIntel, false, 1, 0, 0, 0, "",
+            {} });
+    ASSERT_NE(signal, signals.end());
+    ASSERT_TRUE(signal->has(CANsignal::VALUE_DESCRIPTION));
+    EXPECT_TRUE(signal->valueDescriptions() == db.val_tables[0].entries);
+}
+
+TEST_F(MessageTests, fingerprint_of_redefined_message)
+{
+    std::string dbc =
+        R"(VERSION ""
+
+NS_ :
+  NS_DESC
+
+BU_ :
+  NEO
+
+)";
+    dbc += test_data::bo1;
+    dbc += "\n\n";
+    dbc += test_data::bo2;
+    // Keeps the fields of the first definition and takes the new signals
+    dbc += R"(
+
+BO_ 257 GTW_epasControl: 3 NEO
+  SG_ GTW_epasControlChecksum : 0|8@1+ (1,0) [0|255] "" NEO
+
+)";
+    ASSERT_TRUE(parser.parse(dbc));
+
+    const auto db = parser.getDb();
+    ASSERT_EQ(db.messages.at(CANmessage{ 257 }).size(), 1u);
+    EXPECT_EQ(parser.fingerprint().value(), CANdb::fingerprintOf(db));
+}
+
 // test case instantiations
 
 INSTANTIATE_TEST_CASE_P(Ecus, EcusTest,
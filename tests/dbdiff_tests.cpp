@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include "dbdiff.h"
+#include "log.hpp"
+#include "test_database.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+namespace {
+using test_data::signal;
+
+CANdb_t database()
+{
+    auto db = test_data::engineAndBrakes();
+    db.messages[CANmessage{ 0x300, "DOORS", 2, { "BCM" } }]
+        = { signal("open", 0) };
+    return db;
+}
+
+std::vector<std::string> fields(const CANdb::DbChange& change)
+{
+    return std::vector<std::string>(change.fields.begin(), change.fields.end());
+}
+} // namespace
+
+TEST(DbDiffTests, equal_databases)
+{
+    auto reordered = database();
+    for (auto& message : reordered.messages) {
+        std::reverse(message.second.begin(), message.second.end());
+    }
+    EXPECT_TRUE(CANdb::diffDatabases(database(), reordered).empty());
+}
+
+TEST(DbDiffTests, reports_changes)
+{
+    auto after = database();
+    after.messages.erase(CANmessage{ 0x300 });
+    after.messages[CANmessage{ 0x400, "LIGHTS", 1, { "BCM" } }]
+        = { signal("beam", 0) };
+
+    auto& engine = after.messages.at(CANmessage{ 0x100 });
+    engine.erase(engine.begin() + 1);
+    engine[0] = signal("speed", 0, 0.5);
+    engine[0].setComment("Engine speed");
+    engine.push_back(signal("torque", 24));
+    auto brakes = after.messages.at(CANmessage{ 0x200 });
+    after.messages.erase(CANmessage{ 0x200 });
+    after.messages[CANmessage{ 0x200, "BRAKES", 8, { "ABS" }, 20 }] = brakes;
+    after.messages.at(CANmessage{ 0x200 })[0].startBit = 8;
+
+    const auto changes = CANdb::diffDatabases(database(), after);
+    ASSERT_EQ(changes.size(), 7u);
+    using Kind = CANdb::DbChange::Kind;
+
+    EXPECT_EQ(changes[0].kind, Kind::Changed);
+    EXPECT_EQ(changes[0].signal, "speed");
+    EXPECT_EQ(changes[0].aspects, CANdb::SCALING | CANdb::COMMENT);
+    EXPECT_EQ(
+        fields(changes[0]), (std::vector<std::string>{ "factor", "comment" }));
+    EXPECT_EQ(changes[1].kind, Kind::Added);
+    EXPECT_EQ(changes[1].signal, "torque");
+    EXPECT_EQ(changes[2].kind, Kind::Removed);
+    EXPECT_EQ(changes[2].signal, "temp");
+
+    EXPECT_EQ(changes[3].kind, Kind::Changed);
+    EXPECT_EQ(changes[3].id, 0x200u);
+    EXPECT_TRUE(changes[3].signal.empty());
+    EXPECT_EQ(changes[3].aspects, CANdb::ATTRIBUTES);
+    EXPECT_EQ(fields(changes[3]), (std::vector<std::string>{ "cycleTime" }));
+    EXPECT_EQ(changes[4].signal, "pressure");
+    EXPECT_EQ(fields(changes[4]), (std::vector<std::string>{ "startBit" }));
+
+    EXPECT_EQ(changes[5].kind, Kind::Removed);
+    EXPECT_EQ(changes[5].message, "DOORS");
+    EXPECT_TRUE(changes[5].signal.empty());
+    EXPECT_EQ(changes[6].kind, Kind::Added);
+    EXPECT_EQ(changes[6].id, 0x400u);
+}
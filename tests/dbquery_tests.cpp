@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include "canframe.h"
+#include "dbquery.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+namespace {
+// Extended, as parsed from a DBC file
+const std::uint32_t SPEED_ID{ 0x18FEF100 | CANdb::CAN_EXTENDED_ID_FLAG };
+
+CANdb_t database()
+{
+    CANdb_t db;
+    db.messages[CANmessage{ 0x100, "ENGINE_DATA", 8, { "ECM" } }] = {
+        CANsignal{ "EngineSpeed", 0, 16, CANsignalEndianness::LittleEndianIntel,
+            false, 0.25, 0, 0, 16000, "rpm", {} },
+        CANsignal{ "EngineTemp", 16, 8, CANsignalEndianness::LittleEndianIntel,
+            false, 1, -40, -40, 215, "degC", {} },
+    };
+    db.messages[CANmessage{ 0x200, "ENGINE_STATUS", 8, { "ECM" } }] = {
+        CANsignal{ "Counter", 0, 4, CANsignalEndianness::LittleEndianIntel,
+            false, 1, 0, 0, 15, "", {} },
+    };
+    db.messages[CANmessage{ SPEED_ID, "VEHICLE_SPEED", 8, { "ABS" } }] = {
+        CANsignal{ "WheelSpeed", 0, 16, CANsignalEndianness::LittleEndianIntel,
+            false, 0.01, 0, 0, 655, "km/h", {} },
+        CANsignal{ "Counter", 16, 4, CANsignalEndianness::LittleEndianIntel,
+            false, 1, 0, 0, 15, "", {} },
+    };
+    return db;
+}
+
+std::vector<std::string> names(const std::vector<const CANmessage*>& messages)
+{
+    std::vector<std::string> found;
+    for (const auto* message : messages) {
+        found.push_back(message->name);
+    }
+    return found;
+}
+} // namespace
+
+TEST(DbQueryTests, matches_globs)
+{
+    EXPECT_TRUE(CANdb::globMatch("*", ""));
+    EXPECT_TRUE(CANdb::globMatch("Engine*", "EngineSpeed"));
+    EXPECT_TRUE(CANdb::globMatch("*Speed", "WheelSpeed"));
+    EXPECT_TRUE(CANdb::globMatch("E*g?ne*d", "EngineSpeed"));
+    EXPECT_FALSE(CANdb::globMatch("*Speed", "SpeedLimit"));
+    EXPECT_FALSE(CANdb::globMatch("Engine?", "Engine"));
+}
+
+TEST(DbQueryTests, finds_messages)
+{
+    const CANdb::DbQuery query{ database() };
+    EXPECT_EQ(query.messageCount(), 3u);
+    EXPECT_EQ(query.signalCount(), 5u);
+
+    ASSERT_NE(query.message(SPEED_ID), nullptr);
+    EXPECT_EQ(query.message(SPEED_ID)->name, "VEHICLE_SPEED");
+    EXPECT_EQ(query.message(0x18FEF100), nullptr);
+    EXPECT_EQ(query.message(0x300), nullptr);
+    EXPECT_EQ(query.signalsOf(*query.message(0x100)).size(), 2u);
+
+    EXPECT_EQ(names(query.messages("ENGINE_STATUS")),
+        (std::vector<std::string>{ "ENGINE_STATUS" }));
+    EXPECT_EQ(names(query.messages("ENGINE_*")),
+        (std::vector<std::string>{ "ENGINE_DATA", "ENGINE_STATUS" }));
+    EXPECT_EQ(names(query.messages("*SPEED")),
+        (std::vector<std::string>{ "VEHICLE_SPEED" }));
+    EXPECT_TRUE(query.messages("ENGINE").empty());
+
+    EXPECT_EQ(names(query.transmittedBy("ECM")),
+        (std::vector<std::string>{ "ENGINE_DATA", "ENGINE_STATUS" }));
+    EXPECT_TRUE(query.transmittedBy("BCM").empty());
+}
+
+TEST(DbQueryTests, finds_signals)
+{
+    const CANdb::DbQuery query{ database() };
+
+    const auto counters = query.signals("Counter");
+    ASSERT_EQ(counters.size(), 2u);
+    EXPECT_EQ(counters[0].message->id, 0x200u);
+    EXPECT_EQ(counters[1].message->id, SPEED_ID);
+
+    const auto speeds = query.signals("*Speed");
+    ASSERT_EQ(speeds.size(), 2u);
+    EXPECT_EQ(speeds[0].signal->signal_name, "EngineSpeed");
+    EXPECT_EQ(speeds[1].signal->signal_name, "WheelSpeed");
+
+    EXPECT_EQ(query.signals("Engine?emp").size(), 1u);
+    EXPECT_TRUE(query.signals("Wheel").empty());
+}
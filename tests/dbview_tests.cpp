@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include "dbview.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+TEST(DbViewTests, splits_signals_into_arrays)
+{
+    std::unique_ptr<const CANdb::DbView> view;
+    {
+        CANdb_t db;
+        db.messages[CANmessage{ 0x200, "B", 64 }] = {
+            CANsignal{ "mux", 0, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 255, "", {}, CANsignalMuxType::Muxer },
+            CANsignal{ "speed", 15, 16, CANsignalEndianness::BigEndianMotorola,
+                true, 0.5, -10, -100, 100, "km/h", {} },
+        };
+        db.messages[CANmessage{ 0x100, "A", 8 }] = {
+            CANsignal{ "counter", 4, 4, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 15, "", {} },
+        };
+        db.messages[CANmessage{ 0x300, "Empty", 0 }] = {};
+        view.reset(new CANdb::DbView{ db });
+    }
+
+    // Messages in id order, the view keeps its own copy of the database
+    ASSERT_EQ(view->messageCount(), 3u);
+    ASSERT_EQ(view->signalCount(), 3u);
+    EXPECT_EQ(view->messageIds(), (std::vector<std::uint32_t>{ 0x100, 0x200,
+                                      0x300 }));
+    EXPECT_EQ(view->lengths(), (std::vector<std::uint32_t>{ 8, 64, 0 }));
+    EXPECT_EQ(
+        view->firstSignals(), (std::vector<std::uint32_t>{ 0, 1, 3, 3 }));
+
+    EXPECT_EQ(view->startBits(), (std::vector<std::uint16_t>{ 4, 0, 15 }));
+    EXPECT_EQ(view->sizes(), (std::vector<std::uint16_t>{ 4, 8, 16 }));
+    EXPECT_EQ(view->flags(),
+        (std::vector<std::uint8_t>{ 0, CANdb::DbView::MULTIPLEXED,
+            CANdb::DbView::MOTOROLA | CANdb::DbView::SIGNED_VALUE }));
+    EXPECT_EQ(view->factors(), (std::vector<std::double_t>{ 1, 1, 0.5 }));
+    EXPECT_EQ(view->offsets(), (std::vector<std::double_t>{ 0, 0, -10 }));
+    EXPECT_EQ(view->minimums(), (std::vector<std::double_t>{ 0, 0, -100 }));
+    EXPECT_EQ(view->maximums(), (std::vector<std::double_t>{ 15, 255, 100 }));
+    EXPECT_EQ(
+        view->messageIndexes(), (std::vector<std::uint32_t>{ 0, 1, 1 }));
+
+    EXPECT_EQ(view->message(1).name, "B");
+    EXPECT_EQ(view->signal(2).signal_name, "speed");
+    EXPECT_EQ(view->signal(2).unit, "km/h");
+    EXPECT_EQ(view->db().messages.size(), 3u);
+}
@@ -0,0 +1,507 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <fstream>
+
+#include "dbcparser.h"
+#include "decoder.h"
+#include "log.hpp"
+
+std::string loadDBCFile(const std::string& filename)
+{
+    const std::string path = std::string{ EXTENDED_DBC_DIR } + filename;
+
+    std::fstream file{ path.c_str() };
+
+    std::string buff;
+    std::copy(std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>(), std::back_inserter(buff));
+
+    file.close();
+    return buff;
+}
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+using Values = std::map<std::string, std::double_t>;
+
+Values decode(const CANdb::Decoder& decoder, std::uint32_t id,
+    const std::vector<std::uint8_t>& payload)
+{
+    std::vector<CANdb::DecodedSignal> decoded;
+    EXPECT_TRUE(decoder.decode(id, payload.data(), payload.size(), decoded));
+
+    Values values;
+    for (const auto& signal : decoded) {
+        values[signal.signal->signal_name] = signal.value;
+    }
+    return values;
+}
+} // namespace
+
+struct DecoderTests : public ::testing::Test {
+    CANdb_t db;
+};
+
+TEST_F(DecoderTests, intel_and_motorola_layouts)
+{
+    db.messages[CANmessage{ 0x100, "LAYOUT", 8 }] = {
+        CANsignal{ "intel_u16", 0, 16, CANsignalEndianness::LittleEndianIntel,
+            false, 1, 0, 0, 0, "", {} },
+        CANsignal{ "intel_s7", 17, 7, CANsignalEndianness::LittleEndianIntel,
+            true, 1.5, 0, 0, 0, "", {} },
+        CANsignal{ "motorola_u12", 39, 12,
+            CANsignalEndianness::BigEndianMotorola, false, 0.5, -10, 0, 0, "",
+            {} },
+        CANsignal{ "motorola_s4", 63, 4, CANsignalEndianness::BigEndianMotorola,
+            true, 1, 0, 0, 0, "", {} },
+    };
+    CANdb::Decoder decoder{ db };
+
+    const auto values = decode(decoder, 0x100,
+        { 0x34, 0x12, 0xFE, 0x00, 0xAB, 0xC0, 0x00, 0xF0 });
+    EXPECT_DOUBLE_EQ(values.at("intel_u16"), 0x1234);
+    EXPECT_DOUBLE_EQ(values.at("intel_s7"), -1.5);
+    EXPECT_DOUBLE_EQ(values.at("motorola_u12"), 0xABC * 0.5 - 10);
+    EXPECT_DOUBLE_EQ(values.at("motorola_s4"), -1);
+}
+
+TEST_F(DecoderTests, unknown_id_and_short_payload)
+{
+    db.messages[CANmessage{ 0x10, "SHORT", 8 }] = {
+        CANsignal{ "first", 0, 8, CANsignalEndianness::LittleEndianIntel,
+            false, 1, 0, 0, 0, "", {} },
+        CANsignal{ "last", 56, 8, CANsignalEndianness::LittleEndianIntel,
+            false, 1, 0, 0, 0, "", {} },
+    };
+    CANdb::Decoder decoder{ db };
+
+    std::vector<CANdb::DecodedSignal> decoded;
+    const std::uint8_t payload[]{ 0x2A, 0x01 };
+    EXPECT_FALSE(decoder.decode(0x11, payload, sizeof(payload), decoded));
+    EXPECT_TRUE(decoded.empty());
+
+    ASSERT_TRUE(decoder.decode(0x10, payload, sizeof(payload), decoded));
+    ASSERT_EQ(decoded.size(), 1u);
+    EXPECT_EQ(decoded[0].signal->signal_name, "first");
+    EXPECT_EQ(decoded[0].raw, 0x2Au);
+}
+
+TEST_F(DecoderTests, simple_multiplexing)
+{
+    db.messages[CANmessage{ 200, "SENSOR_SONARS", 8 }] = {
+        CANsignal{ "mux", 0, 4, CANsignalEndianness::LittleEndianIntel, false,
+            1, 0, 0, 0, "", {}, CANsignalMuxType::Muxer },
+        CANsignal{ "err_count", 4, 12, CANsignalEndianness::LittleEndianIntel,
+            false, 1, 0, 0, 0, "", {} },
+        CANsignal{ "left", 16, 12, CANsignalEndianness::LittleEndianIntel,
+            false, 1, 0, 0, 0, "", {}, CANsignalMuxType::Muxed, 0 },
+        CANsignal{ "no_filt_left", 16, 12,
+            CANsignalEndianness::LittleEndianIntel, false, 1, 0, 0, 0, "", {},
+            CANsignalMuxType::Muxed, 1 },
+    };
+    CANdb::Decoder decoder{ db };
+
+    auto values = decode(decoder, 200, { 0x10, 0x00, 0x05, 0, 0, 0, 0, 0 });
+    EXPECT_EQ(values.size(), 3u);
+    EXPECT_EQ(values.count("left"), 1u);
+    EXPECT_DOUBLE_EQ(values.at("left"), 5);
+
+    values = decode(decoder, 200, { 0x11, 0x00, 0x07, 0, 0, 0, 0, 0 });
+    EXPECT_EQ(values.size(), 3u);
+    EXPECT_DOUBLE_EQ(values.at("no_filt_left"), 7);
+
+    values = decode(decoder, 200, { 0x12, 0x00, 0x07, 0, 0, 0, 0, 0 });
+    EXPECT_EQ(values.size(), 2u);
+    EXPECT_DOUBLE_EQ(values.at("err_count"), 1);
+}
+
+TEST_F(DecoderTests, nested_ranges)
+{
+    db.messages[CANmessage{ 300, "NESTED", 8 }] = {
+        CANsignal{ "root", 0, 8, CANsignalEndianness::LittleEndianIntel, false,
+            1, 0, 0, 0, "", {}, CANsignalMuxType::Muxer },
+        CANsignal{ "inner", 8, 8, CANsignalEndianness::LittleEndianIntel,
+            false, 1, 0, 0, 0, "", {}, CANsignalMuxType::MuxedMuxer, 1,
+            boost::none, boost::none, boost::none, boost::none,
+            CANmuxDependency{ "root", { { 1, 3 } } } },
+        CANsignal{ "leaf_a", 16, 8, CANsignalEndianness::LittleEndianIntel,
+            false, 1, 0, 0, 0, "", {}, CANsignalMuxType::Muxed, 0,
+            boost::none, boost::none, boost::none, boost::none,
+            CANmuxDependency{ "inner", { { 0, 9 }, { 1000, 1000 } } } },
+        CANsignal{ "leaf_b", 24, 8, CANsignalEndianness::LittleEndianIntel,
+            false, 1, 0, 0, 0, "", {}, CANsignalMuxType::Muxed, 5,
+            boost::none, boost::none, boost::none, boost::none,
+            CANmuxDependency{ "inner", { { 5, 20 } } } },
+    };
+    CANdb::Decoder decoder{ db };
+
+    auto values = decode(decoder, 300, { 2, 7, 0xAA, 0xBB, 0, 0, 0, 0 });
+    EXPECT_EQ(values.size(), 4u);
+    EXPECT_DOUBLE_EQ(values.at("leaf_a"), 0xAA);
+    EXPECT_DOUBLE_EQ(values.at("leaf_b"), 0xBB);
+
+    values = decode(decoder, 300, { 3, 12, 0xAA, 0xBB, 0, 0, 0, 0 });
+    EXPECT_EQ(values.size(), 3u);
+    EXPECT_EQ(values.count("leaf_a"), 0u);
+    EXPECT_DOUBLE_EQ(values.at("leaf_b"), 0xBB);
+
+    values = decode(decoder, 300, { 4, 7, 0xAA, 0xBB, 0, 0, 0, 0 });
+    EXPECT_EQ(values.size(), 1u);
+    EXPECT_EQ(values.count("inner"), 0u);
+}
+
+TEST_F(DecoderTests, value_labels)
+{
+    db.messages[CANmessage{ 0x200, "ENUMS", 8 }] = {
+        CANsignal{ "dense", 0, 8, CANsignalEndianness::LittleEndianIntel,
+            false, 1, 0, 0, 0, "", {}, CANsignalMuxType::NotMuxed, boost::none,
+            boost::none, boost::none, boost::none,
+            CANvalueDescriptions_t{ { 0, "OFF" }, { 1, "ON" }, { 3, "ERROR" } } },
+        CANsignal{ "sparse", 8, 16, CANsignalEndianness::LittleEndianIntel,
+            false, 1, 0, 0, 0, "", {}, CANsignalMuxType::NotMuxed, boost::none,
+            boost::none, boost::none, boost::none,
+            CANvalueDescriptions_t{ { 1, "LOW" }, { 40000, "HIGH" } } },
+        CANsignal{ "signed", 24, 4, CANsignalEndianness::LittleEndianIntel,
+            true, 1, 0, 0, 0, "", {}, CANsignalMuxType::NotMuxed, boost::none,
+            boost::none, boost::none, boost::none,
+            CANvalueDescriptions_t{ { -1, "SNA" } } },
+        CANsignal{ "plain", 28, 4, CANsignalEndianness::LittleEndianIntel,
+            false, 1, 0, 0, 0, "", {} },
+    };
+    CANdb::Decoder decoder{ db };
+
+    std::vector<CANdb::DecodedSignal> decoded;
+    const std::uint8_t payload[]{ 0x03, 0x40, 0x9C, 0x0F, 0, 0, 0, 0 };
+    ASSERT_TRUE(decoder.decode(0x200, payload, sizeof(payload), decoded));
+    ASSERT_EQ(decoded.size(), 4u);
+    ASSERT_NE(decoded[0].label(), nullptr);
+    EXPECT_EQ(*decoded[0].label(), "ERROR");
+    ASSERT_NE(decoded[1].label(), nullptr);
+    EXPECT_EQ(*decoded[1].label(), "HIGH");
+    ASSERT_NE(decoded[2].label(), nullptr);
+    EXPECT_EQ(*decoded[2].label(), "SNA");
+    EXPECT_EQ(decoded[3].label(), nullptr);
+
+    decoded.clear();
+    const std::uint8_t other[]{ 0x02, 0x02, 0x00, 0x07, 0, 0, 0, 0 };
+    ASSERT_TRUE(decoder.decode(0x200, other, sizeof(other), decoded));
+    EXPECT_EQ(decoded[0].label(), nullptr);
+    EXPECT_EQ(decoded[1].label(), nullptr);
+    EXPECT_EQ(decoded[2].label(), nullptr);
+}
+
+TEST_F(DecoderTests, value_labels_outlive_their_signal)
+{
+    const CANdb::ValueLabels none{ CANsignal{ "plain", 0, 8,
+        CANsignalEndianness::LittleEndianIntel, false, 1, 0, 0, 0, "", {} } };
+    EXPECT_EQ(none.find(0), nullptr);
+
+    const CANdb::ValueLabels labels{ CANsignal{ "state", 0, 8,
+        CANsignalEndianness::LittleEndianIntel, false, 1, 0, 0, 0, "", {},
+        CANsignalMuxType::NotMuxed, boost::none, boost::none, boost::none,
+        boost::none, CANvalueDescriptions_t{ { 0, "OFF" }, { 2, "ON" } } } };
+    ASSERT_NE(labels.find(2), nullptr);
+    EXPECT_EQ(*labels.find(2), "ON");
+    EXPECT_EQ(labels.find(1), nullptr);
+}
+
+TEST_F(DecoderTests, float_and_double_signals)
+{
+    db.messages[CANmessage{ 0x300, "FLOATS", 8 }] = {
+        CANsignal{ "intel_float", 3, 32, CANsignalEndianness::LittleEndianIntel,
+            true, 2, 1, 0, 0, "", {}, CANsignalMuxType::NotMuxed, boost::none,
+            boost::none, boost::none, CANsignalType::Float },
+    };
+    db.messages[CANmessage{ 0x302, "MOTOROLA_FLOATS", 8 }] = {
+        CANsignal{ "motorola_float", 20, 32,
+            CANsignalEndianness::BigEndianMotorola, true, 1, 0, 0, 0, "", {},
+            CANsignalMuxType::NotMuxed, boost::none, boost::none, boost::none,
+            CANsignalType::Float },
+    };
+    db.messages[CANmessage{ 0x301, "DOUBLES", 8 }] = {
+        CANsignal{ "intel_double", 0, 64, CANsignalEndianness::LittleEndianIntel,
+            true, 1, 0, 0, 0, "", {}, CANsignalMuxType::NotMuxed, boost::none,
+            boost::none, boost::none, CANsignalType::Double },
+    };
+    CANdb::Decoder decoder{ db };
+
+    std::uint8_t payload[8]{};
+    ASSERT_TRUE(decoder.encode(0x300, "intel_float", 7.5, payload, 8));
+
+    // 3.25f == 0x40500000, shifted three bits up in Intel order
+    std::uint64_t word = 0;
+    for (int i = 7; i >= 0; --i) {
+        word = (word << 8) | payload[i];
+    }
+    EXPECT_EQ((word >> 3) & 0xFFFFFFFF, 0x40500000u);
+
+    auto values = decode(decoder, 0x300,
+        std::vector<std::uint8_t>(payload, payload + sizeof(payload)));
+    EXPECT_DOUBLE_EQ(values.at("intel_float"), 7.5);
+
+    // -0.15625f == 0xBE200000, MSB at bit 20 of the sawtooth numbering
+    std::uint8_t motorola[8]{};
+    ASSERT_TRUE(decoder.encode(0x302, "motorola_float", -0.15625, motorola, 8));
+    const std::uint8_t expectedMotorola[8]{ 0x00, 0x00, 0x17, 0xC4, 0x00,
+        0x00, 0x00, 0x00 };
+    EXPECT_EQ(std::memcmp(motorola, expectedMotorola, 8), 0);
+    values = decode(decoder, 0x302,
+        std::vector<std::uint8_t>(motorola, motorola + sizeof(motorola)));
+    EXPECT_DOUBLE_EQ(values.at("motorola_float"), -0.15625);
+
+    std::uint8_t doublePayload[8]{};
+    ASSERT_TRUE(decoder.encode(0x301, "intel_double", 1e300, doublePayload, 8));
+    std::double_t expected = 1e300;
+    EXPECT_EQ(std::memcmp(doublePayload, &expected, sizeof(expected)), 0);
+    values = decode(decoder, 0x301,
+        std::vector<std::uint8_t>(doublePayload, doublePayload + 8));
+    EXPECT_DOUBLE_EQ(values.at("intel_double"), 1e300);
+}
+
+TEST_F(DecoderTests, zero_factor_floats_encode_zero)
+{
+    db.messages[CANmessage{ 0x303, "ZERO_FLOAT", 8 }] = {
+        CANsignal{ "float", 0, 32, CANsignalEndianness::LittleEndianIntel, true,
+            0, 1, 0, 0, "", {}, CANsignalMuxType::NotMuxed, boost::none,
+            boost::none, boost::none, CANsignalType::Float },
+    };
+    db.messages[CANmessage{ 0x304, "ZERO_DOUBLE", 8 }] = {
+        CANsignal{ "double", 0, 64, CANsignalEndianness::LittleEndianIntel,
+            true, 0, 1, 0, 0, "", {}, CANsignalMuxType::NotMuxed, boost::none,
+            boost::none, boost::none, CANsignalType::Double },
+    };
+    CANdb::Decoder decoder{ db };
+
+    // Like integer signals, no inf or NaN bit patterns for a factor of 0
+    const std::uint8_t zeros[8]{};
+    std::uint8_t payload[8];
+    std::memset(payload, 0xFF, sizeof(payload));
+    ASSERT_TRUE(decoder.encode(0x303, "float", 5, payload, 8));
+    EXPECT_EQ(std::memcmp(payload, zeros, 4), 0);
+    std::memset(payload, 0xFF, sizeof(payload));
+    ASSERT_TRUE(decoder.encode(0x304, "double", 1, payload, 8));
+    EXPECT_EQ(std::memcmp(payload, zeros, 8), 0);
+}
+
+TEST_F(DecoderTests, integer_encoding_saturates)
+{
+    db.messages[CANmessage{ 0x400, "INTEGERS", 2 }] = {
+        CANsignal{ "unsigned", 0, 4, CANsignalEndianness::LittleEndianIntel,
+            false, 0.5, 0, 0, 0, "", {} },
+        CANsignal{ "signed", 15, 8, CANsignalEndianness::BigEndianMotorola,
+            true, 1, -10, 0, 0, "", {} },
+    };
+    CANdb::Decoder decoder{ db };
+
+    std::uint8_t payload[2]{ 0xF0, 0x00 };
+    ASSERT_TRUE(decoder.encode(0x400, "unsigned", 3.4, payload, 2));
+    ASSERT_TRUE(decoder.encode(0x400, "signed", -200, payload, 2));
+    EXPECT_EQ(payload[0], 0xF7);
+    EXPECT_EQ(payload[1], 0x80);
+
+    ASSERT_TRUE(decoder.encode(0x400, "unsigned", 100, payload, 2));
+    ASSERT_TRUE(decoder.encode(0x400, "signed", -12, payload, 2));
+    EXPECT_EQ(payload[0], 0xFF);
+    EXPECT_EQ(payload[1], 0xFE);
+
+    EXPECT_FALSE(decoder.encode(0x400, "missing", 1, payload, 2));
+    EXPECT_FALSE(decoder.encode(0x400, "signed", 1, payload, 1));
+}
+
+TEST_F(DecoderTests, column_round_trip)
+{
+    db.messages[CANmessage{ 0x500, "COLUMNS", 8 }] = {
+        CANsignal{ "float", 12, 32, CANsignalEndianness::BigEndianMotorola,
+            true, 1, 0, 0, 0, "", {}, CANsignalMuxType::NotMuxed, boost::none,
+            boost::none, boost::none, CANsignalType::Float },
+        CANsignal{ "integer", 48, 12, CANsignalEndianness::LittleEndianIntel,
+            true, 0.25, 0, 0, 0, "", {} },
+    };
+    CANdb::Decoder decoder{ db };
+    const auto* plan = decoder.plan(0x500);
+    ASSERT_NE(plan, nullptr);
+    ASSERT_EQ(plan->plans.size(), 2u);
+
+    const std::size_t stride = 16;
+    const std::size_t count = 100;
+    std::vector<std::uint8_t> payloads(stride * count, 0);
+    std::vector<std::double_t> floats, integers;
+    for (std::size_t i = 0; i < count; ++i) {
+        floats.push_back(static_cast<float>(i) * -1.5f);
+        integers.push_back(static_cast<std::double_t>(i) - 50.25);
+    }
+    CANdb::encodeColumn(
+        plan->plans[0], floats.data(), count, payloads.data(), stride);
+    CANdb::encodeColumn(
+        plan->plans[1], integers.data(), count, payloads.data(), stride);
+
+    std::vector<std::double_t> decoded(count);
+    CANdb::decodeColumn(
+        plan->plans[0], payloads.data(), stride, count, decoded.data());
+    EXPECT_EQ(decoded, floats);
+    CANdb::decodeColumn(
+        plan->plans[1], payloads.data(), stride, count, decoded.data());
+    EXPECT_EQ(decoded, integers);
+
+    // Columns agree with the frame decoder
+    const auto values = decode(decoder, 0x500,
+        std::vector<std::uint8_t>(
+            payloads.begin() + 7 * stride, payloads.begin() + 8 * stride));
+    EXPECT_DOUBLE_EQ(values.at("float"), floats[7]);
+    EXPECT_DOUBLE_EQ(values.at("integer"), integers[7]);
+}
+
+TEST_F(DecoderTests, fd_payloads)
+{
+    db.messages[CANmessage{ 0x600, "FD_FRAME", 64 }] = {
+        CANsignal{ "intel_tail", 500, 12,
+            CANsignalEndianness::LittleEndianIntel, false, 1, 0, 0, 0, "",
+            {} },
+        CANsignal{ "intel_wide", 67, 64, CANsignalEndianness::LittleEndianIntel,
+            false, 1, 0, 0, 0, "", {} },
+        CANsignal{ "motorola_wide", 203, 64,
+            CANsignalEndianness::BigEndianMotorola, false, 1, 0, 0, 0, "",
+            {} },
+        CANsignal{ "motorola_s9", 290, 9,
+            CANsignalEndianness::BigEndianMotorola, true, 1, 0, 0, 0, "", {} },
+    };
+    CANdb::Decoder decoder{ db };
+
+    std::vector<std::uint8_t> payload(64, 0);
+    ASSERT_TRUE(decoder.encode(0x600, "intel_tail", 0xABC, payload.data(), 64));
+    EXPECT_EQ(payload[62], 0xC0);
+    EXPECT_EQ(payload[63], 0xAB);
+
+    // Both 64 bit signals are spread over 9 bytes
+    ASSERT_TRUE(decoder.encode(
+        0x600, "intel_wide", 9223372036854775808.0, payload.data(), 64));
+    EXPECT_EQ(payload[16], 0x04);
+    ASSERT_TRUE(decoder.encode(
+        0x600, "motorola_wide", 9223372036854775808.0, payload.data(), 64));
+    EXPECT_EQ(payload[25], 0x08);
+    ASSERT_TRUE(decoder.encode(0x600, "motorola_s9", -3, payload.data(), 64));
+
+    auto values = decode(decoder, 0x600, payload);
+    EXPECT_DOUBLE_EQ(values.at("intel_tail"), 0xABC);
+    EXPECT_DOUBLE_EQ(values.at("intel_wide"), 9223372036854775808.0);
+    EXPECT_DOUBLE_EQ(values.at("motorola_wide"), 9223372036854775808.0);
+    EXPECT_DOUBLE_EQ(values.at("motorola_s9"), -3);
+
+    // Lowest and highest bit of the 64 bit signals, the lowest Intel bit
+    // and the highest Motorola bit lie before the 8 byte window
+    std::vector<std::uint8_t> bounds(64, 0);
+    bounds[8] = 0x08;
+    bounds[16] = 0x04;
+    bounds[25] = 0x08;
+    bounds[33] = 0x10;
+    std::vector<CANdb::DecodedSignal> decoded;
+    ASSERT_TRUE(decoder.decode(0x600, bounds.data(), 64, decoded));
+    for (const auto& signal : decoded) {
+        if (signal.signal->signalSize == 64) {
+            EXPECT_EQ(signal.raw, 0x8000000000000001u);
+        }
+    }
+
+    // Signals beyond the received payload are skipped
+    decoded.clear();
+    ASSERT_TRUE(decoder.decode(0x600, payload.data(), 32, decoded));
+    ASSERT_EQ(decoded.size(), 1u);
+    EXPECT_EQ(decoded[0].signal->signal_name, "intel_wide");
+
+    // Signals beyond a short payload are not encoded
+    const auto* plan = decoder.plan(0x600);
+    ASSERT_NE(plan, nullptr);
+    std::vector<std::uint8_t> shortPayload(12, 0);
+    for (const auto& signalPlan : plan->plans) {
+        EXPECT_FALSE(CANdb::encodeSignal(
+            signalPlan, 1, shortPayload.data(), shortPayload.size()));
+    }
+    EXPECT_EQ(shortPayload, std::vector<std::uint8_t>(12, 0));
+    EXPECT_FALSE(
+        decoder.encode(0x600, "motorola_s9", -3, shortPayload.data(), 12));
+}
+
+TEST_F(DecoderTests, fd_length_codes)
+{
+    EXPECT_EQ(canDlcToLength(8), 8);
+    EXPECT_EQ(canDlcToLength(9), 12);
+    EXPECT_EQ(canDlcToLength(15), 64);
+    EXPECT_EQ(canLengthToDlc(8), 8);
+    EXPECT_EQ(canLengthToDlc(33), 14);
+    EXPECT_EQ(canLengthToDlc(64), 15);
+
+    EXPECT_EQ((CANmessage{ 0x1, "", 48 }.length()), 48u);
+    EXPECT_EQ((CANmessage{ 0x1, "", 15 }.length()), 15u);
+    EXPECT_EQ((CANmessage{ 0x1, "", 12 }.length()), 12u);
+}
+
+TEST_F(DecoderTests, extended_example_floats)
+{
+    CANdb::DBCParser parser;
+    ASSERT_TRUE(parser.parse(loadDBCFile("extended_example.dbc")));
+    CANdb::Decoder decoder{ parser.getDb() };
+
+    std::uint8_t payload[8]{};
+    ASSERT_TRUE(decoder.encode(123, "FUEL_STATUS_level", 42.125, payload, 8));
+    // Aligned Intel float is the plain little endian IEEE representation
+    const float level = 42.125f;
+    EXPECT_EQ(std::memcmp(payload, &level, sizeof(level)), 0);
+    auto values = decode(decoder, 123,
+        std::vector<std::uint8_t>(payload, payload + sizeof(payload)));
+    EXPECT_DOUBLE_EQ(values.at("FUEL_STATUS_level"), 42.125);
+
+    std::uint8_t rate[8]{};
+    ASSERT_TRUE(decoder.encode(124, "FUEL_RATE_instant", -3.5, rate, 8));
+    values = decode(
+        decoder, 124, std::vector<std::uint8_t>(rate, rate + sizeof(rate)));
+    EXPECT_DOUBLE_EQ(values.at("FUEL_RATE_instant"), -3.5);
+
+    // Motorola double is the byte swapped IEEE representation
+    const std::vector<std::uint8_t> total{ 0x40, 0x09, 0x21, 0xFB, 0x54, 0x44,
+        0x2D, 0x18 };
+    values = decode(decoder, 125, total);
+    EXPECT_DOUBLE_EQ(values.at("FUEL_TOTAL_consumed"), 3.141592653589793);
+}
+
+TEST_F(DecoderTests, extended_example_mux)
+{
+    CANdb::DBCParser parser;
+    ASSERT_TRUE(parser.parse(loadDBCFile("extended_example.dbc")));
+    CANdb::Decoder decoder{ parser.getDb() };
+
+    auto values = decode(decoder, 2024, { 98, 0x02, 0xF1, 0xE8, 0x03, 0, 0, 0 });
+    EXPECT_EQ(values.size(), 3u);
+    EXPECT_DOUBLE_EQ(values.at("DIAG_RESPONSE_did"), 0xF102);
+    EXPECT_DOUBLE_EQ(values.at("DIAG_RESPONSE_voltage"), 10);
+
+    values = decode(decoder, 2024, { 98, 0x01, 0xF1, 0x18, 0xFC, 0, 0, 0 });
+    EXPECT_EQ(values.size(), 3u);
+    EXPECT_DOUBLE_EQ(values.at("DIAG_RESPONSE_current"), -100);
+
+    values = decode(decoder, 2024, { 127, 0x31, 0, 0, 0, 0, 0, 0 });
+    EXPECT_EQ(values.size(), 2u);
+    EXPECT_DOUBLE_EQ(values.at("DIAG_RESPONSE_error_code"), 0x31);
+}
@@ -108,9 +108,10 @@ TEST_P(ExtendedDBCTest, parse_dbc_file)
                           0, 255, "", {"SENSOR", "MOTOR"},
                           CANsignalMuxType::NotMuxed, boost::none,
                           boost::any(3.0), boost::none, boost::none,
-                          std::string("2 DRIVER_HEARTBEAT_cmd_REBOOT 1 " \
-                            "DRIVER_HEARTBEAT_cmd_SYNC 0 " \
-                            "DRIVER_HEARTBEAT_cmd_NOOP")},
+                          CANvalueDescriptions_t{
+                              { 0, "DRIVER_HEARTBEAT_cmd_NOOP" },
+                              { 1, "DRIVER_HEARTBEAT_cmd_SYNC" },
+                              { 2, "DRIVER_HEARTBEAT_cmd_REBOOT" } }},
                       CANsignal{"TEST_123", 65, 16,
                           CANsignalEndianness::LittleEndianIntel, false, 1, 0,
                           0, 0, "", {"SENSOR", "MOTOR"}}
@@ -127,8 +128,9 @@ TEST_P(ExtendedDBCTest, parse_dbc_file)
                           0, 0, "", {"DBG"},
                           CANsignalMuxType::NotMuxed, boost::none,
                           boost::none, boost::none, boost::none,
-                          std::string("2 IO_DEBUG_test2_enum_two 1 " \
-                            "IO_DEBUG_test2_enum_one")},
+                          CANvalueDescriptions_t{
+                              { 1, "IO_DEBUG_test2_enum_one" },
+                              { 2, "IO_DEBUG_test2_enum_two" } }},
                       CANsignal{"IO_DEBUG_test_signed", 17, 7,
                           CANsignalEndianness::LittleEndianIntel, true, 1.5, 0,
                           -96, 94.5, "", {"DBG"},
@@ -171,6 +173,33 @@ TEST_P(ExtendedDBCTest, parse_dbc_file)
                           boost::none, boost::none, CANsignalType::Float,
                           boost::none}
                     } },
+                { CANmessage{124, "FUEL_RATE", 8, {"MOTOR"}, boost::none,
+                    boost::none},
+                    { CANsignal{"FUEL_RATE_instant", 4, 32,
+                          CANsignalEndianness::BigEndianMotorola, true, 1, 0,
+                          -3.4E+038, 3.4E+038, "l/h", {"DRIVER", "IO"},
+                          CANsignalMuxType::NotMuxed, boost::none,
+                          boost::none, boost::none, CANsignalType::Float,
+                          boost::none}
+                    } },
+                { CANmessage{125, "FUEL_TOTAL", 8, {"MOTOR"}, boost::none,
+                    boost::none},
+                    { CANsignal{"FUEL_TOTAL_consumed", 7, 64,
+                          CANsignalEndianness::BigEndianMotorola, true, 1, 0,
+                          -1.7E+308, 1.7E+308, "l", {"DRIVER", "IO"},
+                          CANsignalMuxType::NotMuxed, boost::none,
+                          boost::none, boost::none, CANsignalType::Double,
+                          boost::none}
+                    } },
+                { CANmessage{126, "FUEL_INJECTORS", 64, {"MOTOR"}, boost::none,
+                    boost::none},
+                    { CANsignal{"FUEL_INJECTORS_first", 0, 16,
+                          CANsignalEndianness::LittleEndianIntel, false, 0.01,
+                          0, 0, 655.35, "ms", {"DRIVER"}},
+                      CANsignal{"FUEL_INJECTORS_last", 496, 16,
+                          CANsignalEndianness::LittleEndianIntel, false, 0.01,
+                          0, 0, 655.35, "ms", {"DRIVER"}}
+                    } },
                 { CANmessage{200, "SENSOR_SONARS", 8, {"SENSOR"}, boost::none,
                     boost::none},
                     { CANsignal{"SENSOR_SONARS_mux", 0, 4,
@@ -258,6 +287,36 @@ TEST_P(ExtendedDBCTest, parse_dbc_file)
                       CANsignal{"TemperatureUndergroundMultiplexd", 7, 16,
                           CANsignalEndianness::BigEndianMotorola, true, 0.1,
                           -40, 0, 0, "degC", {}, CANsignalMuxType::Muxed, 11}
+                    } },
+                { CANmessage{2024, "DIAG_RESPONSE", 8, {"SENSOR"}, boost::none,
+                    boost::none},
+                    { CANsignal{"DIAG_RESPONSE_service", 0, 8,
+                          CANsignalEndianness::LittleEndianIntel, false, 1, 0,
+                          0, 255, "", {}, CANsignalMuxType::Muxer},
+                      CANsignal{"DIAG_RESPONSE_did", 8, 16,
+                          CANsignalEndianness::LittleEndianIntel, false, 1, 0,
+                          0, 65535, "", {}, CANsignalMuxType::MuxedMuxer, 98,
+                          boost::none, boost::none, boost::none, boost::none,
+                          CANmuxDependency{ "DIAG_RESPONSE_service",
+                              { { 98, 98 } } }},
+                      CANsignal{"DIAG_RESPONSE_voltage", 24, 16,
+                          CANsignalEndianness::LittleEndianIntel, false, 0.01,
+                          0, 0, 655.35, "V", {}, CANsignalMuxType::Muxed, 98,
+                          boost::none, boost::none, boost::none, boost::none,
+                          CANmuxDependency{ "DIAG_RESPONSE_did",
+                              { { 61696, 61696 }, { 61698, 61700 } } }},
+                      CANsignal{"DIAG_RESPONSE_current", 24, 16,
+                          CANsignalEndianness::LittleEndianIntel, true, 0.1, 0,
+                          -3276.8, 3276.7, "A", {}, CANsignalMuxType::Muxed, 98,
+                          boost::none, boost::none, boost::none, boost::none,
+                          CANmuxDependency{ "DIAG_RESPONSE_did",
+                              { { 61697, 61697 } } }},
+                      CANsignal{"DIAG_RESPONSE_error_code", 8, 8,
+                          CANsignalEndianness::LittleEndianIntel, false, 1, 0,
+                          0, 255, "", {}, CANsignalMuxType::Muxed, 127,
+                          boost::none, boost::none, boost::none, boost::none,
+                          CANmuxDependency{ "DIAG_RESPONSE_service",
+                              { { 127, 127 } } }}
                     } }
             };
 
@@ -291,29 +350,6 @@ TEST_P(ExtendedDBCTest, parse_dbc_file)
                         expectedMessageIt->second.end(), CANsignal(*signalIt));
                 ASSERT_NE(expectedSignalIt, expectedMessageIt->second.end());
 
-                auto anyCompare = [](const boost::any& first,
-                    const boost::any& second) {
-                    using boost::any_cast;
-
-                    bool same = first.empty() == second.empty()
-                        && first.type() == second.type();
-
-                    if (same) {
-                        if (first.type() == typeid(std::string)) {
-                            same = any_cast<std::string>(first)
-                                == any_cast<std::string>(second);
-                        } else if (first.type() == typeid(std::double_t)) {
-                            same = std::fabs(any_cast<std::double_t>(first)
-                                - any_cast<std::double_t>(second)) < 1E-05;
-                        } else if (first.type() == typeid(std::uint32_t)) {
-                            same = any_cast<std::uint32_t>(first)
-                                == any_cast<std::uint32_t>(second);
-                        }
-                    }
-
-                    return same;
-                };
-
                 cdb_debug("Checking signal: {}", signalIt->signal_name);
                 ASSERT_EQ(signalIt->signal_name, expectedSignalIt->signal_name);
                 ASSERT_EQ(signalIt->startBit, expectedSignalIt->startBit);
@@ -327,17 +363,53 @@ TEST_P(ExtendedDBCTest, parse_dbc_file)
                 ASSERT_EQ(signalIt->unit, expectedSignalIt->unit);
                 ASSERT_EQ(signalIt->receivers, expectedSignalIt->receivers);
                 ASSERT_EQ(signalIt->muxType, expectedSignalIt->muxType);
-                ASSERT_EQ(signalIt->muxNdx, expectedSignalIt->muxNdx);
-                ASSERT_TRUE(anyCompare(signalIt->startValue,
-                    expectedSignalIt->startValue));
-                ASSERT_EQ(signalIt->comment, expectedSignalIt->comment);
-                ASSERT_EQ(signalIt->valueType, expectedSignalIt->valueType);
-                ASSERT_EQ(signalIt->valueDescription,
-                    expectedSignalIt->valueDescription);
+                ASSERT_TRUE(signalIt->muxNdx() == expectedSignalIt->muxNdx());
+                ASSERT_TRUE(
+                    signalIt->startValue().is_initialized()
+                    == expectedSignalIt->startValue().is_initialized());
+                ASSERT_EQ(signalIt->has(CANsignal::START_TEXT),
+                    expectedSignalIt->has(CANsignal::START_TEXT));
+                ASSERT_NEAR(signalIt->startNumber(),
+                    expectedSignalIt->startNumber(), 1E-05);
+                ASSERT_EQ(signalIt->startText(), expectedSignalIt->startText());
+                ASSERT_TRUE(signalIt->comment() == expectedSignalIt->comment());
+                ASSERT_TRUE(
+                    signalIt->valueType() == expectedSignalIt->valueType());
+                ASSERT_TRUE(signalIt->valueDescription()
+                    == expectedSignalIt->valueDescription());
+                ASSERT_TRUE(signalIt->muxDependency()
+                    == expectedSignalIt->muxDependency());
             }
         }
     }
 }
 
+TEST_P(ExtendedDBCTest, fingerprint_while_parsing)
+{
+    ASSERT_TRUE(parser.parse(loadDBCFile(GetParam())));
+
+    // Comments, attributes and value types are set after their messages,
+    // the updated prints must add up to those of the parsed database
+    const auto db = parser.getDb();
+    const std::uint8_t includes[] = { 0, CANdb::COMMENT, CANdb::ATTRIBUTES,
+        CANdb::COMMENT | CANdb::ATTRIBUTES };
+    for (const auto include : includes) {
+        EXPECT_EQ(parser.fingerprint().value(include),
+            CANdb::fingerprintOf(db, include));
+    }
+}
+
+TEST_P(ExtendedDBCTest, no_fingerprint_for_a_failed_parse)
+{
+    // Valid up to a message whose signal is cut off
+    auto file = loadDBCFile(GetParam());
+    file = file.substr(0, file.find(" SG_ ") + 10);
+    ASSERT_FALSE(parser.parse(file));
+
+    EXPECT_EQ(parser.fingerprint().value(), CANdb::Fingerprint{});
+    EXPECT_EQ(parser.fingerprint().value(CANdb::COMMENT | CANdb::ATTRIBUTES),
+        CANdb::Fingerprint{});
+}
+
 INSTANTIATE_TEST_CASE_P(ExtendedDBC, ExtendedDBCTest,
     ::testing::Values("extended_example.dbc"));
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include "fingerprint.h"
+#include "log.hpp"
+#include "test_database.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+namespace {
+using test_data::signal;
+
+CANdb_t database()
+{
+    auto db = test_data::engineAndBrakes();
+    db.version = "1.0";
+    db.ecus = { "ECM", "ABS" };
+    return db;
+}
+
+const std::uint8_t ALL = CANdb::COMMENT | CANdb::ATTRIBUTES;
+} // namespace
+
+TEST(FingerprintTests, order_independent)
+{
+    auto reordered = database();
+    reordered.ecus = { "ABS", "ECM" };
+    for (auto& message : reordered.messages) {
+        std::reverse(message.second.begin(), message.second.end());
+    }
+    EXPECT_EQ(CANdb::fingerprintOf(database(), ALL),
+        CANdb::fingerprintOf(reordered, ALL));
+    EXPECT_EQ(CANdb::fingerprintOf(database()).hex().size(), 32);
+
+    // Moving a signal to another message is a change
+    auto moved = database();
+    moved.messages.at(CANmessage{ 0x100 }).pop_back();
+    moved.messages.at(CANmessage{ 0x200 }).push_back(signal("load", 16));
+    EXPECT_NE(
+        CANdb::fingerprintOf(database()), CANdb::fingerprintOf(moved));
+}
+
+TEST(FingerprintTests, comments_and_attributes_on_demand)
+{
+    auto commented = database();
+    commented.messages.at(CANmessage{ 0x100 })[1].setComment("Coolant");
+    commented.version = "2.0";
+    EXPECT_EQ(
+        CANdb::fingerprintOf(database()), CANdb::fingerprintOf(commented));
+    EXPECT_NE(CANdb::fingerprintOf(database(), CANdb::COMMENT),
+        CANdb::fingerprintOf(commented, CANdb::COMMENT));
+    EXPECT_NE(CANdb::fingerprintOf(database(), CANdb::ATTRIBUTES),
+        CANdb::fingerprintOf(commented, CANdb::ATTRIBUTES));
+
+    auto scaled = database();
+    scaled.messages.at(CANmessage{ 0x200 })[0].factor = 0.5;
+    EXPECT_NE(CANdb::fingerprintOf(database()), CANdb::fingerprintOf(scaled));
+}
+
+TEST(FingerprintTests, incremental_updates)
+{
+    auto db = database();
+    CANdb::DbFingerprint print;
+    // Items in any order, as a parser meets them
+    for (auto message = db.messages.rbegin(); message != db.messages.rend();
+         ++message) {
+        for (const auto& signal : message->second) {
+            print.add(message->first.id, signal);
+        }
+        print.add(message->first);
+    }
+
+    auto& speed = db.messages.at(CANmessage{ 0x100 })[0];
+    print.remove(0x100, speed);
+    speed.setComment("Vehicle speed");
+    speed.setValueType(CANsignalType::Float);
+    print.add(0x100, speed);
+
+    const auto brakes = db.messages.find(CANmessage{ 0x200 });
+    const CANmessage timed{ 0x200, "BRAKES", 8, { "ABS" }, 20 };
+    print.remove(brakes->first);
+    print.add(timed);
+    const auto signals = brakes->second;
+    db.messages.erase(brakes);
+    db.messages[timed] = signals;
+
+    // Not a database print until complete
+    EXPECT_EQ(print.value(), CANdb::Fingerprint{});
+    print.setGlobals(db);
+    EXPECT_EQ(print.value(), CANdb::fingerprintOf(db));
+    EXPECT_EQ(print.value(ALL), CANdb::fingerprintOf(db, ALL));
+}
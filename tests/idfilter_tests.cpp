@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include "idfilter.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+#include <random>
+
+namespace {
+CANmessage message(std::uint32_t id)
+{
+    return CANmessage{ id, "M" + std::to_string(id), 8 };
+}
+} // namespace
+
+TEST(IdFilterTests, standard_ids_are_exact)
+{
+    CANdb_t db;
+    for (std::uint32_t id : { 0x000, 0x0FF, 0x100, 0x3C0, 0x7FF }) {
+        db.messages[message(id)] = {};
+    }
+    const CANdb::IdFilter filter{ db };
+    std::size_t passed = 0;
+    for (std::uint32_t id = 0; id < CANdb::IdFilter::STANDARD_IDS; ++id) {
+        passed += filter.mayContain(id) ? 1 : 0;
+    }
+    EXPECT_EQ(passed, 5u);
+    EXPECT_TRUE(filter.mayContain(0x3C0));
+    EXPECT_FALSE(filter.mayContain(0x3C1));
+    // The same number as an extended id is another message
+    EXPECT_FALSE(filter.mayContain(0x3C0 | CANdb::CAN_EXTENDED_ID_FLAG));
+
+    const CANdb::IdFilter empty;
+    EXPECT_FALSE(empty.mayContain(0x000));
+    EXPECT_FALSE(empty.mayContain(0x18FEF100 | CANdb::CAN_EXTENDED_ID_FLAG));
+}
+
+TEST(IdFilterTests, extended_ids_rarely_pass_by_mistake)
+{
+    std::mt19937 random{ 42 };
+    std::uniform_int_distribution<std::uint32_t> ids{ 0, 0x1FFFFFFF };
+    CANdb_t db;
+    while (db.messages.size() < 1000) {
+        db.messages[message(ids(random) | CANdb::CAN_EXTENDED_ID_FLAG)] = {};
+    }
+    const CANdb::IdFilter filter{ db };
+    for (const auto& message : db.messages) {
+        EXPECT_TRUE(filter.mayContain(message.first.id));
+    }
+    EXPECT_LE(filter.bytes(), 256u + 8192u);
+
+    std::size_t passed = 0;
+    const std::size_t probes = 1000000;
+    for (std::size_t i = 0; i < probes; ++i) {
+        const auto id = ids(random) | CANdb::CAN_EXTENDED_ID_FLAG;
+        passed += filter.mayContain(id)
+                && db.messages.count(message(id)) == 0
+            ? 1
+            : 0;
+    }
+    EXPECT_LT(passed, probes / 200);
+}
+
+TEST(IdFilterTests, selects_batches)
+{
+    CANdb_t db;
+    db.messages[message(0x100)] = {};
+    db.messages[message(0x18FEF100 | CANdb::CAN_EXTENDED_ID_FLAG)] = {};
+    const CANdb::IdFilter filter{ db };
+
+    std::vector<CANdb::CANframe> frames(6);
+    const std::uint32_t ids[] = { 0x100, 0x101, 0x18FEF100, 0x18FEF100, 0x7FF,
+        0x100 };
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        frames[i].id = ids[i];
+        frames[i].extended = ids[i] > 0x7FF;
+    }
+    // A standard frame with the number of the extended message
+    frames[3].extended = false;
+
+    std::vector<std::uint32_t> passed(frames.size());
+    ASSERT_EQ(filter.select(frames.data(), frames.size(), passed.data()), 3u);
+    EXPECT_EQ(passed[0], 0u);
+    EXPECT_EQ(passed[1], 2u);
+    EXPECT_EQ(passed[2], 5u);
+
+    const std::uint32_t dbcIds[] = { 0x200, 0x100,
+        0x18FEF100 | CANdb::CAN_EXTENDED_ID_FLAG };
+    ASSERT_EQ(filter.select(dbcIds, 3, passed.data()), 2u);
+    EXPECT_EQ(passed[0], 1u);
+    EXPECT_EQ(passed[1], 2u);
+}
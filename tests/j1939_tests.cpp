@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include "j1939.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+struct J1939Tests : public ::testing::Test {
+    J1939Tests()
+    {
+        // CCVS, PDU2 sent by the engine (SA 0x00)
+        db.messages[CANmessage{ 0x98FEF100, "CCVS", 8 }] = {
+            CANsignal{ "WheelBasedVehicleSpeed", 8, 16,
+                CANsignalEndianness::LittleEndianIntel, false, 1.0 / 256, 0,
+                0, 250.996, "km/h", {} },
+        };
+        // Proprietary A, PDU1 sent by 0x05 to 0x10
+        db.messages[CANmessage{ 0x98EF1005, "PROP_A", 8 }] = {
+            CANsignal{ "command", 0, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+        };
+        // Same PGN defined for two sources with different layouts
+        db.messages[CANmessage{ 0x98FF1001, "STATUS_A", 8 }] = {
+            CANsignal{ "a", 0, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+        };
+        db.messages[CANmessage{ 0x98FF1002, "STATUS_B", 8 }] = {
+            CANsignal{ "b", 0, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+        };
+        // Standard ids take no part in the PGN index
+        db.messages[CANmessage{ 0x100, "STANDARD", 8 }] = {};
+        // TSC1, PGN 0, which a standard id must not resolve to
+        db.messages[CANmessage{ 0x8C000003, "TSC1", 8 }] = {
+            CANsignal{ "EngOverrideCtrlMode", 0, 2,
+                CANsignalEndianness::LittleEndianIntel, false, 1, 0, 0, 0, "",
+                {} },
+        };
+    }
+
+    CANdb_t db;
+};
+
+TEST_F(J1939Tests, parse_id)
+{
+    const auto pdu2 = CANdb::parseJ1939Id(0x0CFEF121);
+    EXPECT_EQ(pdu2.pgn, 0xFEF1u);
+    EXPECT_EQ(pdu2.priority, 3);
+    EXPECT_EQ(pdu2.source, 0x21);
+    EXPECT_EQ(pdu2.destination, CANdb::J1939_GLOBAL_ADDRESS);
+
+    const auto pdu1 = CANdb::parseJ1939Id(0x14EF2A33);
+    EXPECT_EQ(pdu1.pgn, 0xEF00u);
+    EXPECT_EQ(pdu1.priority, 5);
+    EXPECT_EQ(pdu1.source, 0x33);
+    EXPECT_EQ(pdu1.destination, 0x2A);
+
+    // Data page and extended data page are part of the PGN
+    EXPECT_EQ(CANdb::parseJ1939Id(0x1BFECA00).pgn, 0x3FECAu);
+}
+
+TEST_F(J1939Tests, any_source_address)
+{
+    CANdb::J1939Decoder decoder{ db };
+
+    const std::uint8_t payload[]{ 0, 0x00, 0x32, 0, 0, 0, 0, 0 };
+    for (std::uint32_t source = 0; source < 30; ++source) {
+        CANdb::J1939Header header;
+        std::vector<CANdb::DecodedSignal> decoded;
+        ASSERT_TRUE(decoder.decode(
+            0x98FEF100 | source, payload, sizeof(payload), header, decoded));
+        EXPECT_EQ(header.source, source);
+        ASSERT_EQ(decoded.size(), 1u);
+        EXPECT_DOUBLE_EQ(decoded[0].value, 50);
+    }
+
+    EXPECT_EQ(decoder.plan(0x98FEF17F), decoder.plan(0x98FEF100));
+    EXPECT_EQ(decoder.plan(0x98FEF200), nullptr);
+}
+
+TEST_F(J1939Tests, standard_id_is_not_a_pgn)
+{
+    CANdb::J1939Decoder decoder{ db };
+
+    // Without the extended flag 0x100 would parse as PGN 0 (TSC1)
+    ASSERT_NE(decoder.plan(0x8C000003), nullptr);
+    EXPECT_EQ(decoder.plan(0x100), nullptr);
+    EXPECT_EQ(decoder.plan(0x0C000003), nullptr);
+
+    const std::uint8_t payload[]{ 1 };
+    CANdb::J1939Header header;
+    std::vector<CANdb::DecodedSignal> decoded;
+    EXPECT_FALSE(
+        decoder.decode(0x100, payload, sizeof(payload), header, decoded));
+    EXPECT_TRUE(decoded.empty());
+}
+
+TEST_F(J1939Tests, pdu1_destination)
+{
+    CANdb::J1939Decoder decoder{ db };
+
+    const std::uint8_t payload[]{ 7 };
+    CANdb::J1939Header header;
+    std::vector<CANdb::DecodedSignal> decoded;
+    ASSERT_TRUE(decoder.decode(
+        0x94EF2A33, payload, sizeof(payload), header, decoded));
+    EXPECT_EQ(header.pgn, 0xEF00u);
+    EXPECT_EQ(header.priority, 5);
+    EXPECT_EQ(header.source, 0x33);
+    EXPECT_EQ(header.destination, 0x2A);
+    ASSERT_EQ(decoded.size(), 1u);
+    EXPECT_EQ(decoded[0].signal->signal_name, "command");
+}
+
+TEST_F(J1939Tests, shared_pgn_prefers_exact_id)
+{
+    CANdb::J1939Decoder decoder{ db };
+
+    ASSERT_NE(decoder.plan(0x98FF1002), nullptr);
+    EXPECT_EQ(decoder.plan(0x98FF1002)->message->name, "STATUS_B");
+    EXPECT_EQ(decoder.plan(0x98FF1001)->message->name, "STATUS_A");
+    EXPECT_EQ(decoder.plan(0x98FF1003)->message->name, "STATUS_A");
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include "multibus.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+namespace {
+CANdb_t busDb(const std::string& node, std::uint32_t firstId,
+    std::size_t messages, double factor = 1)
+{
+    CANdb_t db;
+    db.nodes = { node, "GATEWAY" };
+    for (std::uint32_t i = 0; i < messages; ++i) {
+        db.messages[CANmessage{ firstId + i, "MSG_" + std::to_string(i), 8,
+            { node } }]
+            = { CANsignal{ "value", 0, 16,
+                    CANsignalEndianness::LittleEndianIntel, false, factor, 0, 0,
+                    0, "km/h", { "GATEWAY" } },
+                  CANsignal{ "counter", 16, 4,
+                      CANsignalEndianness::LittleEndianIntel, false, 1, 0, 0,
+                      15, "", { "GATEWAY" } } };
+    }
+    return db;
+}
+} // namespace
+
+TEST(MultiBusTests, merges_buses)
+{
+    std::vector<CANdb::BusDb> inputs;
+    inputs.push_back(CANdb::BusDb{ "powertrain", busDb("ECM", 0x100, 3) });
+    inputs.push_back(CANdb::BusDb{ "chassis", busDb("ABS", 0x100, 2) });
+    const auto merged = CANdb::MultiBusDb::merge(std::move(inputs));
+
+    ASSERT_EQ(merged.busCount(), 2u);
+    EXPECT_EQ(merged.bus("chassis"), 1u);
+    EXPECT_EQ(merged.bus("body"), CANdb::MultiBusDb::NO_BUS);
+    EXPECT_EQ(merged.messages().size(), 5u);
+    EXPECT_TRUE(merged.conflicts().empty());
+
+    // The same id on two buses
+    const auto* powertrain = merged.find(0, 0x101);
+    const auto* chassis = merged.find(1, 0x101);
+    ASSERT_NE(powertrain, nullptr);
+    ASSERT_NE(chassis, nullptr);
+    EXPECT_EQ(powertrain->message->ecus[0], "ECM");
+    EXPECT_EQ(chassis->message->ecus[0], "ABS");
+    EXPECT_EQ(chassis->signals->size(), 2u);
+    EXPECT_EQ(merged.find(1, 0x102), nullptr);
+
+    // Sorted by bus and id
+    EXPECT_EQ(merged.messages()[3].bus, 1u);
+    EXPECT_EQ(merged.messages()[3].message->id, 0x100u);
+
+    // Interned strings are shared between buses
+    EXPECT_TRUE(
+        powertrain->signals->at(0).unit == chassis->signals->at(0).unit);
+    ASSERT_EQ(merged.nodes().size(), 3u);
+    EXPECT_EQ(merged.nodes()[0], "ABS");
+    EXPECT_EQ(merged.nodes()[2], "GATEWAY");
+}
+
+TEST(MultiBusTests, reports_conflicting_definitions)
+{
+    auto reordered = busDb("ECM", 0x100, 2);
+    for (auto& message : reordered.messages) {
+        std::reverse(message.second.begin(), message.second.end());
+    }
+
+    std::vector<CANdb::BusDb> inputs;
+    inputs.push_back(CANdb::BusDb{ "powertrain", busDb("ECM", 0x100, 2) });
+    // Signal order does not change a definition
+    inputs.push_back(CANdb::BusDb{ "powertrain", std::move(reordered) });
+    inputs.push_back(
+        CANdb::BusDb{ "powertrain", busDb("ECM", 0x101, 2, 0.5) });
+    const auto merged = CANdb::MultiBusDb::merge(std::move(inputs));
+
+    EXPECT_EQ(merged.busCount(), 1u);
+    EXPECT_EQ(merged.messages().size(), 3u);
+    ASSERT_EQ(merged.conflicts().size(), 1u);
+    const auto& conflict = merged.conflicts()[0];
+    EXPECT_EQ(conflict.id, 0x101u);
+    EXPECT_EQ(conflict.first, 0u);
+    EXPECT_EQ(conflict.second, 2u);
+    // The first definition is kept
+    EXPECT_EQ(merged.find(0, 0x101)->source, 0u);
+}
@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+
+#include "paralleldecoder.h"
+#include "ascreader.h"
+#include "candump.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+#include <fstream>
+#include <sstream>
+
+namespace {
+struct Frame {
+    std::uint64_t timestamp;
+    std::uint32_t id;
+    std::uint16_t channel;
+    std::uint64_t counter;
+
+    bool operator==(const Frame& other) const
+    {
+        return timestamp == other.timestamp && id == other.id
+            && channel == other.channel && counter == other.counter;
+    }
+};
+
+// Frames of the messages in the database, as the streaming reader sees them
+template <typename Reader>
+std::vector<Frame> expected(Reader& reader, const CANdb::Decoder& decoder)
+{
+    std::vector<Frame> frames;
+    CANdb::CANframe frame;
+    std::vector<CANdb::DecodedSignal> signals;
+    while (reader.next(frame)) {
+        signals.clear();
+        if (decoder.decode(frame.dbcId(), frame.data, frame.size, signals)) {
+            frames.push_back(
+                { frame.timestamp, frame.id, frame.channel, signals[0].raw });
+        }
+    }
+    return frames;
+}
+
+std::vector<Frame> decodeChunked(CANdb::ParallelLogDecoder& decoder)
+{
+    std::vector<Frame> frames;
+    decoder.run([&frames](const CANdb::CANframe& frame,
+                    const CANdb::MessagePlan&,
+                    const std::vector<CANdb::DecodedSignal>& signals) {
+        frames.push_back(
+            { frame.timestamp, frame.id, frame.channel, signals[0].raw });
+    });
+    return frames;
+}
+} // namespace
+
+struct ParallelDecoderTests : public ::testing::Test {
+    ParallelDecoderTests()
+    {
+        for (std::uint32_t id : { 0x100u, 0x200u }) {
+            db.messages[CANmessage{ id, "M" + std::to_string(id), 8 }] = {
+                CANsignal{ "counter", 0, 16,
+                    CANsignalEndianness::LittleEndianIntel, false, 1, 0, 0, 0,
+                    "", {} },
+            };
+        }
+    }
+
+    ~ParallelDecoderTests()
+    {
+        for (const auto& path : logs) {
+            std::remove(path.c_str());
+        }
+    }
+
+    std::string writeLog(const std::string& name, const std::string& content)
+    {
+        const auto path = "paralleldecoder_tests_" + name;
+        std::ofstream{ path, std::ios::binary } << content;
+        logs.push_back(path);
+        return path;
+    }
+
+    CANdb_t db;
+    std::vector<std::string> logs;
+};
+
+TEST_F(ParallelDecoderTests, candump_matches_streaming_reader)
+{
+    // 0x300 is not in the database, the third channel shows up late
+    std::ostringstream log;
+    const char* ids[] = { "100", "200", "300" };
+    for (unsigned i = 0; i < 3000; ++i) {
+        log << '(' << 1436509053 + i / 1000 << '.' << 100000 + i % 1000
+            << ") " << (i < 2000 ? (i % 2 ? "can1" : "can0") : "vcan2") << ' '
+            << ids[i % 3] << '#' << std::hex << (i & 0xF) << (i >> 4 & 0xF)
+            << (i >> 12 & 0xF) << (i >> 8 & 0xF) << std::dec << '\n';
+        if (i % 250 == 0) {
+            log << "garbage line\n\n";
+        }
+    }
+    log << "(1436509060.000000) can0 100#0100";
+    const auto path = writeLog("candump.log", log.str());
+
+    const CANdb::Decoder decoder{ db };
+    auto* file = std::fopen(path.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    CANdb::CandumpReader reader{ file };
+    const auto frames = expected(reader, decoder);
+    std::fclose(file);
+    ASSERT_EQ(frames.size(), 2001u);
+
+    for (unsigned threads : { 0u, 1u, 3u }) {
+        for (std::size_t chunkSize : { 1u, 97u, 4096u, 1u << 20 }) {
+            CANdb::ParallelLogDecoder chunked{ path,
+                CANdb::ParallelLogDecoder::Format::Candump, decoder, threads,
+                chunkSize };
+            EXPECT_TRUE(decodeChunked(chunked) == frames)
+                << threads << " threads, " << chunkSize << " byte chunks";
+            EXPECT_EQ(chunked.channels(), reader.channels());
+            EXPECT_EQ(chunked.frames(), 3001u);
+            EXPECT_EQ(chunked.decoded(), 2001u);
+            EXPECT_EQ(chunked.lines(), reader.lines());
+            EXPECT_EQ(chunked.skipped(), reader.skipped());
+        }
+    }
+}
+
+TEST_F(ParallelDecoderTests, asc_relative_timestamps_carry_over)
+{
+    std::ostringstream log;
+    log << "date Wed Sep 29 10:00:00 am 2021\n"
+           "base dec  timestamps relative\n"
+           "Begin Triggerblock\n";
+    for (unsigned i = 0; i < 1000; ++i) {
+        log << "0.00" << 1 + i % 9 << " 1 " << (i % 2 ? 256 : 512)
+            << " Rx d 2 " << (i & 0xFF) << ' ' << (i >> 8) << '\n';
+        if (i % 100 == 0) {
+            log << "0.000 1 Statistic: D 0 R 0 XD 0 XR 0 E 0 O 0 B 0.00%\n";
+        }
+    }
+    log << "End TriggerBlock\n";
+    const auto path = writeLog("relative.asc", log.str());
+
+    const CANdb::Decoder decoder{ db };
+    auto* file = std::fopen(path.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    CANdb::AscReader reader{ file };
+    const auto frames = expected(reader, decoder);
+    std::fclose(file);
+    ASSERT_EQ(frames.size(), 1000u);
+    ASSERT_GT(frames.back().timestamp, 1000u * 1000000u);
+
+    for (unsigned threads : { 0u, 2u }) {
+        for (std::size_t chunkSize : { 1u, 200u, 1u << 20 }) {
+            CANdb::ParallelLogDecoder chunked{ path,
+                CANdb::ParallelLogDecoder::Format::Asc, decoder, threads,
+                chunkSize };
+            EXPECT_TRUE(decodeChunked(chunked) == frames)
+                << threads << " threads, " << chunkSize << " byte chunks";
+            EXPECT_EQ(chunked.lines(), reader.lines());
+            EXPECT_EQ(chunked.skipped(), reader.skipped());
+        }
+    }
+}
+
+TEST_F(ParallelDecoderTests, sink_errors_stop_the_workers)
+{
+    std::ostringstream log;
+    for (unsigned i = 0; i < 1000; ++i) {
+        log << "(1.000000) can0 100#0000\n";
+    }
+    const auto path = writeLog("errors.log", log.str());
+
+    const CANdb::Decoder decoder{ db };
+    CANdb::ParallelLogDecoder chunked{ path,
+        CANdb::ParallelLogDecoder::Format::Candump, decoder, 2, 64 };
+    unsigned written = 0;
+    const auto sink = [&written](const CANdb::CANframe&,
+                          const CANdb::MessagePlan&,
+                          const std::vector<CANdb::DecodedSignal>&) {
+        if (++written == 10) {
+            throw std::runtime_error("disk full");
+        }
+    };
+    EXPECT_THROW(chunked.run(sink), std::runtime_error);
+    EXPECT_EQ(written, 10u);
+
+    // The decoder can run again after an error
+    written = 0;
+    chunked.run([&written](const CANdb::CANframe&, const CANdb::MessagePlan&,
+                    const std::vector<CANdb::DecodedSignal>&) { ++written; });
+    EXPECT_EQ(written, 1000u);
+}
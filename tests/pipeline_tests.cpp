@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include "pipeline.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+#include <stdexcept>
+
+namespace {
+// Source of `count` frames cycling through the ids, payload byte 0 and the
+// timestamp hold the frame number
+struct Frames {
+    Frames(std::uint64_t count, std::vector<std::uint32_t> ids)
+        : count(count)
+        , ids(ids)
+    {
+    }
+
+    std::uint64_t count;
+    std::vector<std::uint32_t> ids;
+    std::uint64_t produced{ 0 };
+
+    bool operator()(CANdb::CANframe& frame)
+    {
+        if (produced == count) {
+            return false;
+        }
+        frame.timestamp = produced;
+        frame.id = ids[produced % ids.size()];
+        frame.extended = false;
+        frame.size = 8;
+        std::memset(frame.data, 0, 8);
+        frame.data[0] = static_cast<std::uint8_t>(produced);
+        frame.data[1] = static_cast<std::uint8_t>(produced >> 8);
+        ++produced;
+        return true;
+    }
+};
+} // namespace
+
+struct PipelineTests : public ::testing::Test {
+    PipelineTests()
+    {
+        db.messages[CANmessage{ 0x100, "A", 8 }] = {
+            CANsignal{ "counter", 0, 16, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+        };
+        db.messages[CANmessage{ 0x200, "B", 8 }] = {
+            CANsignal{ "counter", 0, 16, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+            CANsignal{ "low", 0, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+        };
+    }
+
+    CANdb_t db;
+};
+
+TEST_F(PipelineTests, output_keeps_source_order)
+{
+    const CANdb::Decoder decoder{ db };
+    for (unsigned workers : { 1u, 3u }) {
+        CANdb::PipelineOptions options;
+        options.workers = workers;
+        options.batchSize = 7;
+        options.queueDepth = 2;
+        CANdb::DecodePipeline pipeline{ decoder, options };
+
+        // 0x300 is not in the database
+        Frames source{ 10000, { 0x100, 0x200, 0x300, 0x200 } };
+        std::uint64_t next = 0;
+        pipeline.run(std::ref(source),
+            [&next](const CANdb::CANframe& frame,
+                const CANdb::MessagePlan& plan,
+                const std::vector<CANdb::DecodedSignal>& signals) {
+                if (next % 4 == 2) {
+                    ++next;
+                }
+                ASSERT_EQ(frame.timestamp, next);
+                ASSERT_EQ(plan.message->id, frame.id);
+                ASSERT_EQ(signals.size(), frame.id == 0x100 ? 1u : 2u);
+                EXPECT_EQ(signals[0].raw, next % 0x10000);
+                ++next;
+            });
+        EXPECT_EQ(next, 10000u);
+
+        const auto stats = pipeline.stats();
+        EXPECT_EQ(stats.reader.frames, 10000u);
+        EXPECT_EQ(stats.reader.batches, (10000u + 6) / 7);
+        EXPECT_EQ(stats.decoder.frames, 10000u);
+        EXPECT_EQ(stats.writer.frames, 10000u);
+        EXPECT_EQ(stats.decoded, 7500u);
+        EXPECT_LE(stats.maxDecodeQueue, 2u * workers);
+        EXPECT_LE(stats.maxWriteQueue, 2u * workers);
+    }
+}
+
+TEST_F(PipelineTests, pipeline_can_be_rerun)
+{
+    const CANdb::Decoder decoder{ db };
+    CANdb::DecodePipeline pipeline{ decoder };
+    for (std::uint64_t count : { 0u, 1u, 4096u, 4097u }) {
+        std::uint64_t written = 0;
+        pipeline.run(Frames{ count, { 0x100 } },
+            [&written](const CANdb::CANframe&, const CANdb::MessagePlan&,
+                const std::vector<CANdb::DecodedSignal>&) { ++written; });
+        EXPECT_EQ(written, count);
+    }
+}
+
+TEST_F(PipelineTests, errors_stop_the_pipeline)
+{
+    const CANdb::Decoder decoder{ db };
+    CANdb::PipelineOptions options;
+    options.batchSize = 16;
+    options.queueDepth = 1;
+    CANdb::DecodePipeline pipeline{ decoder, options };
+
+    std::uint64_t written = 0;
+    const auto count = [&written](const CANdb::CANframe&,
+                           const CANdb::MessagePlan&,
+                           const std::vector<CANdb::DecodedSignal>&) {
+        ++written;
+    };
+
+    // Frames read before the error are written
+    Frames frames{ 100000, { 0x100 } };
+    EXPECT_THROW(pipeline.run(
+                     [&frames](CANdb::CANframe& frame) {
+                         if (frames.produced == 1000) {
+                             throw std::runtime_error("read error");
+                         }
+                         return frames(frame);
+                     },
+                     count),
+        std::runtime_error);
+    EXPECT_EQ(written, 1000u);
+
+    EXPECT_THROW(pipeline.run(Frames{ 100000, { 0x100 } },
+                     [](const CANdb::CANframe& frame,
+                         const CANdb::MessagePlan&,
+                         const std::vector<CANdb::DecodedSignal>&) {
+                         if (frame.timestamp == 500) {
+                             throw std::runtime_error("write error");
+                         }
+                     }),
+        std::runtime_error);
+    EXPECT_LT(pipeline.stats().reader.frames, 100000u);
+}
+
+TEST(SpscRingTests, transfers_in_order)
+{
+    CANdb::SpscRing<std::uint64_t> ring{ 5 };
+    EXPECT_EQ(ring.capacity(), 8u);
+
+    const std::uint64_t count = 100000;
+    std::thread producer([&ring] {
+        for (std::uint64_t i = 0; i < count;) {
+            if (ring.push(i)) {
+                ++i;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::uint64_t value;
+    for (std::uint64_t i = 0; i < count; ++i) {
+        while (!ring.pop(value)) {
+            std::this_thread::yield();
+        }
+        ASSERT_EQ(value, i);
+        ASSERT_LE(ring.size(), 8u);
+    }
+    producer.join();
+    EXPECT_FALSE(ring.pop(value));
+}
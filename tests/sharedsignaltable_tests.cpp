@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include "sharedsignaltable.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct SharedSignalTableTests : public ::testing::Test {
+    SharedSignalTableTests()
+        : name("/candb_tests_" + std::to_string(getpid()))
+    {
+        db.messages[CANmessage{ 0x100, "A", 8 }] = {
+            CANsignal{ "counter", 0, 16, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+        };
+        db.messages[CANmessage{ 0x200, "B", 8 }] = {
+            CANsignal{ "low", 0, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+            CANsignal{ "scaled", 8, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 0.5, -10, 0, 0, "", {} },
+        };
+    }
+
+    std::string name;
+    CANdb_t db;
+};
+
+TEST_F(SharedSignalTableTests, schema_hash_follows_the_layout)
+{
+    const auto hash = CANdb::signalSchemaHash(db);
+    EXPECT_EQ(CANdb::signalSchemaHash(db), hash);
+
+    auto other = db;
+    other.messages.begin()->second[0].factor = 2;
+    EXPECT_NE(CANdb::signalSchemaHash(other), hash);
+
+    other = db;
+    other.messages[CANmessage{ 0x300, "C", 8 }] = {};
+    EXPECT_NE(CANdb::signalSchemaHash(other), hash);
+}
+
+TEST_F(SharedSignalTableTests, readers_see_published_values)
+{
+    EXPECT_THROW(CANdb::SharedSignalReader(name, db), std::runtime_error);
+
+    CANdb::SharedSignalWriter writer{ name, db };
+    const CANdb::Decoder decoder{ db };
+    std::vector<CANdb::DecodedSignal> signals;
+    const std::uint8_t data[8] = { 7, 40 };
+    const auto* plan = decoder.plan(0x200);
+    ASSERT_NE(plan, nullptr);
+    decoder.decode(*plan, data, sizeof data, signals);
+    writer.update(1000, *plan, signals);
+
+    const CANdb::SharedSignalReader reader{ name, db };
+    CANdb::SignalValue value;
+    ASSERT_TRUE(reader.read(reader.handle("B.scaled"), value));
+    EXPECT_DOUBLE_EQ(value.value, 10.0);
+    EXPECT_EQ(value.raw, 40u);
+    EXPECT_EQ(value.timestamp, 1000u);
+    EXPECT_EQ(value.updates, 1u);
+    EXPECT_FALSE(reader.read(reader.handle("A.counter"), value));
+
+    // Another process maps the same segment
+    const auto child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        const CANdb::SharedSignalReader other{ name, db };
+        CANdb::SignalValue seen;
+        const bool published
+            = other.read(other.handle("B.low"), seen) && seen.raw == 7;
+        _exit(published ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+TEST_F(SharedSignalTableTests, readers_reject_other_databases)
+{
+    const CANdb::SharedSignalWriter writer{ name, db };
+
+    auto other = db;
+    other.messages.begin()->second[0].offset = 1;
+    EXPECT_THROW(CANdb::SharedSignalReader(name, other), std::runtime_error);
+
+    other.messages[CANmessage{ 0x300, "C", 8 }] = {
+        CANsignal{ "x", 0, 8, CANsignalEndianness::LittleEndianIntel, false, 1,
+            0, 0, 0, "", {} },
+    };
+    EXPECT_THROW(CANdb::SharedSignalReader(name, other), std::runtime_error);
+}
+
+TEST_F(SharedSignalTableTests, readers_report_unsized_segments_as_not_ready)
+{
+    // A writer between creating and sizing the segment
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+    try {
+        CANdb::SharedSignalReader reader{ name, db };
+        ADD_FAILURE() << "An empty segment must not be opened";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string{ e.what() }.find("not ready"), std::string::npos);
+    }
+    shm_unlink(name.c_str());
+}
+
+TEST_F(SharedSignalTableTests, new_writers_leave_old_mappings_alone)
+{
+    CANdb::SharedSignalWriter old{ name, db };
+    old.update(old.handle("A.counter"), 1000, 1.0, 1);
+    const CANdb::SharedSignalReader reader{ name, db };
+
+    // A restarted producer with a smaller database
+    CANdb_t smaller;
+    smaller.messages[CANmessage{ 0x100, "A", 8 }]
+        = db.messages.begin()->second;
+    const CANdb::SharedSignalWriter writer{ name, smaller };
+
+    CANdb::SignalValue value;
+    ASSERT_TRUE(reader.read(reader.handle("A.counter"), value));
+    EXPECT_EQ(value.raw, 1u);
+    EXPECT_FALSE(reader.read(reader.handle("B.scaled"), value));
+    EXPECT_THROW(CANdb::SharedSignalReader(name, db), std::runtime_error);
+    EXPECT_NO_THROW(CANdb::SharedSignalReader(name, smaller));
+}
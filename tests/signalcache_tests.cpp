@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include "signalcache.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+#include <stdexcept>
+#include <thread>
+
+struct SignalCacheTests : public ::testing::Test {
+    SignalCacheTests()
+    {
+        db.messages[CANmessage{ 0x100, "A", 8 }] = {
+            CANsignal{ "counter", 0, 16, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+        };
+        db.messages[CANmessage{ 0x200, "B", 8 }] = {
+            CANsignal{ "low", 0, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+            CANsignal{ "scaled", 8, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 0.5, -10, 0, 0, "", {} },
+        };
+    }
+
+    CANdb_t db;
+};
+
+TEST_F(SignalCacheTests, handles_follow_the_database)
+{
+    const CANdb::Decoder decoder{ db };
+    const CANdb::SignalCache cache{ decoder };
+    EXPECT_EQ(cache.size(), 3u);
+    EXPECT_EQ(cache.handle("A.counter"), 0u);
+    EXPECT_EQ(cache.handle("B", "low"), 1u);
+    EXPECT_EQ(cache.handle("B.scaled"), 2u);
+    EXPECT_EQ(cache.firstHandle(0x200), 1u);
+    EXPECT_EQ(cache.firstHandle(0x300), CANdb::SignalCache::NO_HANDLE);
+    EXPECT_THROW(cache.handle("B.missing"), std::runtime_error);
+}
+
+TEST_F(SignalCacheTests, decoded_frames_update_the_slots)
+{
+    const CANdb::Decoder decoder{ db };
+    CANdb::SignalCache cache{ decoder };
+    const auto scaled = cache.handle("B.scaled");
+
+    CANdb::SignalValue value;
+    EXPECT_FALSE(cache.read(scaled, value));
+
+    std::vector<CANdb::DecodedSignal> signals;
+    const std::uint8_t data[8] = { 7, 40 };
+    const auto* plan = decoder.plan(0x200);
+    ASSERT_NE(plan, nullptr);
+    for (std::uint64_t timestamp : { 1000u, 2000u }) {
+        signals.clear();
+        decoder.decode(*plan, data, sizeof data, signals);
+        cache.update(timestamp, *plan, signals);
+    }
+
+    ASSERT_TRUE(cache.read(scaled, value));
+    EXPECT_DOUBLE_EQ(value.value, 10.0);
+    EXPECT_EQ(value.raw, 40u);
+    EXPECT_EQ(value.timestamp, 2000u);
+    EXPECT_EQ(value.updates, 2u);
+    ASSERT_TRUE(cache.read(cache.handle("B.low"), value));
+    EXPECT_EQ(value.raw, 7u);
+    EXPECT_FALSE(cache.read(cache.handle("A.counter"), value));
+}
+
+TEST_F(SignalCacheTests, frames_of_other_databases_are_ignored)
+{
+    const CANdb::Decoder decoder{ db };
+    CANdb::SignalCache cache{ decoder };
+
+    CANdb_t other;
+    other.messages[CANmessage{ 0x300, "C", 8 }] = {
+        CANsignal{ "x", 0, 8, CANsignalEndianness::LittleEndianIntel, false,
+            1, 0, 0, 0, "", {} },
+    };
+    const CANdb::Decoder otherDecoder{ other };
+    const auto* plan = otherDecoder.plan(0x300);
+    ASSERT_NE(plan, nullptr);
+
+    std::vector<CANdb::DecodedSignal> signals;
+    const std::uint8_t data[8] = { 1 };
+    otherDecoder.decode(*plan, data, sizeof data, signals);
+    ASSERT_EQ(signals.size(), 1u);
+    cache.update(1000, *plan, signals);
+
+    CANdb::SignalValue value;
+    for (std::uint32_t handle = 0; handle < cache.size(); ++handle) {
+        EXPECT_FALSE(cache.read(handle, value));
+    }
+}
+
+TEST_F(SignalCacheTests, readers_never_see_torn_values)
+{
+    const CANdb::Decoder decoder{ db };
+    CANdb::SignalCache cache{ decoder };
+    const std::uint64_t writes = 200000;
+
+    // Every write stores the same number in all fields
+    std::thread writer([&cache, writes] {
+        for (std::uint64_t i = 1; i <= writes; ++i) {
+            cache.update(static_cast<std::uint32_t>(i % 3), i,
+                static_cast<std::double_t>(i), i);
+        }
+    });
+
+    std::vector<std::thread> readers;
+    std::vector<std::uint64_t> torn(4, 0);
+    for (std::size_t r = 0; r < torn.size(); ++r) {
+        readers.emplace_back([&cache, &torn, r, writes] {
+            std::uint64_t last[3] = { 0, 0, 0 };
+            while (last[0] + 3 <= writes) {
+                for (std::uint32_t handle = 0; handle < 3; ++handle) {
+                    CANdb::SignalValue value;
+                    if (!cache.read(handle, value)) {
+                        continue;
+                    }
+                    if (value.raw != value.timestamp
+                        || value.value != static_cast<double>(value.raw)
+                        || value.updates != (value.raw + (3 - handle) % 3) / 3
+                        || value.raw < last[handle]) {
+                        ++torn[r];
+                    }
+                    last[handle] = value.raw;
+                }
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    for (auto count : torn) {
+        EXPECT_EQ(count, 0u);
+    }
+}
@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+
+#include "socketcan.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+#include <cstring>
+#include <ctime>
+#include <linux/can/raw.h>
+#include <memory>
+#include <net/if.h>
+#include <unistd.h>
+
+namespace {
+std::uint64_t now()
+{
+    timespec time;
+    clock_gettime(CLOCK_REALTIME, &time);
+    return static_cast<std::uint64_t>(time.tv_sec) * 1000000000u
+        + static_cast<std::uint64_t>(time.tv_nsec);
+}
+
+bool send(int socket, canid_t id, std::uint8_t size, bool fd)
+{
+    canfd_frame frame;
+    std::memset(&frame, 0, sizeof frame);
+    frame.can_id = id;
+    frame.len = size;
+    for (std::uint8_t i = 0; i < size; ++i) {
+        frame.data[i] = i;
+    }
+    const std::size_t length = fd ? CANFD_MTU : CAN_MTU;
+    return ::write(socket, &frame, length) == static_cast<ssize_t>(length);
+}
+
+// Source and a socket writing to it, on vcan0 if the interface exists and
+// on a socketpair otherwise
+struct Bus {
+    explicit Bus(const CANdb_t& db)
+    {
+        try {
+            source.reset(new CANdb::SocketCanSource("vcan0", db));
+            writer = ::socket(PF_CAN, SOCK_RAW, CAN_RAW);
+            const int enable = 1;
+            setsockopt(writer, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable,
+                sizeof enable);
+            sockaddr_can address;
+            std::memset(&address, 0, sizeof address);
+            address.can_family = AF_CAN;
+            address.can_ifindex = static_cast<int>(if_nametoindex("vcan0"));
+            vcan = bind(writer, reinterpret_cast<const sockaddr*>(&address),
+                       sizeof address)
+                == 0;
+        } catch (const std::runtime_error&) {
+        }
+        if (!vcan) {
+            int sockets[2];
+            EXPECT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets), 0);
+            source.reset(new CANdb::SocketCanSource(sockets[0], 4));
+            writer = sockets[1];
+        }
+    }
+
+    ~Bus() { closeWriter(); }
+
+    void closeWriter()
+    {
+        if (writer >= 0) {
+            ::close(writer);
+            writer = -1;
+        }
+    }
+
+    std::unique_ptr<CANdb::SocketCanSource> source;
+    int writer{ -1 };
+    bool vcan{ false };
+};
+} // namespace
+
+struct SocketCanTests : public ::testing::Test {
+    SocketCanTests()
+    {
+        db.messages[CANmessage{ 0x123, "Standard", 8 }] = {};
+        db.messages[CANmessage{ 0x18FEF100 | CANdb::CAN_EXTENDED_ID_FLAG,
+            "Extended", 64 }]
+            = {};
+    }
+
+    CANdb_t db;
+};
+
+TEST_F(SocketCanTests, filters_pass_the_database_messages)
+{
+    const auto filters = CANdb::socketCanFilters(db);
+    ASSERT_EQ(filters.size(), 2u);
+    EXPECT_EQ(filters[0].can_id, 0x123u);
+    EXPECT_EQ(filters[0].can_mask, CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG);
+    EXPECT_EQ(filters[1].can_id, 0x18FEF100u | CAN_EFF_FLAG);
+    EXPECT_EQ(filters[1].can_mask, CAN_EFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG);
+
+    // More messages than filters a socket takes pass everything
+    for (std::uint32_t id = 0; id < CAN_RAW_FILTER_MAX; ++id) {
+        db.messages[CANmessage{ 0x200 + id }] = {};
+    }
+    EXPECT_TRUE(CANdb::socketCanFilters(db).empty());
+}
+
+TEST_F(SocketCanTests, frames_arrive_in_batches)
+{
+    Bus bus{ db };
+    const auto before = now();
+    if (bus.vcan) {
+        // Not in the database, dropped by the kernel
+        ASSERT_TRUE(send(bus.writer, 0x124, 8, false));
+    }
+    ASSERT_TRUE(send(bus.writer, 0x123, 8, false));
+    ASSERT_TRUE(send(bus.writer, 0x18FEF100 | CAN_EFF_FLAG, 64, true));
+    ASSERT_TRUE(send(bus.writer, 0x123 | CAN_RTR_FLAG, 0, false));
+    ASSERT_TRUE(send(bus.writer, 0x123, 3, true));
+
+    CANdb::CANframe frames[8];
+    std::size_t received = 0;
+    while (received < 4) {
+        const auto count = bus.source->receive(frames + received, 8 - received);
+        ASSERT_NE(count, 0u);
+        received += count;
+    }
+    const auto after = now();
+    EXPECT_EQ(received, 4u);
+
+    EXPECT_EQ(frames[0].id, 0x123u);
+    EXPECT_FALSE(frames[0].extended);
+    EXPECT_FALSE(frames[0].fd);
+    ASSERT_EQ(frames[0].size, 8);
+    EXPECT_EQ(frames[0].data[7], 7);
+
+    EXPECT_EQ(frames[1].dbcId(), 0x98FEF100u);
+    EXPECT_TRUE(frames[1].fd);
+    ASSERT_EQ(frames[1].size, 64);
+    EXPECT_EQ(frames[1].data[63], 63);
+
+    EXPECT_TRUE(frames[2].remote);
+    EXPECT_TRUE(frames[3].fd);
+    EXPECT_EQ(frames[3].size, 3);
+
+    for (std::size_t i = 0; i < received; ++i) {
+        EXPECT_GE(frames[i].timestamp, before);
+        EXPECT_LE(frames[i].timestamp, after);
+        if (bus.vcan) {
+            EXPECT_EQ(CANdb::SocketCanSource::channelName(frames[i].channel),
+                "vcan0");
+        }
+    }
+}
+
+TEST_F(SocketCanTests, broken_datagrams_are_skipped)
+{
+    Bus bus{ db };
+    if (bus.vcan) {
+        // The kernel only passes well formed frames
+        return;
+    }
+    ASSERT_TRUE(send(bus.writer, 0x123 | CAN_ERR_FLAG, 8, false));
+    ASSERT_EQ(::write(bus.writer, "short", 5), 5);
+    ASSERT_TRUE(send(bus.writer, 0x123, 1, false));
+    bus.closeWriter();
+
+    CANdb::CANframe frame;
+    ASSERT_TRUE(bus.source->next(frame));
+    EXPECT_EQ(frame.id, 0x123u);
+    EXPECT_FALSE(bus.source->next(frame));
+    EXPECT_EQ(bus.source->received(), 3u);
+    EXPECT_EQ(bus.source->skipped(), 2u);
+}
+
+TEST_F(SocketCanTests, stop_ends_an_idle_source)
+{
+    Bus bus{ db };
+    bus.source->stop();
+    CANdb::CANframe frame;
+    EXPECT_FALSE(bus.source->next(frame));
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include "subscription.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+struct SubscriptionTests : public ::testing::Test {
+    SubscriptionTests()
+    {
+        db.messages[CANmessage{ 0x100, "ENGINE", 8 }] = {
+            CANsignal{ "rpm", 0, 16, CANsignalEndianness::LittleEndianIntel,
+                false, 0.25, 0, 0, 0, "", {} },
+            CANsignal{ "temperature", 16, 8,
+                CANsignalEndianness::LittleEndianIntel, false, 1, -40, 0, 0,
+                "", {} },
+            CANsignal{ "load", 24, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+        };
+        db.messages[CANmessage{ 0x200, "SENSORS", 8 }] = {
+            CANsignal{ "mux", 0, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {}, CANsignalMuxType::Muxer },
+            CANsignal{ "left", 8, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {}, CANsignalMuxType::Muxed, 0 },
+            CANsignal{ "right", 8, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {}, CANsignalMuxType::Muxed, 1 },
+        };
+        db.messages[CANmessage{ 0x300, "UNUSED", 8 }] = {
+            CANsignal{ "unused", 0, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {} },
+        };
+    }
+
+    CANdb_t db;
+};
+
+TEST_F(SubscriptionTests, handles)
+{
+    CANdb::SubscriptionBuilder builder{ db };
+    EXPECT_EQ(builder.subscribe("ENGINE.temperature"), 0u);
+    EXPECT_EQ(builder.subscribe("SENSORS", "right"), 1u);
+    EXPECT_EQ(builder.subscribe("ENGINE.rpm"), 2u);
+    EXPECT_EQ(builder.subscribe("ENGINE.temperature"), 0u);
+
+    EXPECT_THROW(builder.subscribe("ENGINE"), std::runtime_error);
+    EXPECT_THROW(builder.subscribe("MISSING.rpm"), std::runtime_error);
+    EXPECT_THROW(builder.subscribe("ENGINE.missing"), std::runtime_error);
+
+    const auto subscription = builder.build();
+    EXPECT_EQ(subscription.size(), 3u);
+    EXPECT_EQ(subscription.ids(), (std::vector<std::uint32_t>{ 0x100, 0x200 }));
+}
+
+TEST_F(SubscriptionTests, decode_into_array)
+{
+    CANdb::SubscriptionBuilder builder{ db };
+    const auto temperature = builder.subscribe("ENGINE.temperature");
+    const auto rpm = builder.subscribe("ENGINE.rpm");
+    const auto right = builder.subscribe("SENSORS.right");
+    auto subscription = builder.build();
+
+    std::vector<std::double_t> values(subscription.size(), -1);
+    const std::uint8_t engine[]{ 0x40, 0x1F, 100, 50, 0, 0, 0, 0 };
+    ASSERT_TRUE(
+        subscription.decode(0x100, engine, sizeof(engine), values.data()));
+    EXPECT_DOUBLE_EQ(values[temperature], 60);
+    EXPECT_DOUBLE_EQ(values[rpm], 2000);
+    EXPECT_DOUBLE_EQ(values[right], -1);
+
+    // Only the subscribed branch of the multiplexor writes a value
+    std::uint8_t sensors[]{ 0, 7, 0, 0, 0, 0, 0, 0 };
+    ASSERT_TRUE(
+        subscription.decode(0x200, sensors, sizeof(sensors), values.data()));
+    EXPECT_DOUBLE_EQ(values[right], -1);
+    sensors[0] = 1;
+    ASSERT_TRUE(
+        subscription.decode(0x200, sensors, sizeof(sensors), values.data()));
+    EXPECT_DOUBLE_EQ(values[right], 7);
+
+    EXPECT_FALSE(subscription.decode(0x300, engine, 8, values.data()));
+    EXPECT_FALSE(subscription.decode(0x400, engine, 8, values.data()));
+}
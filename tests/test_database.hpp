@@ -0,0 +1,27 @@
+#ifndef TEST_DATABASE_HPP_K3VQ8ZRT
+#define TEST_DATABASE_HPP_K3VQ8ZRT
+
+#include "cantypes.hpp"
+
+namespace test_data {
+// 8 bit little endian signal received by "ECU"
+inline CANsignal signal(const std::string& name, std::uint16_t startBit,
+    std::double_t factor = 1)
+{
+    return CANsignal{ name, startBit, 8, CANsignalEndianness::LittleEndianIntel,
+        false, factor, 0, 0, 255, "", { "ECU" } };
+}
+
+// ENGINE (0x100) with speed, temp and load, BRAKES (0x200) with pressure
+inline CANdb_t engineAndBrakes()
+{
+    CANdb_t db;
+    db.messages[CANmessage{ 0x100, "ENGINE", 8, { "ECM" }, 10 }]
+        = { signal("speed", 0), signal("temp", 8), signal("load", 16) };
+    db.messages[CANmessage{ 0x200, "BRAKES", 8, { "ABS" } }]
+        = { signal("pressure", 0) };
+    return db;
+}
+} // namespace test_data
+
+#endif /* end of include guard: TEST_DATABASE_HPP_K3VQ8ZRT */
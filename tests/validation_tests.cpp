@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include "validation.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+
+#include <limits>
+
+namespace {
+bool marked(const std::vector<std::uint64_t>& bitmap, std::size_t i)
+{
+    return (bitmap[i / 64] >> (i % 64) & 1) != 0;
+}
+} // namespace
+
+struct ValidationTests : public ::testing::Test {
+    ValidationTests()
+    {
+        db.messages[CANmessage{ 0x100, "A", 8 }] = {
+            CANsignal{ "scaled", 0, 16, CANsignalEndianness::LittleEndianIntel,
+                false, 0.1, 0, 0, 100.1, "", {} },
+            CANsignal{ "state", 16, 8, CANsignalEndianness::LittleEndianIntel,
+                false, 1, 0, 0, 0, "", {}, CANsignalMuxType::NotMuxed,
+                boost::none, boost::none, boost::none, boost::none,
+                CANvalueDescriptions_t{ { 0, "Off" }, { 1, "On" },
+                    { 2, "Error" } } },
+            CANsignal{ "gear", 24, 8, CANsignalEndianness::LittleEndianIntel,
+                true, 1, 0, -1, 6, "", {}, CANsignalMuxType::NotMuxed,
+                boost::none, boost::none, boost::none, boost::none,
+                CANvalueDescriptions_t{ { -1, "R" }, { 0, "N" }, { 1, "1" },
+                    { 3, "3" }, { 6, "6" } } },
+        };
+    }
+
+    CANdb_t db;
+};
+
+TEST_F(ValidationTests, range_bitmaps)
+{
+    // Covers full words, a tail and the scalar remainder of odd counts
+    std::vector<std::double_t> values(131, 5.0);
+    values[0] = -0.5;
+    values[63] = 10.5;
+    values[64] = std::numeric_limits<std::double_t>::quiet_NaN();
+    values[130] = 11;
+    values[129] = 10;
+    std::vector<std::uint64_t> bitmap(CANdb::bitmapWords(values.size()), ~0u);
+    ASSERT_EQ(bitmap.size(), 3u);
+
+    EXPECT_EQ(CANdb::checkRange(
+                  values.data(), values.size(), 0, 10, bitmap.data()),
+        4u);
+    EXPECT_EQ(bitmap[0], std::uint64_t{ 1 } | std::uint64_t{ 1 } << 63);
+    EXPECT_EQ(bitmap[1], 1u);
+    EXPECT_EQ(bitmap[2], 4u);
+}
+
+TEST_F(ValidationTests, membership_bitmaps)
+{
+    std::vector<std::double_t> small{ 1, 2, 4 };
+    std::vector<std::double_t> large;
+    for (int i = 0; i < 40; ++i) {
+        large.push_back(i * 2);
+    }
+    std::vector<std::double_t> values;
+    for (int i = 0; i < 70; ++i) {
+        values.push_back(i);
+    }
+    std::vector<std::uint64_t> bitmap(CANdb::bitmapWords(values.size()));
+
+    EXPECT_EQ(CANdb::checkMembership(values.data(), values.size(),
+                  small.data(), small.size(), bitmap.data()),
+        67u);
+    EXPECT_TRUE(marked(bitmap, 0));
+    EXPECT_FALSE(marked(bitmap, 1));
+    EXPECT_FALSE(marked(bitmap, 4));
+    EXPECT_TRUE(marked(bitmap, 69));
+    EXPECT_EQ(bitmap[1] >> 6, 0u);
+
+    EXPECT_EQ(CANdb::checkMembership(values.data(), values.size(),
+                  large.data(), large.size(), bitmap.data()),
+        35u);
+    EXPECT_EQ(bitmap[0], 0xAAAAAAAAAAAAAAAAu);
+    EXPECT_EQ(bitmap[1], 0x2Au);
+}
+
+TEST_F(ValidationTests, validates_decoded_columns)
+{
+    const CANdb::Decoder decoder{ db };
+    const auto& plan = *decoder.plan(0x100);
+
+    const std::size_t count = 100;
+    std::vector<std::uint8_t> payloads(8 * count, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto* payload = &payloads[8 * i];
+        // Raw 0..1099, the last 98 are above 100.1
+        const auto scaled = static_cast<std::uint16_t>(i * 11);
+        payload[0] = static_cast<std::uint8_t>(scaled);
+        payload[1] = static_cast<std::uint8_t>(scaled >> 8);
+        payload[2] = static_cast<std::uint8_t>(i % 4);
+        payload[3] = static_cast<std::uint8_t>(static_cast<int>(i % 9) - 2);
+    }
+
+    std::vector<std::double_t> column(count);
+    std::vector<std::uint64_t> outOfRange(CANdb::bitmapWords(count));
+    std::vector<std::uint64_t> undescribed(CANdb::bitmapWords(count));
+
+    CANdb::SignalValidator scaled{ plan, 0 };
+    EXPECT_TRUE(scaled.checksRange());
+    EXPECT_FALSE(scaled.checksValues());
+    CANdb::decodeColumn(plan.plans[0], payloads.data(), 8, count,
+        column.data());
+    scaled.validate(
+        column.data(), count, outOfRange.data(), undescribed.data());
+    // 91 * 1.1 = 100.1 passes although 1001 * 0.1 is not exactly 100.1
+    EXPECT_FALSE(marked(outOfRange, 91));
+    EXPECT_TRUE(marked(outOfRange, 92));
+    EXPECT_EQ(scaled.outOfRange(), 8u);
+    EXPECT_EQ(scaled.undescribed(), 0u);
+    EXPECT_EQ(undescribed[0], 0u);
+
+    // Consecutive values 0..2, no range
+    CANdb::SignalValidator state{ plan, 1 };
+    EXPECT_FALSE(state.checksRange());
+    EXPECT_TRUE(state.checksValues());
+    CANdb::decodeColumn(plan.plans[1], payloads.data(), 8, count,
+        column.data());
+    state.validate(column.data(), count, nullptr, undescribed.data());
+    EXPECT_EQ(state.undescribed(), 25u);
+    EXPECT_TRUE(marked(undescribed, 3));
+    EXPECT_FALSE(marked(undescribed, 4));
+    EXPECT_EQ(state.signal().signal_name, "state");
+
+    // Sparse signed values -1, 0, 1, 3 and 6 in the range -1..6
+    CANdb::SignalValidator gear{ plan, 2 };
+    CANdb::decodeColumn(plan.plans[2], payloads.data(), 8, count,
+        column.data());
+    gear.validate(column.data(), count, outOfRange.data(), undescribed.data());
+    EXPECT_TRUE(marked(outOfRange, 0));
+    EXPECT_TRUE(marked(undescribed, 0));
+    EXPECT_FALSE(marked(undescribed, 1));
+    EXPECT_TRUE(marked(undescribed, 4));
+    EXPECT_FALSE(marked(undescribed, 5));
+    // Out of range: -2 each 9 values. Undescribed: -2, 2, 4 and 5.
+    EXPECT_EQ(gear.outOfRange(), 12u);
+    EXPECT_EQ(gear.undescribed(), 45u);
+    EXPECT_EQ(gear.values(), count);
+}
@@ -0,0 +1,383 @@
+#include <atomic>
+#include <chrono>
+#include <cxxopts.hpp>
+#include <fstream>
+#include <spdlog/fmt/fmt.h>
+
+#include "dbcparser.h"
+#include "dbview.h"
+#include "decoder.h"
+#include "log.hpp"
+#include "paralleldecoder.h"
+#include "signalcache.h"
+
+#include <functional>
+#include <thread>
+
+namespace {
+std::string loadDBCFile(const std::string& filename)
+{
+    std::fstream file{ filename.c_str() };
+
+    if (!file.good()) {
+        throw std::runtime_error(
+            fmt::format("File {} does not exists", filename));
+    }
+
+    std::string buff;
+    std::copy(std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>(), std::back_inserter(buff));
+
+    file.close();
+    return buff;
+}
+
+bool endsWith(const std::string& text, const std::string& suffix)
+{
+    return text.size() >= suffix.size()
+        && text.compare(text.size() - suffix.size(), suffix.size(), suffix)
+        == 0;
+}
+
+struct Run {
+    double seconds;
+    std::uint64_t frames;
+    // Sum of the decoded values, keeps the sink from being optimized away
+    double checksum;
+};
+
+// Best of `repeat` chunked decodes of the log
+Run measure(const std::string& input,
+    CANdb::ParallelLogDecoder::Format format, const CANdb::Decoder& decoder,
+    unsigned threads, std::size_t chunkSize, unsigned repeat)
+{
+    Run best{ 0, 0, 0 };
+    for (unsigned i = 0; i < repeat; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        CANdb::ParallelLogDecoder chunked{ input, format, decoder, threads,
+            chunkSize };
+        double checksum = 0;
+        chunked.run([&checksum](const CANdb::CANframe&,
+                        const CANdb::MessagePlan&,
+                        const std::vector<CANdb::DecodedSignal>& signals) {
+            for (const auto& signal : signals) {
+                checksum += signal.value;
+            }
+        });
+        const std::chrono::duration<double> elapsed
+            = std::chrono::steady_clock::now() - start;
+        if (i == 0 || elapsed.count() < best.seconds) {
+            best = Run{ elapsed.count(), chunked.frames(), checksum };
+        }
+    }
+    return best;
+}
+
+void benchmarkChunked(const std::string& input,
+    CANdb::ParallelLogDecoder::Format format, const CANdb::Decoder& decoder,
+    unsigned maxThreads, std::size_t chunkSize, unsigned repeat)
+{
+    std::cout << fmt::format("{:>7} {:>10} {:>14} {:>8}", "threads",
+                     "seconds", "frames/s", "speedup")
+              << std::endl;
+    double baseline = 0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        const auto run
+            = measure(input, format, decoder, threads, chunkSize, repeat);
+        if (threads == 1) {
+            baseline = run.seconds;
+        }
+        std::cout << fmt::format("{:>7} {:>10.3f} {:>14.0f} {:>7.2f}x",
+                         threads, run.seconds,
+                         run.seconds > 0 ? run.frames / run.seconds : 0.0,
+                         run.seconds > 0 ? baseline / run.seconds : 0.0)
+                  << std::endl;
+    }
+}
+
+// Decoded frame of the log, replayed into the cache
+struct Update {
+    std::uint64_t timestamp;
+    const CANdb::MessagePlan* plan;
+    std::vector<CANdb::DecodedSignal> signals;
+};
+
+// Signal updates per second of one writer replaying the log into a
+// SignalCache, and reads per second of `readers` threads sweeping all
+// handles, first without and then with the readers
+void benchmarkCache(const std::string& input,
+    CANdb::ParallelLogDecoder::Format format, const CANdb::Decoder& decoder,
+    unsigned readers, double seconds)
+{
+    // At most a million frames are kept in memory
+    std::vector<Update> updates;
+    CANdb::ParallelLogDecoder chunked{ input, format, decoder, 0 };
+    chunked.run([&updates](const CANdb::CANframe& frame,
+                    const CANdb::MessagePlan& plan,
+                    const std::vector<CANdb::DecodedSignal>& signals) {
+        if (updates.size() < 1000000) {
+            updates.push_back(Update{ frame.timestamp, &plan, signals });
+        }
+    });
+    CANdb::SignalCache cache{ decoder };
+    if (updates.empty() || cache.size() == 0) {
+        throw std::runtime_error("The log has no signals of the database");
+    }
+
+    std::cout << fmt::format("{:>7} {:>14} {:>14}", "readers", "updates/s",
+                     "reads/s")
+              << std::endl;
+    for (unsigned count : { 0u, readers }) {
+        std::atomic<bool> running{ true };
+        std::atomic<std::uint64_t> reads{ 0 };
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < count; ++i) {
+            threads.emplace_back([&cache, &running, &reads, i] {
+                std::uint64_t done = 0;
+                std::uint32_t handle = i;
+                CANdb::SignalValue value;
+                while (running.load(std::memory_order_relaxed)) {
+                    handle = handle + 1 < cache.size() ? handle + 1 : 0;
+                    cache.read(handle, value);
+                    ++done;
+                }
+                reads.fetch_add(done, std::memory_order_relaxed);
+            });
+        }
+
+        std::uint64_t written = 0;
+        const auto start = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed{ 0 };
+        while (elapsed.count() < seconds) {
+            for (const auto& update : updates) {
+                cache.update(update.timestamp, *update.plan, update.signals);
+                written += update.signals.size();
+            }
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+        running = false;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        std::cout << fmt::format("{:>7} {:>14.0f} {:>14.0f}", count,
+                         written / elapsed.count(),
+                         reads.load() / elapsed.count())
+                  << std::endl;
+    }
+}
+
+// Copies the messages of the database under new ids until it holds at least
+// `signals` signals
+CANdb_t replicate(const CANdb_t& db, std::size_t signals)
+{
+    CANdb_t copy = db;
+    std::size_t count = 0;
+    for (const auto& message : db.messages) {
+        count += message.second.size();
+    }
+    // Extended ids from 0x10000000 on
+    std::uint32_t copies = 0;
+    while (count != 0 && count < signals) {
+        for (const auto& message : db.messages) {
+            auto renamed = message.first;
+            renamed.id = CANdb::CAN_EXTENDED_ID_FLAG | (0x10000000 + copies);
+            renamed.name += "_" + std::to_string(copies++);
+            copy.messages[renamed] = message.second;
+            count += message.second.size();
+        }
+    }
+    return copy;
+}
+
+// Nanoseconds per signal of scans over the layout and scaling of every
+// signal, through the CANdb_t maps and through a DbView
+void benchmarkView(const CANdb_t& source, std::size_t signals, unsigned repeat)
+{
+    const auto db = replicate(source, signals);
+    auto start = std::chrono::steady_clock::now();
+    const CANdb::DbView view{ db };
+    const std::chrono::duration<double> build
+        = std::chrono::steady_clock::now() - start;
+    if (view.signalCount() == 0) {
+        throw std::runtime_error("The database has no signals");
+    }
+    std::cout << fmt::format("{} messages, {} signals, view built in {:.1f} ms",
+                     view.messageCount(), view.signalCount(),
+                     build.count() * 1000)
+              << std::endl;
+
+    // At least 50M signals per measurement
+    const auto passes
+        = std::max<std::size_t>(1, 50000000 / view.signalCount());
+    const auto measure = [&](const std::function<double()>& scan) {
+        double best = 0;
+        double checksum = 0;
+        for (unsigned i = 0; i < repeat; ++i) {
+            start = std::chrono::steady_clock::now();
+            for (std::size_t pass = 0; pass < passes; ++pass) {
+                checksum += scan();
+            }
+            const std::chrono::duration<double> elapsed
+                = std::chrono::steady_clock::now() - start;
+            if (i == 0 || elapsed.count() < best) {
+                best = elapsed.count();
+            }
+        }
+        return std::make_pair(
+            best * 1e9 / (passes * view.signalCount()), checksum);
+    };
+
+    const auto maps = measure([&db] {
+        double sum = 0;
+        for (const auto& message : db.messages) {
+            for (const auto& signal : message.second) {
+                sum += signal.startBit + signal.signalSize
+                    + signal.factor * signal.offset;
+            }
+        }
+        return sum;
+    });
+    const auto arrays = measure([&view] {
+        const auto& starts = view.startBits();
+        const auto& sizes = view.sizes();
+        const auto& factors = view.factors();
+        const auto& offsets = view.offsets();
+        double sum = 0;
+        for (std::size_t i = 0; i < starts.size(); ++i) {
+            sum += starts[i] + sizes[i] + factors[i] * offsets[i];
+        }
+        return sum;
+    });
+
+    std::cout << fmt::format("{:>7} {:>10} {:>8}", "layout", "ns/signal",
+                     "speedup")
+              << std::endl;
+    std::cout << fmt::format(
+                     "{:>7} {:>10.2f} {:>7.2f}x", "maps", maps.first, 1.0)
+              << std::endl;
+    std::cout << fmt::format("{:>7} {:>10.2f} {:>7.2f}x", "view",
+                     arrays.first, maps.first / arrays.first)
+              << std::endl;
+    if (maps.second != arrays.second) {
+        throw std::runtime_error("Scans disagree");
+    }
+}
+} // namespace
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options(argv[0],
+        "measure chunk-parallel decoding and the signal cache on candump and "
+        "ASC logs");
+    std::string benchmark;
+    std::string input;
+    std::string logFormat;
+    unsigned maxThreads = 32;
+    unsigned repeat = 3;
+    std::size_t chunkSize = CANdb::ParallelLogDecoder::DEFAULT_CHUNK;
+    unsigned readers = 16;
+    double seconds = 2;
+    std::size_t signals = 100000;
+    // clang-format off
+    options.add_options()
+    ("b,benchmark", "chunked: decoding speedup over 1 to --max-threads "
+        "threads, cache: signal cache updates against --readers readers, "
+        "view: database scans through the maps and a DbView",
+        cxxopts::value<std::string>(benchmark)->default_value("chunked"),
+        "name")
+    ("d,dbc", "DBC file", cxxopts::value<std::string>(), "[path to file]")
+    ("i,input", "candump -l or ASC log", cxxopts::value<std::string>(input),
+        "[path]")
+    ("l,log-format", "Log format, candump or asc, by default by extension",
+        cxxopts::value<std::string>(logFormat), "format")
+    ("t,max-threads", "Largest thread count, runs double from 1",
+        cxxopts::value<unsigned>(maxThreads), "N")
+    ("chunk-size", "Bytes per chunk",
+        cxxopts::value<std::size_t>(chunkSize), "N")
+    ("r,repeat", "Runs per thread count, the fastest is reported",
+        cxxopts::value<unsigned>(repeat), "N")
+    ("readers", "Reader threads of the cache benchmark",
+        cxxopts::value<unsigned>(readers), "N")
+    ("seconds", "Duration of each cache benchmark run",
+        cxxopts::value<double>(seconds), "N")
+    ("signals", "Signals of the view benchmark, the messages of the DBC file "
+        "are copied to reach them",
+        cxxopts::value<std::size_t>(signals), "N")
+    ("h,help", "show help message");
+    // clang-format on
+
+    try {
+        const auto res = options.parse(argc, argv);
+
+        if (res.count("h") != 0) {
+            std::cout << options.help({ "" }) << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if (logFormat.empty()) {
+            logFormat = endsWith(input, ".asc") ? "asc" : "candump";
+        }
+        if (res.count("d") == 0 || (input.empty() && benchmark != "view")
+            || (logFormat != "candump" && logFormat != "asc")
+            || (benchmark != "chunked" && benchmark != "cache"
+                && benchmark != "view")
+            || repeat == 0 || maxThreads == 0) {
+            std::cerr << options.help({ "" }) << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        CANdb::DBCParser parser;
+        if (!parser.parse(loadDBCFile(res["d"].as<std::string>()))) {
+            std::cerr << "Failed to parse DBC file" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (benchmark == "view") {
+            benchmarkView(parser.getDb(), signals, repeat);
+            return EXIT_SUCCESS;
+        }
+        const CANdb::Decoder decoder{ parser.getDb() };
+        const auto format = logFormat == "asc"
+            ? CANdb::ParallelLogDecoder::Format::Asc
+            : CANdb::ParallelLogDecoder::Format::Candump;
+
+        if (benchmark == "cache") {
+            benchmarkCache(input, format, decoder, readers, seconds);
+        } else {
+            benchmarkChunked(
+                input, format, decoder, maxThreads, chunkSize, repeat);
+        }
+    } catch (const cxxopts::option_not_exists_exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        std::cerr << options.help({ "" }) << std::endl;
+        return EXIT_FAILURE;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,618 @@
+#include <chrono>
+#include <cmath>
+#include <cxxopts.hpp>
+#include <fstream>
+#include <mutex>
+#include <spdlog/fmt/fmt.h>
+#include <thread>
+
+#include "ascreader.h"
+#include "blfreader.h"
+#include "candump.h"
+#include "columnarwriter.h"
+#include "dbcparser.h"
+#include "decoder.h"
+#include "log.hpp"
+#include "paralleldecoder.h"
+#include "pipeline.h"
+
+#ifndef _WIN32
+#include "sharedsignaltable.h"
+#endif
+#ifdef __linux__
+#include "socketcan.h"
+#include <csignal>
+#include <map>
+#endif
+
+namespace {
+// Output is collected and written in blocks of this size
+const std::size_t OUTPUT_BLOCK{ 1 << 16 };
+
+std::string loadDBCFile(const std::string& filename)
+{
+    std::fstream file{ filename.c_str() };
+
+    if (!file.good()) {
+        throw std::runtime_error(
+            fmt::format("File {} does not exists", filename));
+    }
+
+    std::string buff;
+    std::copy(std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>(), std::back_inserter(buff));
+
+    file.close();
+    return buff;
+}
+
+struct Output {
+    explicit Output(std::FILE* _file)
+        : file(_file)
+    {
+        buffer.reserve(2 * OUTPUT_BLOCK);
+    }
+
+    ~Output() { flush(); }
+
+    void append(const std::string& text)
+    {
+        buffer += text;
+        if (buffer.size() >= OUTPUT_BLOCK) {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        std::fwrite(buffer.data(), 1, buffer.size(), file);
+        buffer.clear();
+    }
+
+    std::FILE* file;
+    std::string buffer;
+};
+
+std::string formatValue(std::double_t value)
+{
+    return std::isfinite(value) ? fmt::format("{}", value) : "null";
+}
+
+void writeCsv(Output& output, const CANdb::CANframe& frame,
+    const std::string& channel, const CANdb::MessagePlan& plan,
+    const std::vector<CANdb::DecodedSignal>& signals)
+{
+    for (const auto& signal : signals) {
+        output.append(fmt::format("{:.6f},{},{:X},{},{},{}\n",
+            frame.timestamp / 1e9, channel, frame.id, plan.message->name,
+            signal.signal->signal_name, formatValue(signal.value)));
+    }
+}
+
+void writeJson(Output& output, const CANdb::CANframe& frame,
+    const std::string& channel, const CANdb::MessagePlan& plan,
+    const std::vector<CANdb::DecodedSignal>& signals)
+{
+    output.append(fmt::format(
+        "{{\"timestamp\":{:.6f},\"channel\":\"{}\",\"id\":{},"
+        "\"message\":\"{}\",\"signals\":{{",
+        frame.timestamp / 1e9, channel, frame.id, plan.message->name));
+    for (std::size_t i = 0; i < signals.size(); ++i) {
+        output.append(fmt::format("{}\"{}\":{}", i == 0 ? "" : ",",
+            signals[i].signal->signal_name, formatValue(signals[i].value)));
+    }
+    output.append("}}\n");
+}
+
+std::string channelName(
+    const CANdb::CandumpReader& reader, const CANdb::CANframe& frame)
+{
+    return reader.channels()[frame.channel];
+}
+
+std::string channelName(const CANdb::AscReader&, const CANdb::CANframe& frame)
+{
+    return std::to_string(frame.channel);
+}
+
+std::string channelName(const CANdb::BlfReader&, const CANdb::CANframe& frame)
+{
+    return std::to_string(frame.channel);
+}
+
+#ifdef __linux__
+// Interface names of a live source, looked up once per interface
+struct InterfaceNames {
+    const std::string& name(std::uint16_t channel) const
+    {
+        auto it = names.find(channel);
+        if (it == names.end()) {
+            it = names
+                     .emplace(channel,
+                         CANdb::SocketCanSource::channelName(channel))
+                     .first;
+        }
+        return it->second;
+    }
+
+    mutable std::map<std::uint16_t, std::string> names;
+};
+
+std::string channelName(
+    const InterfaceNames& names, const CANdb::CANframe& frame)
+{
+    return names.name(frame.channel);
+}
+
+// Live source stopped by SIGINT and SIGTERM
+CANdb::SocketCanSource* liveSource{ nullptr };
+
+void stopLiveSource(int)
+{
+    if (liveSource != nullptr) {
+        liveSource->stop();
+    }
+}
+#endif
+
+std::string channelName(
+    const CANdb::ParallelLogDecoder& decoder, const CANdb::CANframe& frame)
+{
+    // ASC logs have channel numbers instead of names
+    return decoder.channels().empty() ? std::to_string(frame.channel)
+                                      : decoder.channels()[frame.channel];
+}
+
+// Channel names of a candump log read on the pipeline's reader thread. The
+// reader publishes new names under the lock, the writer takes a copy when it
+// meets a channel it does not know yet.
+struct SharedChannels {
+    explicit SharedChannels(const CANdb::CandumpReader& reader)
+        : reader(reader)
+    {
+    }
+
+    // Reader thread
+    void publish()
+    {
+        if (reader.channels().size() != known) {
+            std::lock_guard<std::mutex> lock(mutex);
+            published = reader.channels();
+            known = published.size();
+        }
+    }
+
+    // Writer thread
+    const std::string& name(std::uint16_t channel) const
+    {
+        if (channel >= names.size()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            names = published;
+        }
+        return names[channel];
+    }
+
+private:
+    const CANdb::CandumpReader& reader;
+    std::size_t known{ 0 };
+    mutable std::mutex mutex;
+    std::vector<std::string> published;
+    mutable std::vector<std::string> names;
+};
+
+std::string channelName(
+    const SharedChannels& channels, const CANdb::CANframe& frame)
+{
+    return channels.name(frame.channel);
+}
+
+struct Counters {
+    std::uint64_t frames;
+    std::uint64_t decoded;
+    std::uint64_t skipped;
+};
+
+// CSV or JSON lines
+struct TextSink {
+    Output& writer;
+    bool json;
+
+    template <typename Reader>
+    void operator()(const Reader& reader, const CANdb::CANframe& frame,
+        const CANdb::MessagePlan& plan,
+        const std::vector<CANdb::DecodedSignal>& signals)
+    {
+        const auto channel = channelName(reader, frame);
+        if (json) {
+            writeJson(writer, frame, channel, plan, signals);
+        } else {
+            writeCsv(writer, frame, channel, plan, signals);
+        }
+    }
+};
+
+// Arrow files per message
+struct ColumnarSink {
+    CANdb::ColumnarWriter& writer;
+
+    template <typename Reader>
+    void operator()(const Reader&, const CANdb::CANframe& frame,
+        const CANdb::MessagePlan& plan,
+        const std::vector<CANdb::DecodedSignal>& signals)
+    {
+        writer.append(frame.timestamp, plan, signals);
+    }
+};
+
+#ifndef _WIN32
+// Latest values in shared memory
+struct SharedSink {
+    CANdb::SharedSignalWriter& writer;
+
+    template <typename Reader>
+    void operator()(const Reader&, const CANdb::CANframe& frame,
+        const CANdb::MessagePlan& plan,
+        const std::vector<CANdb::DecodedSignal>& signals)
+    {
+        writer.update(frame.timestamp, plan, signals);
+    }
+};
+#endif
+
+// Decodes on the calling thread, `names` resolves the channel names
+template <typename Reader, typename Names, typename Sink>
+Counters decodeLog(
+    Reader& reader, Names& names, const CANdb::Decoder& decoder, Sink& sink)
+{
+    Counters counters{ 0, 0, 0 };
+    CANdb::CANframe frame;
+    std::vector<CANdb::DecodedSignal> signals;
+    while (reader.next(frame)) {
+        ++counters.frames;
+        const auto* plan = decoder.plan(frame.dbcId());
+        if (plan == nullptr) {
+            continue;
+        }
+
+        ++counters.decoded;
+        signals.clear();
+        decoder.decode(*plan, frame.data, frame.size, signals);
+        sink(names, frame, *plan, signals);
+    }
+    counters.skipped = reader.skipped();
+    return counters;
+}
+
+void publish(SharedChannels& channels) { channels.publish(); }
+
+// Readers resolving channel names without state need nothing published
+template <typename Reader> void publish(const Reader&) {}
+
+void printStats(const CANdb::PipelineStats& stats)
+{
+    const auto stage = [](const char* name,
+                           const CANdb::PipelineStats::Stage& counters) {
+        std::cerr << fmt::format("{}: {} frames, {} batches, {} stalls", name,
+                         counters.frames, counters.batches, counters.stalls)
+                  << std::endl;
+    };
+    stage("reader", stats.reader);
+    stage("decoder", stats.decoder);
+    stage("writer", stats.writer);
+    std::cerr << fmt::format("queued batches: decode {:.1f} (max {}), write "
+                             "{:.1f} (max {})",
+                     stats.meanDecodeQueue, stats.maxDecodeQueue,
+                     stats.meanWriteQueue, stats.maxWriteQueue)
+              << std::endl;
+}
+
+// Decodes on a reader -> workers -> writer pipeline, `names` resolves the
+// channel names on the writer thread
+template <typename Reader, typename Names, typename Sink>
+Counters decodePipelined(Reader& reader, Names& names,
+    const CANdb::Decoder& decoder, const CANdb::PipelineOptions& options,
+    Sink& sink)
+{
+    CANdb::DecodePipeline pipeline{ decoder, options };
+    pipeline.run(
+        [&reader, &names](CANdb::CANframe& frame) {
+            if (!reader.next(frame)) {
+                return false;
+            }
+            publish(names);
+            return true;
+        },
+        [&names, &sink](const CANdb::CANframe& frame,
+            const CANdb::MessagePlan& plan,
+            const std::vector<CANdb::DecodedSignal>& signals) {
+            sink(names, frame, plan, signals);
+        });
+
+    const auto stats = pipeline.stats();
+    printStats(stats);
+    return Counters{ stats.reader.frames, stats.decoded, reader.skipped() };
+}
+
+template <typename Reader, typename Sink>
+Counters decode(Reader& reader, const CANdb::Decoder& decoder,
+    const CANdb::PipelineOptions& options, Sink& sink)
+{
+    if (options.workers == 0) {
+        return decodeLog(reader, reader, decoder, sink);
+    }
+    return decodePipelined(reader, reader, decoder, options, sink);
+}
+
+template <typename Sink>
+Counters decode(CANdb::CandumpReader& reader, const CANdb::Decoder& decoder,
+    const CANdb::PipelineOptions& options, Sink& sink)
+{
+    if (options.workers == 0) {
+        return decodeLog(reader, reader, decoder, sink);
+    }
+    SharedChannels channels{ reader };
+    return decodePipelined(reader, channels, decoder, options, sink);
+}
+
+#ifdef __linux__
+// Decodes until the source is stopped
+template <typename Sink>
+Counters decode(CANdb::SocketCanSource& source, const CANdb::Decoder& decoder,
+    const CANdb::PipelineOptions& options, Sink& sink)
+{
+    InterfaceNames names;
+    liveSource = &source;
+    std::signal(SIGINT, stopLiveSource);
+    std::signal(SIGTERM, stopLiveSource);
+    const auto counters = options.workers == 0
+        ? decodeLog(source, names, decoder, sink)
+        : decodePipelined(source, names, decoder, options, sink);
+    liveSource = nullptr;
+
+    if (source.dropped() != 0) {
+        std::cerr << fmt::format(
+                         "{} frames dropped by the kernel", source.dropped())
+                  << std::endl;
+    }
+    return counters;
+}
+#endif
+
+// Workers 0 decodes on the calling thread
+template <typename Sink>
+Counters decodeInput(const std::string& logFormat, const std::string& input,
+    std::FILE* in, const CANdb::Decoder& decoder,
+    const CANdb::PipelineOptions& options, Sink& sink)
+{
+    if (logFormat == "blf") {
+        CANdb::BlfReader reader{ input,
+            std::thread::hardware_concurrency() > 1 ? 1u : 0u };
+        return decode(reader, decoder, options, sink);
+    }
+    if (logFormat == "asc") {
+        CANdb::AscReader reader{ in };
+        return decode(reader, decoder, options, sink);
+    }
+#ifdef __linux__
+    if (logFormat == "socketcan") {
+        CANdb::SocketCanSource source{ input, decoder.db() };
+        return decode(source, decoder, options, sink);
+    }
+#endif
+    CANdb::CandumpReader reader{ in };
+    return decode(reader, decoder, options, sink);
+}
+
+// Decodes a candump or ASC file in chunks, `threads` 0 decodes them on the
+// calling thread
+template <typename Sink>
+Counters decodeChunked(const std::string& logFormat, const std::string& input,
+    const CANdb::Decoder& decoder, unsigned threads, Sink& sink)
+{
+    CANdb::ParallelLogDecoder chunked{ input,
+        logFormat == "asc" ? CANdb::ParallelLogDecoder::Format::Asc
+                           : CANdb::ParallelLogDecoder::Format::Candump,
+        decoder, threads };
+    chunked.run([&chunked, &sink](const CANdb::CANframe& frame,
+                    const CANdb::MessagePlan& plan,
+                    const std::vector<CANdb::DecodedSignal>& signals) {
+        sink(chunked, frame, plan, signals);
+    });
+    return Counters{ chunked.frames(), chunked.decoded(), chunked.skipped() };
+}
+
+bool endsWith(const std::string& text, const std::string& suffix)
+{
+    return text.size() >= suffix.size()
+        && text.compare(text.size() - suffix.size(), suffix.size(), suffix)
+        == 0;
+}
+} // namespace
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options(argv[0], "decode candump, ASC and BLF logs");
+    std::string input;
+    std::string output;
+    std::string format;
+    std::string logFormat;
+    CANdb::PipelineOptions pipeline;
+    pipeline.workers = 0;
+    // clang-format off
+    options.add_options()
+    ("d,dbc", "DBC file", cxxopts::value<std::string>(), "[path to file]")
+    ("i,input", "candump -l, ASC or BLF log, - for stdin. For socketcan the "
+        "interface, any for all",
+        cxxopts::value<std::string>(input)->default_value("-"), "[path]")
+    ("l,log-format", "Log format, candump, asc, blf or socketcan, by default "
+        "by extension", cxxopts::value<std::string>(logFormat), "format")
+    ("o,output", "Output file, - for stdout. For arrow the prefix of the "
+        "<message>.arrow files, for shm the shared memory name",
+        cxxopts::value<std::string>(output)->default_value("-"), "[path]")
+    ("f,format", "Output format, csv, json, arrow or shm, the latest values "
+        "in shared memory",
+        cxxopts::value<std::string>(format)->default_value("csv"), "format")
+    ("j,threads", "Decode worker threads, 0 decodes on the reading thread",
+        cxxopts::value<unsigned>(pipeline.workers), "N")
+    ("batch-size", "Frames per batch with --threads",
+        cxxopts::value<std::size_t>(pipeline.batchSize), "N")
+    ("queue-depth", "Batches queued per worker with --threads",
+        cxxopts::value<std::size_t>(pipeline.queueDepth), "N")
+    ("chunked", "Decode chunks of a candump or ASC file in parallel on "
+        "--threads threads")
+    ("h,help", "show help message");
+    // clang-format on
+
+    try {
+        const auto res = options.parse(argc, argv);
+
+        if (res.count("h") != 0) {
+            std::cout << options.help({ "" }) << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if (logFormat.empty()) {
+            logFormat = endsWith(input, ".asc")
+                ? "asc"
+                : endsWith(input, ".blf") ? "blf" : "candump";
+        }
+        const bool blf = logFormat == "blf";
+        const bool arrow = format == "arrow";
+        const bool chunked = res.count("chunked") != 0;
+#ifdef __linux__
+        const bool live = logFormat == "socketcan";
+#else
+        const bool live = false;
+#endif
+#ifndef _WIN32
+        const bool shared = format == "shm";
+#else
+        const bool shared = false;
+#endif
+        // Arrow files and shared memory are created by their writers
+        const bool named = arrow || shared;
+        if (res.count("d") == 0
+            || (format != "csv" && format != "json" && !named)
+            || (logFormat != "candump" && logFormat != "asc" && !blf && !live)
+            || ((blf || chunked || live) && input == "-")
+            || (chunked && (blf || live)) || (named && output == "-")) {
+            std::cerr << options.help({ "" }) << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        CANdb::DBCParser parser;
+        if (!parser.parse(loadDBCFile(res["d"].as<std::string>()))) {
+            std::cerr << "Failed to parse DBC file" << std::endl;
+            return EXIT_FAILURE;
+        }
+        const CANdb::Decoder decoder{ parser.getDb() };
+
+        // BLF and chunked logs are memory mapped by the reader, live frames
+        // come from a socket
+        const bool mapped = blf || chunked || live;
+        std::FILE* in = mapped
+            ? nullptr
+            : input == "-" ? stdin : std::fopen(input.c_str(), "rb");
+        std::FILE* out = named
+            ? nullptr
+            : output == "-" ? stdout : std::fopen(output.c_str(), "wb");
+        if ((in == nullptr && !mapped) || (out == nullptr && !named)) {
+            throw std::runtime_error("Failed to open input or output file");
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        Counters counters;
+        std::uint64_t columnarBytes = 0;
+        if (arrow) {
+            CANdb::ColumnarWriter writer{ output };
+            ColumnarSink sink{ writer };
+            counters = chunked
+                ? decodeChunked(
+                    logFormat, input, decoder, pipeline.workers, sink)
+                : decodeInput(logFormat, input, in, decoder, pipeline, sink);
+            writer.finish();
+            columnarBytes = writer.bytes();
+#ifndef _WIN32
+        } else if (shared) {
+            CANdb::SharedSignalWriter writer{ output, decoder.db() };
+            SharedSink sink{ writer };
+            counters = chunked
+                ? decodeChunked(
+                    logFormat, input, decoder, pipeline.workers, sink)
+                : decodeInput(logFormat, input, in, decoder, pipeline, sink);
+#endif
+        } else {
+            Output writer{ out };
+            const bool json = format == "json";
+            if (!json) {
+                writer.append("timestamp,channel,id,message,signal,value\n");
+            }
+            TextSink sink{ writer, json };
+            counters = chunked
+                ? decodeChunked(
+                    logFormat, input, decoder, pipeline.workers, sink)
+                : decodeInput(logFormat, input, in, decoder, pipeline, sink);
+        }
+
+        if (counters.skipped != 0) {
+            std::cerr << fmt::format("Skipped {} {}", counters.skipped,
+                             blf ? "objects" : live ? "frames" : "lines")
+                      << std::endl;
+        }
+        const std::chrono::duration<double> elapsed
+            = std::chrono::steady_clock::now() - start;
+        std::cerr << fmt::format(
+                         "{} frames, {} decoded in {:.3f} s ({:.0f} frames/s)",
+                         counters.frames, counters.decoded, elapsed.count(),
+                         elapsed.count() > 0
+                             ? counters.frames / elapsed.count()
+                             : 0.0)
+                  << std::endl;
+        if (arrow) {
+            std::cerr << fmt::format("{} bytes written ({:.0f} MB/s)",
+                             columnarBytes,
+                             elapsed.count() > 0
+                                 ? columnarBytes / elapsed.count() / 1e6
+                                 : 0.0)
+                      << std::endl;
+        }
+
+        if (in != nullptr && in != stdin) {
+            std::fclose(in);
+        }
+        if (out != nullptr && out != stdout) {
+            std::fclose(out);
+        }
+        return EXIT_SUCCESS;
+    } catch (const cxxopts::option_not_exists_exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        std::cerr << options.help({ "" }) << std::endl;
+        return EXIT_FAILURE;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
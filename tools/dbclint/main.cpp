@@ -1,9 +1,14 @@
+#include <chrono>
 #include <cxxopts.hpp>
 #include <fstream>
+#include <future>
 #include <regex>
 #include <spdlog/fmt/fmt.h>
 
+#include "canframe.h"
 #include "dbcparser.h"
+#include "dbdiff.h"
+#include "dbquery.h"
 #include "log.hpp"
 #include "termcolor.hpp"
 
@@ -62,18 +67,22 @@ std::string dumpSignal(const CANsignal& sig)
         sig.startBit, sig.signalSize);
 }
 
+std::string dumpMessage(const CANmessage& msg)
+{
+    return fmt::format("  id= {}, name= {:<30}, dlc= {}, ecus={} \n",
+        green(msg.id), red(msg.name), blue(msg.dlc), magenta(msg.ecus.size()));
+}
+
 std::string dumpMessages(
     const CANdb_t& dbc, const std::string& regex, bool dumpMessages = false)
 {
     std::string buff;
     buff += "messages: \n";
+    const std::regex filter{ regex };
     for (const auto& msg : dbc.messages) {
-        const bool isMatch
-            = std::regex_match(msg.first.name, std::regex{ regex });
+        const bool isMatch = std::regex_match(msg.first.name, filter);
         if (isMatch) {
-            buff += fmt::format("  id= {}, name= {:<30}, dlc= {}, ecus={} \n",
-                green(msg.first.id), red(msg.first.name), blue(msg.first.dlc),
-                magenta(msg.first.ecus.size()));
+            buff += dumpMessage(msg.first);
         }
 
         if (dumpMessages) {
@@ -84,6 +93,120 @@ std::string dumpMessages(
     }
     return buff;
 }
+
+// Ids above 0x7FF are extended, they are looked up with the flag DBC files
+// mark them with
+std::uint32_t queryId(const std::string& text, const std::string& value)
+{
+    std::size_t end = 0;
+    unsigned long id = 0;
+    try {
+        id = std::stoul(value, &end, 0);
+    } catch (const std::logic_error&) {
+        end = 0;
+    }
+    if (end == 0 || end != value.size() || id > 0xFFFFFFFF) {
+        throw std::runtime_error(fmt::format("Invalid query {}", text));
+    }
+    if (id > 0x7FF) {
+        id |= CANdb::CAN_EXTENDED_ID_FLAG;
+    }
+    return static_cast<std::uint32_t>(id);
+}
+
+// Answers id:<id>, msg:<pattern>, sig:<pattern> and ecu:<name> queries,
+// patterns may contain the wildcards * and ?
+std::string runQuery(const CANdb::DbQuery& query, const std::string& text)
+{
+    const auto colon = text.find(':');
+    if (colon == std::string::npos) {
+        throw std::runtime_error(fmt::format("Invalid query {}", text));
+    }
+    const auto kind = text.substr(0, colon);
+    const auto value = text.substr(colon + 1);
+
+    std::vector<const CANmessage*> messages;
+    std::vector<CANdb::DbQuery::SignalRef> signals;
+    const auto start = std::chrono::steady_clock::now();
+    if (kind == "id") {
+        const auto* msg = query.message(queryId(text, value));
+        if (msg != nullptr) {
+            messages.push_back(msg);
+        }
+    } else if (kind == "msg") {
+        messages = query.messages(value);
+    } else if (kind == "ecu") {
+        messages = query.transmittedBy(value);
+    } else if (kind == "sig") {
+        signals = query.signals(value);
+    } else {
+        throw std::runtime_error(fmt::format("Invalid query {}", text));
+    }
+    const std::chrono::duration<double, std::micro> elapsed
+        = std::chrono::steady_clock::now() - start;
+
+    std::string buff;
+    for (const auto* msg : messages) {
+        buff += dumpMessage(*msg);
+        if (kind == "id") {
+            for (const auto& signal : query.signalsOf(*msg)) {
+                buff += fmt::format("     {}\n", dumpSignal(signal));
+            }
+        }
+    }
+    for (const auto& ref : signals) {
+        buff += fmt::format(
+            "  id= {}, {}\n", green(ref.message->id), dumpSignal(*ref.signal));
+    }
+    return buff
+        + fmt::format("{} matches in {:.1f} us\n",
+            messages.size() + signals.size(), elapsed.count());
+}
+
+CANdb_t parseDBCFile(const std::string& filename)
+{
+    CANdb::DBCParser parser;
+    if (!parser.parse(loadDBCFile(filename))) {
+        throw std::runtime_error(
+            fmt::format("DBC file {} could not be parsed", filename));
+    }
+    return parser.getDb();
+}
+
+// Structural changes between two DBC files, parsed concurrently
+std::string diffFiles(const std::string& before, const std::string& after)
+{
+    auto pending = std::async(std::launch::async, parseDBCFile, before);
+    const auto afterDb = parseDBCFile(after);
+    const auto beforeDb = pending.get();
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto changes = CANdb::diffDatabases(beforeDb, afterDb);
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - start;
+
+    std::string buff;
+    for (const auto& change : changes) {
+        const auto item = change.signal.empty()
+            ? change.message
+            : fmt::format("{}.{}", change.message, change.signal);
+        if (change.kind == CANdb::DbChange::Kind::Added) {
+            buff += fmt::format("+ {:#x} {}\n", change.id, green(item));
+        } else if (change.kind == CANdb::DbChange::Kind::Removed) {
+            buff += fmt::format("- {:#x} {}\n", change.id, red(item));
+        } else {
+            std::string fields;
+            for (const auto* field : change.fields) {
+                fields += fields.empty() ? field : fmt::format(", {}", field);
+            }
+            buff += fmt::format(
+                "~ {:#x} {}: {}\n", change.id, blue(item), magenta(fields));
+        }
+    }
+    return buff
+        + fmt::format("{} changes, compared in {:.1f} ms\n", changes.size(),
+            elapsed.count());
+}
 } // namespace
 
 std::shared_ptr<spdlog::logger> kDefaultLogger
@@ -121,8 +244,19 @@ int main(int argc, char* argv[])
     ("t, tree", "Dump messages and signals")
     ("f, filter", "filter by messages/signals",
         cxxopts::value<std::string>(regex)->default_value(".*"), "regexp")
+    ("q, query", "Query messages and signals through indexes, ids above "
+        "0x7FF are extended",
+        cxxopts::value<std::vector<std::string>>(),
+        "id:<id>|msg:<pattern>|sig:<pattern>|ecu:<name>")
+    ("fingerprint", "Print the fingerprint of the database, with and "
+        "without comments and attributes")
+    ("diff", "Compare the structure of two DBC files, given as a.dbc b.dbc")
     ("h,help", "show help message");
+    // Not listed by the help, only read with --diff
+    options.add_options("positional")
+    ("files", "Files to compare", cxxopts::value<std::vector<std::string>>());
     // clang-format on
+    options.parse_positional({ "files" });
 
     try {
         const auto res = options.parse(argc, argv);
@@ -137,6 +271,31 @@ int main(int argc, char* argv[])
             return EXIT_SUCCESS;
         }
 
+        if (res.count("diff") != 0) {
+            const auto files = res.count("files") != 0
+                ? res["files"].as<std::vector<std::string>>()
+                : std::vector<std::string>{};
+            if (files.size() != 2) {
+                std::cerr << options.help({ "" }) << std::endl;
+                return EXIT_FAILURE;
+            }
+            try {
+                std::cout << diffFiles(files[0], files[1]);
+            } catch (const std::exception& ex) {
+                std::cerr << ex.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
+        }
+
+        if (res.count("files") != 0) {
+            std::cerr << fmt::format("Unexpected argument {}",
+                res["files"].as<std::vector<std::string>>().front())
+                      << std::endl;
+            std::cerr << options.help({ "" }) << std::endl;
+            return EXIT_FAILURE;
+        }
+
         if (res.count("i") == 0) {
             std::cerr << options.help({ "" }) << std::endl;
             return EXIT_FAILURE;
@@ -157,6 +316,21 @@ int main(int argc, char* argv[])
             } else if (res.count("t")) {
                 std::cout << dumpMessages(parser.getDb(), regex, true);
             }
+            if (success && res.count("fingerprint") != 0) {
+                const auto& print = parser.fingerprint();
+                std::cout << fmt::format("fingerprint {}\n"
+                                         "fingerprint with comments and "
+                                         "attributes {}\n",
+                    print.value().hex(),
+                    print.value(CANdb::COMMENT | CANdb::ATTRIBUTES).hex());
+            }
+            if (res.count("q") != 0) {
+                const CANdb::DbQuery query{ parser.getDb() };
+                for (const auto& text :
+                    res["q"].as<std::vector<std::string>>()) {
+                    std::cout << runQuery(query, text);
+                }
+            }
 
         } catch (const std::exception& ex) {
             std::cerr << ex.what() << std::endl;